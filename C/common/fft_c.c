@@ -0,0 +1,131 @@
+
+#include <math.h>
+#include <complex.h>
+
+#include "fft_c.h"
+
+#define FFT_PI 3.14159265358979323846
+#define FFT_EPS (1.0 / 9007199254740992.0)
+// An upper bound on sqrt(5).
+#define FFT_SQRT5 2.2360679775
+
+// ================================
+// Generate twiddle factors for the FFT of C[x] / (x^ARRAY_N - i).
+// The entry of the k-th block at the level-th layer is
+// zeta^(2^(LOGNTT_N - 1 - level)) omega^(brv(k)) = exp(i pi (2^(LOGNTT_N - 1 - level) + 4 brv(k)) / (2 NTT_N))
+// where brv reverses LOGNTT_N - 1 bits.
+void gen_FFT_table(
+    void *des,
+    bool inv,
+    struct compress_profile _profile
+    ){
+
+    size_t brv, e;
+    double theta;
+
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+        for(size_t k = 0; k < (1u << level); k++){
+            brv = 0;
+            for(size_t b = 0; b + 1 < _profile.log_ntt_n; b++){
+                if((k >> b) & 1){
+                    brv |= 1u << (_profile.log_ntt_n - 2 - b);
+                }
+            }
+            e = (1u << (_profile.log_ntt_n - 1 - level)) + 4 * brv;
+            theta = FFT_PI * (double)e / (double)(2 * _profile.ntt_n);
+            if(inv){
+                theta = -theta;
+            }
+            *(double _Complex*)des = cexp(I * theta);
+            des += sizeof(double _Complex);
+        }
+    }
+
+}
+
+// ================================
+void FFT_fold_int32(
+    void *des,
+    const void *src,
+    size_t n
+    ){
+
+    for(size_t j = 0; j < (n >> 1); j++){
+        ((double _Complex*)des)[j] = (double)((int32_t*)src)[j] + I * (double)((int32_t*)src)[j + (n >> 1)];
+    }
+
+}
+
+// Round to the nearest integer and map to the signed representative in Z_{*mod}.
+static
+int32_t FFT_round_mod(double a, int32_t mod){
+
+    int64_t t;
+
+    if(a >= 0){
+        t = (int64_t)(a + 0.5);
+    }else{
+        t = -(int64_t)(-a + 0.5);
+    }
+
+    t %= mod;
+    if(t >= (mod + 1) / 2){
+        t -= mod;
+    }
+    if(t < -(mod / 2)){
+        t += mod;
+    }
+
+    return (int32_t)t;
+
+}
+
+void FFT_unfold_int32(
+    void *des,
+    const void *src,
+    size_t n, const double *scale,
+    const void *mod
+    ){
+
+    double _Complex t;
+
+    for(size_t j = 0; j < (n >> 1); j++){
+        t = ((double _Complex*)src)[j];
+        ((int32_t*)des)[j] = FFT_round_mod(creal(t) * (*scale), *(int32_t*)mod);
+        ((int32_t*)des)[j + (n >> 1)] = FFT_round_mod(cimag(t) * (*scale), *(int32_t*)mod);
+    }
+
+}
+
+// ================================
+double FFT_error_bound(
+    size_t n,
+    double bound1, double bound2
+    ){
+
+    size_t K;
+    double t;
+
+    K = 0;
+    while(((size_t)1 << (K + 1)) < n){
+        K++;
+    }
+
+    t = FFT_EPS * (3 * K + FFT_SQRT5 * (3 * K + 1) + 4 * 3 * K);
+    if(t >= 1){
+        return HUGE_VAL;
+    }
+
+    return (double)n * bound1 * bound2 * t / (1 - t);
+
+}
+
+bool FFT_check_bound(
+    size_t n,
+    double bound1, double bound2
+    ){
+
+    return FFT_error_bound(n, bound1, bound2) < 0.5;
+
+}
+
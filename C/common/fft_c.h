@@ -0,0 +1,74 @@
+#ifndef FFT_C_H
+#define FFT_C_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "tools.h"
+
+// ================================
+// Complex floating-point FFT for Z_Q[x] / (x^n + 1).
+// Since x^n + 1 = (x^(n / 2) - i) (x^(n / 2) + i) over the complex numbers and the two factors
+// are conjugate, a real polynomial is determined by its image in C[x] / (x^(n / 2) - i).
+// We fold n integer coefficients into n / 2 complex numbers (the real and imaginary parts
+// are the lower and upper halves), transform them with CT_NTT and GS_iNTT over the ring
+// of complex numbers (see add_complex etc. in tools.h), and round the result back to Z_Q.
+// The profile for CT_NTT and GS_iNTT has ARRAY_N = n / 2.
+
+// ================================
+
+// Generate twiddle factors for the FFT of C[x] / (x^ARRAY_N - i) with Cooley-Tukey butterflies.
+// The layout is the same as gen_DWT_table with zeta = exp(i pi / (2 NTT_N)) and
+// omega = zeta^4, but each entry is computed directly with cexp.
+// If inv is true, the entries are conjugated and GS_iNTT computes the inverse scaled by NTT_N.
+void gen_FFT_table(
+    void *des,
+    bool inv,
+    struct compress_profile _profile
+    );
+
+// ================================
+
+// Fold the n coefficients at src (signed representatives in 32-bit) into
+// n / 2 complex numbers des[j] = src[j] + i src[j + n / 2].
+void FFT_fold_int32(
+    void *des,
+    const void *src,
+    size_t n
+    );
+
+// Unfold the n / 2 complex numbers at src to n coefficients in 32-bit. Each part is multiplied
+// by *scale, rounded to the nearest integer, and mapped to the signed representative in
+// Z_{*mod}.
+void FFT_unfold_int32(
+    void *des,
+    const void *src,
+    size_t n, const double *scale,
+    const void *mod
+    );
+
+// ================================
+
+// An upper bound on the rounding error of each coefficient of the product of size-n
+// polynomials with coefficients bounded by bound1 and bound2 in absolute value.
+// For an FFT of size N = 2^K with unit roundoff eps = 2^(-53) and twiddle factors accurate
+// to beta, [Per03] shows that the error of each coefficient of the cyclic convolution is below
+// ||x||_2 ||y||_2 ((1 + eps)^(3 K) (1 + sqrt(5) eps)^(3 K + 1) (1 + beta)^(3 K) - 1).
+// The DWT performs the same butterflies, so we apply the bound with K = log_2(n / 2),
+// ||x||_2 ||y||_2 <= n bound1 bound2, beta = 4 eps, and (1 + a_1)...(1 + a_m) - 1 <= t / (1 - t)
+// for t = a_1 + ... + a_m < 1.
+double FFT_error_bound(
+    size_t n,
+    double bound1, double bound2
+    );
+
+// Returns true if FFT_error_bound is below 1 / 2 so rounding recovers the exact integer
+// product. The callers must refuse the parameters otherwise.
+bool FFT_check_bound(
+    size_t n,
+    double bound1, double bound2
+    );
+
+#endif
+
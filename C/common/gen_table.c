@@ -1,8 +1,14 @@
 
+#include <stdlib.h>
 #include <memory.h>
+#include <assert.h>
 
 #include "tools.h"
 #include "gen_table.h"
+#include "ntt_c.h"
+
+// The scratch buffers of the generators grow linearly in NTT_N, so they are allocated on the
+// heap, and the allocations are asserted.
 
 // ================================
 
@@ -39,9 +45,10 @@ void gen_DWT_table(
     struct ring ring
     ){
 
-    char buff[_profile.ntt_n * ring.sizeZ];
+    char *buff = malloc(_profile.ntt_n * ring.sizeZ);
     char zeta_buff[_profile.log_ntt_n * ring.sizeZ];
 
+    assert(buff != NULL);
 
     gen_CT_table(buff, scale, omega, _profile, ring);
 
@@ -58,6 +65,7 @@ void gen_DWT_table(
         des += (1u << i) * ring.sizeZ;
     }
 
+    free(buff);
 
 }
 
@@ -97,9 +105,11 @@ void gen_streamlined_DWT_table(
 
     size_t start_level;
 
-    char tmp[_profile.ntt_n * ring.sizeZ];
+    char *tmp = malloc(_profile.ntt_n * ring.sizeZ);
     void *level_ptr[_profile.log_ntt_n];
 
+    assert(tmp != NULL);
+
     gen_DWT_table(
         tmp, scale, omega, zeta,
         _profile,
@@ -129,6 +139,8 @@ void gen_streamlined_DWT_table(
         start_level += (_profile.merged_layers)[i];
     }
 
+    free(tmp);
+
 }
 
 // Generate twiddle factors for cyclic iNTT with Cooley-Tukey butterflies.
@@ -143,7 +155,8 @@ void gen_streamlined_inv_CT_table(
     char zeta[ring.sizeZ];
     size_t start_level;
 
-    char tmp[_profile.ntt_n * ring.sizeZ];
+    char *tmp = malloc(_profile.ntt_n * ring.sizeZ);
+    assert(tmp != NULL);
 
     void *level_ptr[_profile.log_ntt_n];
 
@@ -179,6 +192,459 @@ void gen_streamlined_inv_CT_table(
         start_level += (_profile.merged_layers)[i];
     }
 
+    free(tmp);
+
+}
+
+// ================================
+
+// The position of the i-th twiddle factor of level in the streamlined layout.
+// For the layer-merging group [start_level, start_level + merged) with base offset base,
+// the j-th block holds pad slot(s) followed by the chunks of levels start_level, ...,
+// start_level + merged - 1 with 2^k twiddle factors for the k-th merged level.
+// The twiddle factors of the k-th merged level in the j-th chunk are indexed by
+// - j 2^k + h (h < 2^k) for DWT tables, or
+// - j + h 2^start_level (h < 2^k) for inverse cyclic tables.
+static
+void streamlined_level_offsets(
+    size_t *base, size_t *start, size_t *stride,
+    struct compress_profile _profile, bool pad
+    ){
+
+    size_t start_level, offset;
+
+    start_level = 0;
+    offset = 0;
+    for(size_t i = 0; i < _profile.compressed_layers; i++){
+        for(size_t k = 0; k < _profile.merged_layers[i]; k++){
+            base[start_level + k] = offset;
+            start[start_level + k] = start_level;
+            stride[start_level + k] = pad + (1u << _profile.merged_layers[i]) - 1;
+        }
+        offset += (1u << start_level) * (pad + (1u << _profile.merged_layers[i]) - 1);
+        start_level += _profile.merged_layers[i];
+    }
+
+}
+
+// Generate the output of gen_streamlined_DWT_table directly.
+// Let S(i) = scale omega^(brv_{LOGNTT_N - 1}(i)) for i < NTT_N / 2. Since the bits of i are
+// disjoint from 2^level for i < 2^level, S(2^level + i) = S(i) omega^(2^(LOGNTT_N - 2 - level)),
+// and S is built by doubling. The i-th twiddle factor of level is then zeta_level S(i)
+// where zeta_level = zeta^(2^(LOGNTT_N - 1 - level)) is obtained by squaring.
+// The generation takes about 3 NTT_N / 2 multiplications and no calls to expZ.
+// If parallel, the doubling of each level and the levels are split among the threads of an
+// OpenMP team, and each thread calls bind(ctx) before using the ring.
+static
+void gen_streamlined_DWT_table_direct_team(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile, bool pad,
+    struct ring ring,
+    bool parallel, void (*bind)(const void *ctx), const void *ctx
+    ){
+
+    size_t log_n = _profile.log_ntt_n;
+    size_t base[log_n], start[log_n], stride[log_n];
+    char omega_buff[log_n * ring.sizeZ];
+    char zeta_buff[log_n * ring.sizeZ];
+
+    char *S = malloc((_profile.ntt_n >> 1) * ring.sizeZ);
+    assert(S != NULL);
+
+    streamlined_level_offsets(base, start, stride, _profile, pad);
+
+    // omega_buff[level] = omega^(2^(LOGNTT_N - 2 - level)) and zeta_buff[level] = zeta_level.
+    memcpy(zeta_buff + (log_n - 1) * ring.sizeZ, zeta, ring.sizeZ);
+    for(ptrdiff_t i = log_n - 2; i >= 0; i--){
+        ring.mulZ(zeta_buff + i * ring.sizeZ, zeta_buff + (i + 1) * ring.sizeZ, zeta_buff + (i + 1) * ring.sizeZ);
+    }
+    if(log_n >= 2){
+        memcpy(omega_buff + (log_n - 2) * ring.sizeZ, omega, ring.sizeZ);
+        for(ptrdiff_t i = log_n - 3; i >= 0; i--){
+            ring.mulZ(omega_buff + i * ring.sizeZ, omega_buff + (i + 1) * ring.sizeZ, omega_buff + (i + 1) * ring.sizeZ);
+        }
+    }
+
+    memcpy(S, scale, ring.sizeZ);
+
+#if defined(_OPENMP)
+    #pragma omp parallel if(parallel)
+#endif
+    {
+
+    if(parallel && (bind != NULL)){
+        bind(ctx);
+    }
+
+    // Each level of the doubling only reads the previous ones.
+    for(size_t level = 0; level + 1 < log_n; level++){
+#if defined(_OPENMP)
+        #pragma omp for
+#endif
+        for(size_t i = 0; i < (1u << level); i++){
+            ring.mulZ(S + ((1u << level) + i) * ring.sizeZ, S + i * ring.sizeZ, omega_buff + level * ring.sizeZ);
+        }
+    }
+
+    // The levels are independent.
+#if defined(_OPENMP)
+    #pragma omp for schedule(dynamic)
+#endif
+    for(size_t level = 0; level < log_n; level++){
+        size_t k = level - start[level];
+        for(size_t i = 0; i < (1u << level); i++){
+            size_t pos = base[level] + (i >> k) * stride[level] + pad + (1u << k) - 1 + (i & ((1u << k) - 1));
+            ring.mulZ(des + pos * ring.sizeZ, S + i * ring.sizeZ, zeta_buff + level * ring.sizeZ);
+        }
+        if(pad && (k == 0)){
+            for(size_t j = 0; j < (1u << level); j++){
+                memset(des + (base[level] + j * stride[level]) * ring.sizeZ, 0, ring.sizeZ);
+            }
+        }
+    }
+
+    }
+
+    free(S);
+
+}
+
+void gen_streamlined_DWT_table_direct(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile, bool pad,
+    struct ring ring
+    ){
+
+    gen_streamlined_DWT_table_direct_team(des, scale, omega, zeta, _profile, pad, ring, false, NULL, NULL);
+
+}
+
+void gen_streamlined_DWT_table_direct_parallel(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile, bool pad,
+    struct ring ring,
+    void (*bind)(const void *ctx), const void *ctx
+    ){
+
+    gen_streamlined_DWT_table_direct_team(des, scale, omega, zeta, _profile, pad, ring, true, bind, ctx);
+
+}
+
+// Generate the output of gen_streamlined_inv_CT_table directly.
+// The i-th twiddle factor of level is scale omega^(i 2^(LOGNTT_N - 1 - level)), so all the
+// levels are sub-sampled from the powers scale omega^t for t < NTT_N / 2.
+// The generation takes NTT_N / 2 multiplications and no calls to expZ.
+// The powers are a chain, so only the copying into the levels is split among the threads.
+static
+void gen_streamlined_inv_CT_table_direct_team(
+    void *des,
+    const void *scale, const void *omega,
+    struct compress_profile _profile, bool pad,
+    struct ring ring,
+    bool parallel
+    ){
+
+    size_t log_n = _profile.log_ntt_n;
+    size_t base[log_n], start[log_n], stride[log_n];
+
+    char *P = malloc((_profile.ntt_n >> 1) * ring.sizeZ);
+    assert(P != NULL);
+
+    streamlined_level_offsets(base, start, stride, _profile, pad);
+
+    memcpy(P, scale, ring.sizeZ);
+    for(size_t i = 1; i < (_profile.ntt_n >> 1); i++){
+        ring.mulZ(P + i * ring.sizeZ, P + (i - 1) * ring.sizeZ, omega);
+    }
+
+    // The levels are independent.
+#if defined(_OPENMP)
+    #pragma omp parallel for schedule(dynamic) if(parallel)
+#endif
+    for(size_t level = 0; level < log_n; level++){
+        size_t s = start[level];
+        size_t k = level - s;
+        for(size_t i = 0; i < (1u << level); i++){
+            size_t pos = base[level] + (i & ((1u << s) - 1)) * stride[level] + pad + (1u << k) - 1 + (i >> s);
+            memcpy(des + pos * ring.sizeZ, P + (i << (log_n - 1 - level)) * ring.sizeZ, ring.sizeZ);
+        }
+        if(pad && (k == 0)){
+            for(size_t j = 0; j < (1u << level); j++){
+                memset(des + (base[level] + j * stride[level]) * ring.sizeZ, 0, ring.sizeZ);
+            }
+        }
+    }
+
+    free(P);
+
+}
+
+void gen_streamlined_inv_CT_table_direct(
+    void *des,
+    const void *scale, const void *omega,
+    struct compress_profile _profile, bool pad,
+    struct ring ring
+    ){
+
+    gen_streamlined_inv_CT_table_direct_team(des, scale, omega, _profile, pad, ring, false);
+
+}
+
+void gen_streamlined_inv_CT_table_direct_parallel(
+    void *des,
+    const void *scale, const void *omega,
+    struct compress_profile _profile, bool pad,
+    struct ring ring
+    ){
+
+    gen_streamlined_inv_CT_table_direct_team(des, scale, omega, _profile, pad, ring, true);
+
+}
+
+// ================================
+
+void gen_default_twiddle_layout(
+    struct twiddle_layout *des,
+    size_t vec_n, size_t align,
+    struct compress_profile _profile
+    ){
+
+    des->vec_n = vec_n;
+    des->align = align;
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+        if(((_profile.array_n) >> (level + 1)) >= vec_n){
+            des->mode[level] = TWIDDLE_REPLICATE;
+        }else{
+            des->mode[level] = TWIDDLE_INTERLEAVE;
+        }
+    }
+
+}
+
+bool check_twiddle_layout(
+    struct compress_profile _profile,
+    struct twiddle_layout _layout
+    ){
+
+    if((_layout.vec_n == 0) || (_layout.vec_n & (_layout.vec_n - 1))){
+        return false;
+    }
+    if((_layout.vec_n > ((_profile.array_n) >> 1)) || (_layout.align == 0)){
+        return false;
+    }
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+        if((_layout.mode[level] != TWIDDLE_INTERLEAVE) &&
+           (((_profile.array_n) >> (level + 1)) < _layout.vec_n)){
+            return false;
+        }
+    }
+
+    return true;
+
+}
+
+size_t get_twiddle_layout_offsets(
+    size_t *des,
+    struct compress_profile _profile,
+    struct twiddle_layout _layout
+    ){
+
+    size_t offset, len;
+
+    offset = 0;
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+        des[level] = offset;
+        switch(_layout.mode[level]){
+            case TWIDDLE_SCALAR:
+                len = 1u << level;
+                break;
+            case TWIDDLE_REPLICATE:
+                len = (1u << level) * _layout.vec_n;
+                break;
+            default:
+                len = (_profile.array_n) >> 1;
+                break;
+        }
+        offset += ((len + _layout.align - 1) / _layout.align) * _layout.align;
+    }
+
+    return offset;
+
+}
+
+void gen_vec_DWT_table(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile,
+    struct twiddle_layout _layout,
+    struct ring ring
+    ){
+
+    size_t offsets[_profile.log_ntt_n];
+    size_t step, len;
+    void *level_ptr;
+
+    char *tmp;
+
+    assert(check_twiddle_layout(_profile, _layout));
+
+    tmp = malloc(_profile.ntt_n * ring.sizeZ);
+    assert(tmp != NULL);
+
+    gen_DWT_table(tmp, scale, omega, zeta, _profile, ring);
+
+    len = get_twiddle_layout_offsets(offsets, _profile, _layout);
+    memset(des, 0, len * ring.sizeZ);
+
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+
+        step = (_profile.array_n) >> (level + 1);
+        level_ptr = tmp + ((1u << level) - 1) * ring.sizeZ;
+
+        switch(_layout.mode[level]){
+            case TWIDDLE_SCALAR:
+                memcpy(des + offsets[level] * ring.sizeZ, level_ptr, (1u << level) * ring.sizeZ);
+                break;
+            case TWIDDLE_REPLICATE:
+                for(size_t k = 0; k < (1u << level); k++){
+                    for(size_t t = 0; t < _layout.vec_n; t++){
+                        memcpy(des + (offsets[level] + k * _layout.vec_n + t) * ring.sizeZ,
+                            level_ptr + k * ring.sizeZ, ring.sizeZ);
+                    }
+                }
+                break;
+            default:
+                for(size_t b = 0; b < ((_profile.array_n) >> 1); b++){
+                    memcpy(des + (offsets[level] + b) * ring.sizeZ,
+                        level_ptr + (b / step) * ring.sizeZ, ring.sizeZ);
+                }
+                break;
+        }
+
+    }
+
+    free(tmp);
+
+}
+
+// ================================
+
+// Generate twiddle factors for the constant-geometry DWT with Cooley-Tukey butterflies.
+// After level layers, the element of block k with offset j is stored at j 2^level + k.
+// Therefore, the i-th butterfly of the level-th layer uses the twiddle factor of block
+// i mod 2^level.
+void gen_CG_DWT_table(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    char *tmp = malloc(_profile.ntt_n * ring.sizeZ);
+    assert(tmp != NULL);
+
+    gen_DWT_table(
+        tmp, scale, omega, zeta,
+        _profile,
+        ring
+    );
+
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+        for(size_t i = 0; i < (_profile.ntt_n >> 1); i++){
+            memcpy(des,
+                tmp + (((1u << level) - 1) + (i & ((1u << level) - 1))) * ring.sizeZ,
+                ring.sizeZ);
+            des += ring.sizeZ;
+        }
+    }
+
+    free(tmp);
+
+}
+
+// ================================
+
+// Generate the seed table for the on-the-fly DWT with Cooley-Tukey butterflies.
+// Recall that the twiddle factor of the k-th block at the level-th layer in gen_DWT_table is
+// scale zeta^(2^(LOGNTT_N - 1 - level)) omega^(brv(k)) where brv reverses LOGNTT_N - 1 bits.
+// Since brv(k) = sum_b k_b 2^(LOGNTT_N - 2 - b) where k_b is the b-th bit of k, we have
+// T(level, k + 1) = T(level, k) omega^(2^(LOGNTT_N - 2 - t) - sum_{b < t} 2^(LOGNTT_N - 2 - b))
+// where t is the number of trailing ones of k. The exponent does not depend on level.
+void gen_OTF_DWT_seed(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    char zeta_l[ring.sizeZ];
+    size_t e;
+
+    // Twiddle factors of the 0-th blocks.
+    memcpy(zeta_l, zeta, ring.sizeZ);
+    for(ptrdiff_t level = _profile.log_ntt_n - 1; level >= 0; level--){
+        ring.mulZ(des + level * ring.sizeZ, scale, zeta_l);
+        ring.expZ(zeta_l, zeta_l, 2);
+    }
+    des += _profile.log_ntt_n * ring.sizeZ;
+
+    // Ratios indexed by the number of trailing ones.
+    for(size_t t = 0; t + 1 < _profile.log_ntt_n; t++){
+        e = ((3 * _profile.ntt_n) >> (t + 2)) + (_profile.ntt_n >> 1);
+        ring.expZ(des, omega, e & (_profile.ntt_n - 1));
+        des += ring.sizeZ;
+    }
+
+}
+
+// Generate the two-level table for the DWT with Cooley-Tukey butterflies.
+// The twiddle factor of the k-th block at the level-th layer is
+// start[level] coarse[k >> log_fine] fine[k mod 2^log_fine].
+void gen_two_level_DWT_table(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    size_t log_fine,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    char zeta_l[ring.sizeZ];
+    size_t brv;
+
+    memcpy(zeta_l, zeta, ring.sizeZ);
+    for(ptrdiff_t level = _profile.log_ntt_n - 1; level >= 0; level--){
+        ring.mulZ(des + level * ring.sizeZ, scale, zeta_l);
+        ring.expZ(zeta_l, zeta_l, 2);
+    }
+    des += _profile.log_ntt_n * ring.sizeZ;
+
+    // fine[j] = omega^(brv(j)).
+    for(size_t j = 0; j < (1u << log_fine); j++){
+        brv = 0;
+        for(size_t b = 0; b < log_fine; b++){
+            if((j >> b) & 1){
+                brv += _profile.ntt_n >> (b + 2);
+            }
+        }
+        ring.expZ(des, omega, brv);
+        des += ring.sizeZ;
+    }
+
+    // coarse[h] = omega^(brv(h 2^log_fine)).
+    for(size_t h = 0; h < ((_profile.ntt_n >> 1) >> log_fine); h++){
+        brv = 0;
+        for(size_t b = 0; b + log_fine + 1 < _profile.log_ntt_n; b++){
+            if((h >> b) & 1){
+                brv += _profile.ntt_n >> (b + log_fine + 2);
+            }
+        }
+        ring.expZ(des, omega, brv);
+        des += ring.sizeZ;
+    }
+
 }
 
 // ================================
@@ -233,10 +699,231 @@ void gen_mul_table(
 
 }
 
+// ================================
+
+// Return the smallest generator of Z_p^* for an odd prime p.
+static
+size_t Rader_generator(size_t p){
 
+    size_t order, t;
 
+    for(size_t g = 2; g < p; g++){
+        order = 1;
+        for(t = g; t != 1; t = (t * g) % p){
+            order++;
+        }
+        if(order == p - 1){
+            return g;
+        }
+    }
 
+    return 1;
 
+}
 
+// Generate the tables for Rader's algorithm.
+void gen_Rader_table(
+    size_t *perm, void *kernel,
+    size_t p, const void *omega_p, const void *scale,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t M, g, g_inv, t;
+
+    M = p - 1;
+    g = Rader_generator(p);
+    // g^(-1) = g^(p - 2)
+    g_inv = 1;
+    for(size_t i = 0; i < p - 2; i++){
+        g_inv = (g_inv * g) % p;
+    }
+
+    for(size_t a = 0, t_in = 1, t_out = 1; a < M; a++){
+        perm[a] = t_in;
+        perm[M + a] = t_out;
+        t_in = (t_in * g_inv) % p;
+        t_out = (t_out * g) % p;
+    }
+
+    memset(kernel, 0, _profile.ntt_n * ring.sizeZ);
+    if(_profile.ntt_n == M){
+        t = 1;
+        for(size_t c = 0; c < M; c++){
+            ring.expZ(kernel + c * ring.sizeZ, omega_p, t);
+            t = (t * g) % p;
+        }
+    }else{
+        // v'_c = v_{(c + 1) mod M} for c = 0, ..., 2M - 2.
+        t = g;
+        for(size_t c = 0; c < 2 * M - 1; c++){
+            ring.expZ(kernel + c * ring.sizeZ, omega_p, t);
+            t = (t * g) % p;
+        }
+    }
+
+    CT_NTT(kernel, _root_table, _profile, ring);
+
+    for(size_t c = 0; c < _profile.ntt_n; c++){
+        ring.mulZ(kernel + c * ring.sizeZ, kernel + c * ring.sizeZ, scale);
+    }
+
+}
+
+// ================================
+
+// Generate the matrix side of NTT_TMVP.
+void gen_TMVP_table(
+    void *des,
+    const void *src, size_t len,
+    const void *scale,
+    const void *_iroot_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    memset(des, 0, _profile.ntt_n * ring.sizeZ);
+    memcpy(des, src, (2 * len - 1) * ring.sizeZ);
+
+    GS_iNTT_T(des, _iroot_table, _profile, ring);
+
+    for(size_t i = 0; i < _profile.ntt_n; i++){
+        ring.mulZ(des + i * ring.sizeZ, des + i * ring.sizeZ, scale);
+    }
+
+}
+
+// Compute C_e = psi^e + psi^(-e) for e = 0, ..., len - 1 from C_1 = *cos.
+static
+void Bruun_cos_table(
+    void *des,
+    const void *cos, size_t len,
+    struct ring ring
+    ){
+
+    char tmp[ring.sizeZ];
+
+    // C_0 = 2.
+    ring.expZ(tmp, cos, 0);
+    ring.addZ(des, tmp, tmp);
+    memcpy(des + ring.sizeZ, cos, ring.sizeZ);
+    for(size_t e = 2; e < len; e++){
+        ring.mulZ(tmp, cos, des + (e - 1) * ring.sizeZ);
+        ring.subZ(des + e * ring.sizeZ, tmp, des + (e - 2) * ring.sizeZ);
+    }
+
+}
+
+// Generate the table for Bruun's FFT.
+void gen_Bruun_table(
+    void *des,
+    const void *cos, size_t c_exp,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t brv, e;
+    char one[ring.sizeZ];
+
+    char *C = malloc(4 * _profile.ntt_n * ring.sizeZ);
+    assert(C != NULL);
+
+    Bruun_cos_table(C, cos, 4 * _profile.ntt_n, ring);
+    ring.expZ(one, cos, 0);
+
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+        for(size_t k = 0; k < (1u << level); k++){
+            brv = 0;
+            for(size_t b = 0; b <= level; b++){
+                if((k >> b) & 1){
+                    brv |= 1u << (level - b);
+                }
+            }
+            e = (1 + 2 * brv) << (_profile.log_ntt_n - 1 - level);
+            ring.expZ(des, C + e * ring.sizeZ, c_exp);
+            ring.mulZ(des + ring.sizeZ, C + e * ring.sizeZ, C + e * ring.sizeZ);
+            ring.subZ(des + ring.sizeZ, des + ring.sizeZ, one);
+            des += 2 * ring.sizeZ;
+        }
+    }
+
+    free(C);
+
+}
+
+// Generate the twiddle factors for the base multiplications after Bruun_NTT.
+// The blocks 2 k and 2 k + 1 are the children of the k-th block at the last layer, so
+// their twiddle factors are C_e and -C_e = C_(e + 2 NTT_N) with e = 1 + 2 brv(k).
+void gen_Bruun_mul_table(
+    void *des,
+    const void *cos,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t brv, e;
+
+    char *C = malloc(4 * _profile.ntt_n * ring.sizeZ);
+    assert(C != NULL);
+
+    Bruun_cos_table(C, cos, 4 * _profile.ntt_n, ring);
+
+    for(size_t k = 0; k < _profile.ntt_n; k++){
+        brv = 0;
+        for(size_t b = 0; b < _profile.log_ntt_n; b++){
+            if(((k >> 1) >> b) & 1){
+                brv |= 1u << (_profile.log_ntt_n - 1 - b);
+            }
+        }
+        e = 1 + 2 * brv + (k & 1) * 2 * _profile.ntt_n;
+        memcpy(des + k * ring.sizeZ, C + e * ring.sizeZ, ring.sizeZ);
+    }
+
+    free(C);
+
+}
+
+// Generate tables for Harvey's lazy butterflies.
+void gen_Shoup_table_uint32(
+    void *des, void *des_Shoup,
+    const void *src, size_t len,
+    const void *mod
+    ){
+
+    int32_t t;
+
+    for(size_t i = 0; i < len; i++){
+        t = ((int32_t*)src)[i];
+        if(t < 0){
+            t += *(uint32_t*)mod;
+        }
+        ((uint32_t*)des)[i] = (uint32_t)t;
+        Shoup_precomp_uint32((uint32_t*)des_Shoup + i, (uint32_t*)des + i, mod);
+    }
+
+}
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+void gen_Shoup_table_uint64(
+    void *des, void *des_Shoup,
+    const void *src, size_t len,
+    const void *mod
+    ){
+
+    int64_t t;
+
+    for(size_t i = 0; i < len; i++){
+        t = ((int64_t*)src)[i];
+        if(t < 0){
+            t += *(uint64_t*)mod;
+        }
+        ((uint64_t*)des)[i] = (uint64_t)t;
+        Shoup_precomp_uint64((uint64_t*)des_Shoup + i, (uint64_t*)des + i, mod);
+    }
+
+}
 
+#endif
 
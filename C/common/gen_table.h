@@ -52,6 +52,121 @@ void gen_streamlined_inv_CT_table(
     struct ring ring
     );
 
+// The counterparts of gen_streamlined_DWT_table and gen_streamlined_inv_CT_table writing the
+// re-ordered tables directly in O(NTT_N) multiplications without calls to expZ or the
+// intermediate level-ordered tables. The outputs are byte-identical to the above for rings with
+// exact arithmetic.
+// The functions run on the calling thread, so the ring may keep its modulus in thread-local
+// storage and callers may generate independent tables in parallel.
+void gen_streamlined_DWT_table_direct(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile, bool pad,
+    struct ring ring
+    );
+
+void gen_streamlined_inv_CT_table_direct(
+    void *des,
+    const void *scale, const void *omega,
+    struct compress_profile _profile, bool pad,
+    struct ring ring
+    );
+
+// The same with the levels generated in parallel if OpenMP is enabled. Called from a parallel
+// region, they run in nested regions, which only get threads with OMP_MAX_ACTIVE_LEVELS >= 2.
+// Each worker thread calls bind(ctx) before using the ring, so a ring keeping its modulus in
+// thread-local storage can set it there; bind may be NULL for rings without such state.
+// The inverse table only copies the powers of omega in parallel, so it needs no bind.
+void gen_streamlined_DWT_table_direct_parallel(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile, bool pad,
+    struct ring ring,
+    void (*bind)(const void *ctx), const void *ctx
+    );
+
+void gen_streamlined_inv_CT_table_direct_parallel(
+    void *des,
+    const void *scale, const void *omega,
+    struct compress_profile _profile, bool pad,
+    struct ring ring
+    );
+
+// ================================
+
+// Choose TWIDDLE_REPLICATE for the levels with at least vec_n butterflies per block and
+// TWIDDLE_INTERLEAVE for the rest.
+void gen_default_twiddle_layout(
+    struct twiddle_layout *des,
+    size_t vec_n, size_t align,
+    struct compress_profile _profile
+    );
+
+// Check _layout against _profile: vec_n is a power of two with 1 <= vec_n <= ARRAY_N / 2,
+// align >= 1, and every level with TWIDDLE_SCALAR or TWIDDLE_REPLICATE has at least vec_n
+// butterflies per block so that a vector of twiddle factors never spans two blocks.
+bool check_twiddle_layout(
+    struct compress_profile _profile,
+    struct twiddle_layout _layout
+    );
+
+// Compute the offsets (in elements) of the levels in a table laid out according to _layout.
+// Returns the number of elements of the table.
+size_t get_twiddle_layout_offsets(
+    size_t *des,
+    struct compress_profile _profile,
+    struct twiddle_layout _layout
+    );
+
+// Generate twiddle factors for DWT with Cooley-Tukey butterflies laid out according to _layout.
+// The twiddle factors are the ones of gen_DWT_table. des must hold get_twiddle_layout_offsets
+// elements. _layout must pass check_twiddle_layout. See vec_CT_NTT and vec_GS_iNTT.
+void gen_vec_DWT_table(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile,
+    struct twiddle_layout _layout,
+    struct ring ring
+    );
+
+// ================================
+
+// Generate twiddle factors for the constant-geometry DWT with Cooley-Tukey butterflies.
+// For each level, the table holds NTT_N / 2 twiddle factors, one per butterfly, so all
+// the layers in CG_CT_NTT and CG_GS_iNTT share the same addressing.
+// The table contains LOGNTT_N * (NTT_N / 2) elements.
+void gen_CG_DWT_table(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// ================================
+
+// Generate the seed table for the on-the-fly DWT with Cooley-Tukey butterflies.
+// The table contains the LOGNTT_N twiddle factors of the 0-th blocks followed by LOGNTT_N - 1
+// ratios. OTF_CT_NTT and OTF_GS_iNTT regenerate the twiddle factors of gen_DWT_table with one
+// multiplication each. omega must satisfy omega^NTT_N = 1.
+void gen_OTF_DWT_seed(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Generate the two-level (coarse x fine) table for the DWT with Cooley-Tukey butterflies.
+// The table contains LOGNTT_N twiddle factors of the 0-th blocks, 2^log_fine fine factors, and
+// (NTT_N / 2) / 2^log_fine coarse factors. log_fine must be at most LOGNTT_N - 1.
+// See two_level_CT_NTT and two_level_GS_iNTT.
+void gen_two_level_DWT_table(
+    void *des,
+    const void *scale, const void *omega, const void *zeta,
+    size_t log_fine,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
 // ================================
 
 // Generate twiddle factors for twisting (x^NTT_N - omega^NTT_N) to (x^NTT_N - 1).
@@ -72,5 +187,86 @@ void gen_mul_table(
     struct ring ring
     );
 
+// ================================
+
+// Generate the tables for Rader's algorithm computing the size-p DFT for an odd prime p.
+// Let g be the smallest generator of Z_p^* and M = p - 1. The size-p DFT is reduced to the
+// size-M cyclic convolution of u_a = x_{g^(-a)} and v_c = omega_p^(g^c).
+// - perm receives 2 M indices: perm[a] = g^(-a) mod p and perm[M + b] = g^b mod p.
+// - kernel receives the NTT_N elements CT_NTT(v') scale where v' is
+//   - v if NTT_N = M, or
+//   - (v_1, ..., v_{M - 1}, v_0, ..., v_{M - 1}) followed by zeros if NTT_N >= 2 M.
+// _root_table is the table of the cyclic NTT of size NTT_N from gen_DWT_table.
+// Set *scale to NTT_N^(-1) for GS_iNTT in Rader_DFT.
+void gen_Rader_table(
+    size_t *perm, void *kernel,
+    size_t p, const void *omega_p, const void *scale,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// ================================
+
+// Generate the matrix side of NTT_TMVP.
+// src holds the compressed format of a len x len Toeplitz matrix with 2 len - 1 elements.
+// des receives the NTT_N elements GS_iNTT_T(src) scale where src is padded with zeros and
+// _iroot_table is the table for GS_iNTT. Set *scale to NTT_N^(-1).
+void gen_TMVP_table(
+    void *des,
+    const void *src, size_t len,
+    const void *scale,
+    const void *_iroot_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Generate the table for Bruun's FFT.
+// Let psi be a principal (4 NTT_N)-th root of unity in an extension of the coefficient ring
+// and *cos = psi + psi^(-1). We write C_e = psi^e + psi^(-e) and compute C_e from *cos with
+// the recurrence C_{e + 1} = C_1 C_e - C_{e - 1}.
+// The k-th block at the level-th layer is the modulus
+// x^(4 m) - (c^2 - 2) x^(2 m) + 1 = (x^(2 m) - c x^m + 1) (x^(2 m) + c x^m + 1)
+// where m = ARRAY_N >> (level + 2) and c = C_e with
+// e = 2^(LOGNTT_N - 1 - level) (1 + 2 brv(k)) and brv reversing level + 1 bits.
+// Each block holds the pair (c^c_exp, c^2 - 1) at ((1 << level) - 1) + k.
+// Use c_exp = 1 for Bruun_NTT and c_exp with c^c_exp = c^(-1) (e.g. Q - 2) for Bruun_iNTT.
+// The table contains 2 (NTT_N - 1) elements.
+void gen_Bruun_table(
+    void *des,
+    const void *cos, size_t c_exp,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Generate the NTT_N twiddle factors for the base multiplications after Bruun_NTT.
+// The k-th block of size ARRAY_N / NTT_N is in R[x] / (x^(2 m) - des[k] x^m + 1).
+void gen_Bruun_mul_table(
+    void *des,
+    const void *cos,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Generate tables for Harvey's lazy butterflies from a table of twiddle factors with signed
+// representatives (for example, from gen_DWT_table over Z_{*mod} with cmod_int32).
+// des receives the representatives in [0, *mod) and des_Shoup receives floor(des[i] 2^32 / *mod).
+void gen_Shoup_table_uint32(
+    void *des, void *des_Shoup,
+    const void *src, size_t len,
+    const void *mod
+    );
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+// The 64-bit counterpart of gen_Shoup_table_uint32 with src holding int64_t.
+void gen_Shoup_table_uint64(
+    void *des, void *des_Shoup,
+    const void *src, size_t len,
+    const void *mod
+    );
+
+#endif
+
 #endif
 
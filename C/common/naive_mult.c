@@ -34,6 +34,37 @@ void naive_mulR(
 
 }
 
+// Multiplying size-len polynomials stored at src1 and src2 in
+// R[x] / (x^len - twiddle x^(len / 2) + 1) where R = ring and len is even.
+// We reduce from the top with x^len = twiddle x^(len / 2) - 1.
+void naive_mul_trinomial(
+    void *des,
+    const void *src1, const void *src2,
+    size_t len, const void *twiddle,
+    struct ring ring
+    ){
+
+    char buff[(len << 1) * ring.sizeZ];
+    char tmp[ring.sizeZ];
+
+    memset(buff, 0, (len << 1) * ring.sizeZ);
+
+    for(size_t i = 0; i < len; i++){
+        for(size_t j = 0; j < len; j++){
+            ring.mulZ(tmp, src1 + i * ring.sizeZ, src2 + j * ring.sizeZ);
+            ring.addZ(buff + (i + j) * ring.sizeZ, buff + (i + j) * ring.sizeZ, tmp);
+        }
+    }
+
+    for(size_t i = ((len - 1) << 1); i >= len; i--){
+        ring.mulZ(tmp, buff + i * ring.sizeZ, twiddle);
+        ring.addZ(buff + (i - (len >> 1)) * ring.sizeZ, buff + (i - (len >> 1)) * ring.sizeZ, tmp);
+        ring.subZ(buff + (i - len) * ring.sizeZ, buff + (i - len) * ring.sizeZ, buff + i * ring.sizeZ);
+    }
+    memcpy(des, buff, len * ring.sizeZ);
+
+}
+
 // Multiplying size-len polynomials stored at src1 and src2 in R[x] where R = ring.
 void naive_mul_long(
     void *des,
@@ -17,6 +17,16 @@ void naive_mulR(
     struct ring ring
     );
 
+// Multiplying size-len polynomials stored at src1 and src2 in
+// R[x] / (x^len - twiddle x^(len / 2) + 1) where R = ring and len is even.
+// The resulting polynomial is stored at des.
+void naive_mul_trinomial(
+    void *des,
+    const void *src1, const void *src2,
+    size_t len, const void *twiddle,
+    struct ring ring
+    );
+
 // Multiplying size-len polynomials stored at src1 and src2 in R[x] where R = ring.
 // The resulting polynomial is stored at des.
 void naive_mul_long(
@@ -1,7 +1,10 @@
 
 #include <memory.h>
+#include <assert.h>
 
 #include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
 #include "ntt_c.h"
 
 // ================================
@@ -110,6 +113,62 @@ void GS_iNTT_core(
 
 }
 
+// ================================
+void CG_CT_NTT_core(
+    void *des, const void *src,
+    size_t level,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t half, chunk;
+    const void *real_root_table;
+    char tmp[ring.sizeZ];
+
+    half = _profile.ntt_n >> 1;
+    chunk = _profile.array_n >> _profile.log_ntt_n;
+    real_root_table = _root_table + level * half * ring.sizeZ;
+
+    for(size_t i = 0; i < half; i++){
+        for(size_t j = 0; j < chunk; j++){
+            ring.mulZ(tmp, src + ((i + half) * chunk + j) * ring.sizeZ, real_root_table);
+            ring.addZ(des + ((2 * i + 0) * chunk + j) * ring.sizeZ, src + (i * chunk + j) * ring.sizeZ, tmp);
+            ring.subZ(des + ((2 * i + 1) * chunk + j) * ring.sizeZ, src + (i * chunk + j) * ring.sizeZ, tmp);
+        }
+        real_root_table += ring.sizeZ;
+    }
+
+}
+
+// ================================
+void CG_GS_iNTT_core(
+    void *des, const void *src,
+    size_t level,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t half, chunk;
+    const void *real_root_table;
+    char tmp[ring.sizeZ];
+
+    half = _profile.ntt_n >> 1;
+    chunk = _profile.array_n >> _profile.log_ntt_n;
+    real_root_table = _root_table + level * half * ring.sizeZ;
+
+    for(size_t i = 0; i < half; i++){
+        for(size_t j = 0; j < chunk; j++){
+            ring.subZ(tmp, src + ((2 * i + 0) * chunk + j) * ring.sizeZ, src + ((2 * i + 1) * chunk + j) * ring.sizeZ);
+            ring.addZ(des + (i * chunk + j) * ring.sizeZ, src + ((2 * i + 0) * chunk + j) * ring.sizeZ, src + ((2 * i + 1) * chunk + j) * ring.sizeZ);
+            ring.mulZ(des + ((i + half) * chunk + j) * ring.sizeZ, tmp, real_root_table);
+        }
+        real_root_table += ring.sizeZ;
+    }
+
+}
+
 // ================================
 void CT_NTT(
     void *src,
@@ -153,6 +212,997 @@ void GS_iNTT(
 }
 
 // ================================
+// The constant-geometry layers are out-of-place, so we alternate between src and buff.
+void CG_CT_NTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    char buff[_profile.array_n * ring.sizeZ];
+    void *in, *out, *t;
+
+    in = src;
+    out = buff;
+    for(size_t i = 0; i < _profile.log_ntt_n; i++){
+        CG_CT_NTT_core(out, in, i, _root_table, _profile, ring);
+        t = in; in = out; out = t;
+    }
+
+    if(in != src){
+        memcpy(src, in, _profile.array_n * ring.sizeZ);
+    }
+
+}
+
+// ================================
+void CG_GS_iNTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    char buff[_profile.array_n * ring.sizeZ];
+    void *in, *out, *t;
+
+    in = src;
+    out = buff;
+    for(ptrdiff_t i = _profile.log_ntt_n - 1; i >= 0; i--){
+        CG_GS_iNTT_core(out, in, i, _root_table, _profile, ring);
+        t = in; in = out; out = t;
+    }
+
+    if(in != src){
+        memcpy(src, in, _profile.array_n * ring.sizeZ);
+    }
+
+}
+
+// ================================
+// The transpose of a Cooley--Tukey butterfly (a, b) -> (a + w b, a - w b) is the
+// Gentleman--Sande butterfly (a, b) -> (a + b, (a - b) w) with the same twiddle factor, so
+// the transpose of CT_NTT applies GS_iNTT_core with the same table in reverse order.
+void CT_NTT_T(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    for(ptrdiff_t i = _profile.log_ntt_n - 1; i >= 0; i--){
+        GS_iNTT_core(src, i, _root_table, _profile, ring);
+    }
+
+}
+
+// ================================
+// Conversely, the transpose of GS_iNTT applies CT_NTT_core with the same table.
+void GS_iNTT_T(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    for(size_t i = 0; i < _profile.log_ntt_n; i++){
+        CT_NTT_core(src, i, _root_table, _profile, ring);
+    }
+
+}
+
+// ================================
+// The product c = a b of size-len polynomials is c = I diag(E b) E a where E is CT_NTT and
+// I is GS_iNTT scaled by NTT_N^(-1). Transposing a -> c, we find
+// sum_k b_(k - j) t_k = (E^T diag(E b) I^T t)_j, and reversing the output gives the
+// Toeplitz matrix-vector product with b = src_V.
+void NTT_TMVP(
+    void *des,
+    const void *src_M, const void *src_V,
+    size_t len,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    char buff[_profile.ntt_n * ring.sizeZ];
+
+    memset(buff, 0, _profile.ntt_n * ring.sizeZ);
+    memcpy(buff, src_V, len * ring.sizeZ);
+
+    CT_NTT(buff, _root_table, _profile, ring);
+    point_mul(buff, buff, src_M, _profile.ntt_n, 1, ring);
+    CT_NTT_T(buff, _root_table, _profile, ring);
+
+    for(size_t i = 0; i < len; i++){
+        memcpy(des + i * ring.sizeZ, buff + (len - 1 - i) * ring.sizeZ, ring.sizeZ);
+    }
+
+}
+
+// ================================
+
+void NTT_prepare(
+    void *des,
+    const void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    memmove(des, src, _profile.array_n * ring.sizeZ);
+    CT_NTT(des, _root_table, _profile, ring);
+
+}
+
+void NTT_mul_prepared(
+    void *des,
+    const void *src1, const void *src2_prepared,
+    const void *_root_table, const void *_iroot_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    char buff[_profile.array_n * ring.sizeZ];
+
+    memcpy(buff, src1, _profile.array_n * ring.sizeZ);
+
+    CT_NTT(buff, _root_table, _profile, ring);
+    point_mul(des, buff, src2_prepared, _profile.array_n, 1, ring);
+    GS_iNTT(des, _iroot_table, _profile, ring);
+
+}
+
+// ================================
+// The block of size len at the position b len of the level-th layer is transformed with
+// in_len possibly non-zero inputs and out_len required outputs.
+static
+void TFT_recur(
+    void *src,
+    size_t level, size_t b, size_t len,
+    size_t in_len, size_t out_len,
+    const void *_root_table,
+    struct ring ring
+    ){
+
+    size_t half;
+    const void *twiddle;
+    char tmp[ring.sizeZ];
+
+    // All the inputs are zero, so are the outputs.
+    if(in_len == 0){
+        memset(src, 0, out_len * ring.sizeZ);
+        return;
+    }
+
+    if((len == 1) || (out_len == 0)){
+        return;
+    }
+
+    half = len >> 1;
+    twiddle = _root_table + (((1u << level) - 1) + b) * ring.sizeZ;
+
+    for(size_t j = 0; j < half; j++){
+        if(j + half < in_len){
+            if(out_len > half){
+                CT_butterfly(src, j, j + half, twiddle, ring);
+            }else{
+                ring.mulZ(tmp, src + (j + half) * ring.sizeZ, twiddle);
+                ring.addZ(src + j * ring.sizeZ, src + j * ring.sizeZ, tmp);
+            }
+        }else{
+            // The input at j + half is zero.
+            if(out_len > half){
+                memcpy(src + (j + half) * ring.sizeZ, src + j * ring.sizeZ, ring.sizeZ);
+            }
+        }
+    }
+
+    in_len = (in_len > half) ? half : in_len;
+
+    TFT_recur(src, level + 1, 2 * b, half,
+        in_len, (out_len > half) ? half : out_len, _root_table, ring);
+    if(out_len > half){
+        TFT_recur(src + half * ring.sizeZ, level + 1, 2 * b + 1, half,
+            in_len, out_len - half, _root_table, ring);
+    }
+
+}
+
+// ================================
+void TFT(
+    void *src,
+    size_t in_len, size_t out_len,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    TFT_recur(src, 0, 0, _profile.ntt_n, in_len, out_len, _root_table, ring);
+
+}
+
+// ================================
+// The block of size len at the position b len of the level-th layer holds the outputs
+// at [0, k) and the inputs at [k, len).
+// On return, [0, k) holds the inputs and [k, len) is unchanged.
+// Let (x_j, x_{j + half}) be the inputs and w be the twiddle factor. Then the children
+// hold the inputs y_j = x_j + w x_{j + half} and z_j = x_j - w x_{j + half}.
+static
+void iTFT_recur(
+    void *src,
+    size_t level, size_t b, size_t len,
+    size_t k,
+    const void *_root_table, const void *_iroot_table,
+    const void *inv2,
+    struct ring ring
+    ){
+
+    size_t half;
+    const void *twiddle, *itwiddle;
+    char tmp[ring.sizeZ];
+
+    if((len == 1) || (k == 0)){
+        return;
+    }
+
+    half = len >> 1;
+    twiddle = _root_table + (((1u << level) - 1) + b) * ring.sizeZ;
+    itwiddle = _iroot_table + (((1u << level) - 1) + b) * ring.sizeZ;
+
+    if(k <= half){
+
+        // Compute the known inputs y_j for j in [k, half).
+        for(size_t j = k; j < half; j++){
+            ring.mulZ(tmp, src + (j + half) * ring.sizeZ, twiddle);
+            ring.addZ(src + j * ring.sizeZ, src + j * ring.sizeZ, tmp);
+        }
+
+        iTFT_recur(src, level + 1, 2 * b, half, k,
+            _root_table, _iroot_table, inv2, ring);
+
+        // x_j = y_j - w x_{j + half}.
+        for(size_t j = 0; j < half; j++){
+            ring.mulZ(tmp, src + (j + half) * ring.sizeZ, twiddle);
+            ring.subZ(src + j * ring.sizeZ, src + j * ring.sizeZ, tmp);
+        }
+
+        return;
+
+    }
+
+    // All the outputs of the first child are known.
+    iTFT_recur(src, level + 1, 2 * b, half, half,
+        _root_table, _iroot_table, inv2, ring);
+
+    // For j in [k - half, half), x_{j + half} is known.
+    // x_j = y_j - w x_{j + half} and z_j = x_j - w x_{j + half}.
+    for(size_t j = k - half; j < half; j++){
+        ring.mulZ(tmp, src + (j + half) * ring.sizeZ, twiddle);
+        ring.subZ(src + j * ring.sizeZ, src + j * ring.sizeZ, tmp);
+        ring.subZ(src + (j + half) * ring.sizeZ, src + j * ring.sizeZ, tmp);
+    }
+
+    iTFT_recur(src + half * ring.sizeZ, level + 1, 2 * b + 1, half, k - half,
+        _root_table, _iroot_table, inv2, ring);
+
+    // For j in [0, k - half), x_j = (y_j + z_j) / 2 and x_{j + half} = (y_j - z_j) w^(-1) / 2.
+    for(size_t j = 0; j < k - half; j++){
+        GS_butterfly(src, j, j + half, itwiddle, ring);
+        ring.mulZ(src + j * ring.sizeZ, src + j * ring.sizeZ, inv2);
+        ring.mulZ(src + (j + half) * ring.sizeZ, src + (j + half) * ring.sizeZ, inv2);
+    }
+
+    // Restore x_{j + half} = (x_j - z_j) w^(-1) for j in [k - half, half).
+    for(size_t j = k - half; j < half; j++){
+        ring.subZ(tmp, src + j * ring.sizeZ, src + (j + half) * ring.sizeZ);
+        ring.mulZ(src + (j + half) * ring.sizeZ, tmp, itwiddle);
+    }
+
+}
+
+// ================================
+void iTFT(
+    void *src,
+    size_t len,
+    const void *_root_table, const void *_iroot_table,
+    const void *inv2,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    iTFT_recur(src, 0, 0, _profile.ntt_n, len,
+        _root_table, _iroot_table, inv2, ring);
+
+}
+
+// ================================
+// With n = g^(-a) and k = g^b, we have
+// des_{g^b} = src_0 + sum_a src_{g^(-a)} omega_p^(g^(b - a)).
+// If NTT_N = p - 1, the cyclic convolution is computed directly.
+// Otherwise, the kernel is the periodic extension of length 2 (p - 1) - 1 and the
+// results are at the positions [p - 1, 2 (p - 1)) of the linear convolution.
+void Rader_DFT(
+    void *des, const void *src,
+    size_t p,
+    const size_t *perm, const void *kernel,
+    const void *_root_table, const void *_iroot_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t M, offset;
+    char buff[_profile.ntt_n * ring.sizeZ];
+    char src0[ring.sizeZ], sum[ring.sizeZ];
+
+    M = p - 1;
+    offset = (_profile.ntt_n == M) ? 0 : M - 1;
+
+    memcpy(src0, src, ring.sizeZ);
+    memcpy(sum, src, ring.sizeZ);
+    for(size_t i = 1; i < p; i++){
+        ring.addZ(sum, sum, src + i * ring.sizeZ);
+    }
+
+    memset(buff, 0, _profile.ntt_n * ring.sizeZ);
+    for(size_t a = 0; a < M; a++){
+        memcpy(buff + a * ring.sizeZ, src + perm[a] * ring.sizeZ, ring.sizeZ);
+    }
+
+    CT_NTT(buff, _root_table, _profile, ring);
+    point_mul(buff, buff, kernel, _profile.ntt_n, 1, ring);
+    GS_iNTT(buff, _iroot_table, _profile, ring);
+
+    memcpy(des, sum, ring.sizeZ);
+    for(size_t b = 0; b < M; b++){
+        ring.addZ(des + perm[M + b] * ring.sizeZ, src0, buff + (offset + b) * ring.sizeZ);
+    }
+
+}
+
+// ================================
+// Bruun butterfly.
+// Let (f0, f1, f2, f3) = (src[0], src[m], src[2 m], src[3 m]). Modulo x^(2 m) -+ c x^m + 1,
+// we have x^(2 m) = +-c x^m - 1 and x^(3 m) = (c^2 - 1) x^m -+ c, so
+// f = (f0 - f2 -+ c f3) + (f1 + (c^2 - 1) f3 +- c f2) x^m.
+void Bruun_butterfly(
+    void *src,
+    size_t m,
+    const void *twiddle,
+    struct ring ring
+    ){
+
+    char u0[ring.sizeZ], u1[ring.sizeZ];
+    char w0[ring.sizeZ], w1[ring.sizeZ];
+
+    ring.subZ(u0, src, src + 2 * m * ring.sizeZ);
+    ring.mulZ(u1, src + 3 * m * ring.sizeZ, twiddle + ring.sizeZ);
+    ring.addZ(u1, src + m * ring.sizeZ, u1);
+    ring.mulZ(w0, src + 3 * m * ring.sizeZ, twiddle);
+    ring.mulZ(w1, src + 2 * m * ring.sizeZ, twiddle);
+
+    ring.subZ(src, u0, w0);
+    ring.addZ(src + m * ring.sizeZ, u1, w1);
+    ring.addZ(src + 2 * m * ring.sizeZ, u0, w0);
+    ring.subZ(src + 3 * m * ring.sizeZ, u1, w1);
+
+}
+
+// ================================
+// Inverse Bruun butterfly scaled by 2.
+void Bruun_ibutterfly(
+    void *src,
+    size_t m,
+    const void *twiddle,
+    struct ring ring
+    ){
+
+    char f2[ring.sizeZ], f3[ring.sizeZ];
+    char tmp[ring.sizeZ];
+
+    // 2 f3 = (lo+ - lo-) c^(-1) and 2 f2 = (hi- - hi+) c^(-1).
+    ring.subZ(f3, src + 2 * m * ring.sizeZ, src);
+    ring.mulZ(f3, f3, twiddle);
+    ring.subZ(f2, src + m * ring.sizeZ, src + 3 * m * ring.sizeZ);
+    ring.mulZ(f2, f2, twiddle);
+
+    // 2 f0 = (lo+ + lo-) + 2 f2 and 2 f1 = (hi- + hi+) - (c^2 - 1) 2 f3.
+    ring.addZ(src, src, src + 2 * m * ring.sizeZ);
+    ring.addZ(src, src, f2);
+    ring.addZ(src + m * ring.sizeZ, src + m * ring.sizeZ, src + 3 * m * ring.sizeZ);
+    ring.mulZ(tmp, f3, twiddle + ring.sizeZ);
+    ring.subZ(src + m * ring.sizeZ, src + m * ring.sizeZ, tmp);
+
+    memcpy(src + 2 * m * ring.sizeZ, f2, ring.sizeZ);
+    memcpy(src + 3 * m * ring.sizeZ, f3, ring.sizeZ);
+
+}
+
+// ================================
+// The layers start_level, ..., start_level + layers - 1 restricted to the
+// block_indx-th block of size ARRAY_N / 2^start_level.
+static
+void m_layer_Bruun_butterfly(
+    void *src,
+    size_t start_level, size_t layers, size_t block_indx,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t m, block_len;
+    const void *real_root_table;
+
+    block_len = (_profile.array_n) >> start_level;
+
+    for(size_t level = start_level; level < start_level + layers; level++){
+        m = (_profile.array_n) >> (level + 2);
+        real_root_table = _root_table
+                        + 2 * ((1u << level) - 1 + (block_indx << (level - start_level))) * ring.sizeZ;
+        for(size_t i = 0; i < block_len; i += 4 * m){
+            for(size_t j = 0; j < m; j++){
+                Bruun_butterfly(src + (i + j) * ring.sizeZ, m, real_root_table, ring);
+            }
+            real_root_table += 2 * ring.sizeZ;
+        }
+    }
+
+}
+
+// ================================
+// Inverse of m_layer_Bruun_butterfly scaled by 2^layers.
+static
+void m_layer_Bruun_ibutterfly(
+    void *src,
+    size_t start_level, size_t layers, size_t block_indx,
+    const void *_iroot_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t m, block_len;
+    const void *real_root_table;
+
+    block_len = (_profile.array_n) >> start_level;
+
+    for(size_t level = start_level + layers; level-- > start_level;){
+        m = (_profile.array_n) >> (level + 2);
+        real_root_table = _iroot_table
+                        + 2 * ((1u << level) - 1 + (block_indx << (level - start_level))) * ring.sizeZ;
+        for(size_t i = 0; i < block_len; i += 4 * m){
+            for(size_t j = 0; j < m; j++){
+                Bruun_ibutterfly(src + (i + j) * ring.sizeZ, m, real_root_table, ring);
+            }
+            real_root_table += 2 * ring.sizeZ;
+        }
+    }
+
+}
+
+// ================================
+void Bruun_NTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t start_level, block_len;
+
+    start_level = 0;
+    for(size_t i = 0; i < _profile.compressed_layers; i++){
+        block_len = (_profile.array_n) >> start_level;
+        for(size_t k = 0; k < (1u << start_level); k++){
+            m_layer_Bruun_butterfly(src + k * block_len * ring.sizeZ,
+                start_level, _profile.merged_layers[i], k,
+                _root_table, _profile, ring);
+        }
+        start_level += _profile.merged_layers[i];
+    }
+    assert(start_level == _profile.log_ntt_n);
+
+}
+
+// ================================
+void Bruun_iNTT(
+    void *src,
+    const void *_iroot_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t start_level, block_len;
+
+    start_level = _profile.log_ntt_n;
+    for(size_t i = _profile.compressed_layers; i-- > 0;){
+        assert(start_level >= _profile.merged_layers[i]);
+        start_level -= _profile.merged_layers[i];
+        block_len = (_profile.array_n) >> start_level;
+        for(size_t k = 0; k < (1u << start_level); k++){
+            m_layer_Bruun_ibutterfly(src + k * block_len * ring.sizeZ,
+                start_level, _profile.merged_layers[i], k,
+                _iroot_table, _profile, ring);
+        }
+    }
+    assert(start_level == 0);
+
+}
+
+// ================================
+// The twiddle factor of block k + 1 is the twiddle factor of block k multiplied by
+// the ratio indexed by the number of trailing ones of k. See gen_OTF_DWT_seed.
+void OTF_CT_NTT(
+    void *src,
+    const void *_seed_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t step, count;
+    const void *ratio_table;
+    char twiddle[ring.sizeZ];
+
+    ratio_table = _seed_table + _profile.log_ntt_n * ring.sizeZ;
+
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+
+        step = (_profile.array_n) >> (level + 1);
+        memcpy(twiddle, _seed_table + level * ring.sizeZ, ring.sizeZ);
+
+        for(size_t k = 0; k < (1u << level); k++){
+            for(size_t j = 0; j < step; j++){
+                CT_butterfly(src + (2 * k * step + j) * ring.sizeZ, 0, step, twiddle, ring);
+            }
+            if(k + 1 < (1u << level)){
+                for(count = 0; (k >> count) & 1; count++);
+                ring.mulZ(twiddle, twiddle, ratio_table + count * ring.sizeZ);
+            }
+        }
+
+    }
+
+}
+
+// ================================
+void OTF_GS_iNTT(
+    void *src,
+    const void *_seed_table,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t step, count;
+    const void *ratio_table;
+    char twiddle[ring.sizeZ];
+
+    ratio_table = _seed_table + _profile.log_ntt_n * ring.sizeZ;
+
+    for(ptrdiff_t level = _profile.log_ntt_n - 1; level >= 0; level--){
+
+        step = (_profile.array_n) >> (level + 1);
+        memcpy(twiddle, _seed_table + level * ring.sizeZ, ring.sizeZ);
+
+        for(size_t k = 0; k < (1u << level); k++){
+            for(size_t j = 0; j < step; j++){
+                GS_butterfly(src + (2 * k * step + j) * ring.sizeZ, 0, step, twiddle, ring);
+            }
+            if(k + 1 < (1u << level)){
+                for(count = 0; (k >> count) & 1; count++);
+                ring.mulZ(twiddle, twiddle, ratio_table + count * ring.sizeZ);
+            }
+        }
+
+    }
+
+}
+
+// ================================
+// The twiddle factor of block k is start[level] coarse[k >> log_fine] fine[k mod 2^log_fine].
+// We multiply start[level] coarse[k >> log_fine] once for every 2^log_fine blocks.
+void two_level_CT_NTT(
+    void *src,
+    const void *_two_level_table, size_t log_fine,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t step, mask;
+    const void *fine_table, *coarse_table;
+    char coarse[ring.sizeZ];
+    char twiddle[ring.sizeZ];
+
+    fine_table = _two_level_table + _profile.log_ntt_n * ring.sizeZ;
+    coarse_table = fine_table + (1u << log_fine) * ring.sizeZ;
+    mask = (1u << log_fine) - 1;
+
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+
+        step = (_profile.array_n) >> (level + 1);
+
+        for(size_t k = 0; k < (1u << level); k++){
+            if((k & mask) == 0){
+                ring.mulZ(coarse, _two_level_table + level * ring.sizeZ, coarse_table + (k >> log_fine) * ring.sizeZ);
+            }
+            ring.mulZ(twiddle, coarse, fine_table + (k & mask) * ring.sizeZ);
+            for(size_t j = 0; j < step; j++){
+                CT_butterfly(src + (2 * k * step + j) * ring.sizeZ, 0, step, twiddle, ring);
+            }
+        }
+
+    }
+
+}
+
+// ================================
+void two_level_GS_iNTT(
+    void *src,
+    const void *_two_level_table, size_t log_fine,
+    struct compress_profile _profile,
+    struct ring ring
+    ){
+
+    size_t step, mask;
+    const void *fine_table, *coarse_table;
+    char coarse[ring.sizeZ];
+    char twiddle[ring.sizeZ];
+
+    fine_table = _two_level_table + _profile.log_ntt_n * ring.sizeZ;
+    coarse_table = fine_table + (1u << log_fine) * ring.sizeZ;
+    mask = (1u << log_fine) - 1;
+
+    for(ptrdiff_t level = _profile.log_ntt_n - 1; level >= 0; level--){
+
+        step = (_profile.array_n) >> (level + 1);
+
+        for(size_t k = 0; k < (1u << level); k++){
+            if((k & mask) == 0){
+                ring.mulZ(coarse, _two_level_table + level * ring.sizeZ, coarse_table + (k >> log_fine) * ring.sizeZ);
+            }
+            ring.mulZ(twiddle, coarse, fine_table + (k & mask) * ring.sizeZ);
+            for(size_t j = 0; j < step; j++){
+                GS_butterfly(src + (2 * k * step + j) * ring.sizeZ, 0, step, twiddle, ring);
+            }
+        }
+
+    }
+
+}
+
+// ================================
+// Load the twiddle factors of the v-th group of butterflies of level as one vector.
+// The vector lies in one block for TWIDDLE_SCALAR and TWIDDLE_REPLICATE (see check_twiddle_layout).
+static
+void vec_load_twiddle(
+    void *des,
+    const void *_level_table, size_t level, size_t v,
+    struct compress_profile _profile,
+    struct twiddle_layout _layout,
+    struct ring ring
+    ){
+
+    size_t step = (_profile.array_n) >> (level + 1);
+    size_t b = v * _layout.vec_n;
+
+    switch(_layout.mode[level]){
+        case TWIDDLE_SCALAR:
+            for(size_t t = 0; t < _layout.vec_n; t++){
+                memcpy(des + t * ring.sizeZ, _level_table + (b / step) * ring.sizeZ, ring.sizeZ);
+            }
+            break;
+        case TWIDDLE_REPLICATE:
+            memcpy(des, _level_table + (b / step) * _layout.vec_n * ring.sizeZ, _layout.vec_n * ring.sizeZ);
+            break;
+        default:
+            memcpy(des, _level_table + b * ring.sizeZ, _layout.vec_n * ring.sizeZ);
+            break;
+    }
+
+}
+
+// ================================
+void vec_CT_NTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct twiddle_layout _layout,
+    struct ring ring
+    ){
+
+    size_t offsets[_profile.log_ntt_n];
+    size_t step, b;
+    char twiddle[_layout.vec_n * ring.sizeZ];
+
+    assert(check_twiddle_layout(_profile, _layout));
+
+    get_twiddle_layout_offsets(offsets, _profile, _layout);
+
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+        step = (_profile.array_n) >> (level + 1);
+        for(size_t v = 0; v < ((_profile.array_n) >> 1) / _layout.vec_n; v++){
+            vec_load_twiddle(twiddle, _root_table + offsets[level] * ring.sizeZ, level, v,
+                _profile, _layout, ring);
+            for(size_t t = 0; t < _layout.vec_n; t++){
+                b = v * _layout.vec_n + t;
+                CT_butterfly(src + (2 * (b / step) * step + (b % step)) * ring.sizeZ, 0, step,
+                    twiddle + t * ring.sizeZ, ring);
+            }
+        }
+    }
+
+}
+
+// ================================
+void vec_GS_iNTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct twiddle_layout _layout,
+    struct ring ring
+    ){
+
+    size_t offsets[_profile.log_ntt_n];
+    size_t step, b;
+    char twiddle[_layout.vec_n * ring.sizeZ];
+
+    assert(check_twiddle_layout(_profile, _layout));
+
+    get_twiddle_layout_offsets(offsets, _profile, _layout);
+
+    for(ptrdiff_t level = _profile.log_ntt_n - 1; level >= 0; level--){
+        step = (_profile.array_n) >> (level + 1);
+        for(size_t v = 0; v < ((_profile.array_n) >> 1) / _layout.vec_n; v++){
+            vec_load_twiddle(twiddle, _root_table + offsets[level] * ring.sizeZ, level, v,
+                _profile, _layout, ring);
+            for(size_t t = 0; t < _layout.vec_n; t++){
+                b = v * _layout.vec_n + t;
+                GS_butterfly(src + (2 * (b / step) * step + (b % step)) * ring.sizeZ, 0, step,
+                    twiddle + t * ring.sizeZ, ring);
+            }
+        }
+    }
+
+}
+
+// ================================
+// Harvey's lazy Cooley-Tukey butterfly.
+void Harvey_CT_butterfly_uint32(
+    void *src,
+    size_t indx_a, size_t indx_b,
+    const void *twiddle, const void *twiddle_Shoup,
+    const void *mod
+    ){
+
+    uint32_t a, t;
+    uint32_t mod2 = (*(uint32_t*)mod) << 1;
+
+    // a in [0, 2 Q)
+    csub_uint32(&a, (uint32_t*)src + indx_a, &mod2);
+    // t in [0, 2 Q)
+    lazy_mulmod_Shoup_uint32(&t, (uint32_t*)src + indx_b, twiddle, twiddle_Shoup, mod);
+
+    // Both results are in [0, 4 Q).
+    ((uint32_t*)src)[indx_a] = a + t;
+    ((uint32_t*)src)[indx_b] = a - t + mod2;
+
+}
+
+// ================================
+// Harvey's lazy Gentleman-Sande butterfly.
+void Harvey_GS_butterfly_uint32(
+    void *src,
+    size_t indx_a, size_t indx_b,
+    const void *twiddle, const void *twiddle_Shoup,
+    const void *mod
+    ){
+
+    uint32_t a, b, t;
+    uint32_t mod2 = (*(uint32_t*)mod) << 1;
+
+    a = ((uint32_t*)src)[indx_a];
+    b = ((uint32_t*)src)[indx_b];
+
+    // t in [0, 4 Q)
+    t = a - b + mod2;
+    // a + b in [0, 4 Q) is reduced to [0, 2 Q)
+    a = a + b;
+    csub_uint32((uint32_t*)src + indx_a, &a, &mod2);
+    // t twiddle in [0, 2 Q)
+    lazy_mulmod_Shoup_uint32((uint32_t*)src + indx_b, &t, twiddle, twiddle_Shoup, mod);
+
+}
+
+// ================================
+void Harvey_CT_NTT_uint32(
+    void *src,
+    const void *_root_table, const void *_root_table_Shoup,
+    struct compress_profile _profile,
+    const void *mod
+    ){
+
+    size_t step;
+    const uint32_t *real_root_table, *real_root_table_Shoup;
+    uint32_t mod2 = (*(uint32_t*)mod) << 1;
+
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+
+        step = (_profile.array_n) >> (level + 1);
+        real_root_table = (const uint32_t*)_root_table + ((1u << level) - 1);
+        real_root_table_Shoup = (const uint32_t*)_root_table_Shoup + ((1u << level) - 1);
+
+        for(size_t i = 0; i < _profile.array_n; i += 2 * step){
+            for(size_t j = 0; j < step; j++){
+                Harvey_CT_butterfly_uint32((uint32_t*)src + i + j, 0, step, real_root_table, real_root_table_Shoup, mod);
+            }
+            real_root_table++;
+            real_root_table_Shoup++;
+        }
+
+    }
+
+    // Reduce from [0, 4 Q) to [0, Q).
+    for(size_t i = 0; i < _profile.array_n; i++){
+        csub_uint32((uint32_t*)src + i, (uint32_t*)src + i, &mod2);
+        csub_uint32((uint32_t*)src + i, (uint32_t*)src + i, mod);
+    }
+
+}
+
+// ================================
+void Harvey_GS_iNTT_uint32(
+    void *src,
+    const void *_root_table, const void *_root_table_Shoup,
+    struct compress_profile _profile,
+    const void *mod
+    ){
+
+    size_t step;
+    const uint32_t *real_root_table, *real_root_table_Shoup;
+
+    for(ptrdiff_t level = _profile.log_ntt_n - 1; level >= 0; level--){
+
+        step = (_profile.array_n) >> (level + 1);
+        real_root_table = (const uint32_t*)_root_table + ((1u << level) - 1);
+        real_root_table_Shoup = (const uint32_t*)_root_table_Shoup + ((1u << level) - 1);
+
+        for(size_t i = 0; i < _profile.array_n; i += 2 * step){
+            for(size_t j = 0; j < step; j++){
+                Harvey_GS_butterfly_uint32((uint32_t*)src + i + j, 0, step, real_root_table, real_root_table_Shoup, mod);
+            }
+            real_root_table++;
+            real_root_table_Shoup++;
+        }
+
+    }
+
+    // Reduce from [0, 2 Q) to [0, Q).
+    for(size_t i = 0; i < _profile.array_n; i++){
+        csub_uint32((uint32_t*)src + i, (uint32_t*)src + i, mod);
+    }
+
+}
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+// ================================
+// Harvey's lazy Cooley-Tukey butterfly.
+void Harvey_CT_butterfly_uint64(
+    void *src,
+    size_t indx_a, size_t indx_b,
+    const void *twiddle, const void *twiddle_Shoup,
+    const void *mod
+    ){
+
+    uint64_t a, t;
+    uint64_t mod2 = (*(uint64_t*)mod) << 1;
+
+    // a in [0, 2 Q)
+    csub_uint64(&a, (uint64_t*)src + indx_a, &mod2);
+    // t in [0, 2 Q)
+    lazy_mulmod_Shoup_uint64(&t, (uint64_t*)src + indx_b, twiddle, twiddle_Shoup, mod);
+
+    // Both results are in [0, 4 Q).
+    ((uint64_t*)src)[indx_a] = a + t;
+    ((uint64_t*)src)[indx_b] = a - t + mod2;
+
+}
+
+// ================================
+// Harvey's lazy Gentleman-Sande butterfly.
+void Harvey_GS_butterfly_uint64(
+    void *src,
+    size_t indx_a, size_t indx_b,
+    const void *twiddle, const void *twiddle_Shoup,
+    const void *mod
+    ){
+
+    uint64_t a, b, t;
+    uint64_t mod2 = (*(uint64_t*)mod) << 1;
+
+    a = ((uint64_t*)src)[indx_a];
+    b = ((uint64_t*)src)[indx_b];
+
+    // t in [0, 4 Q)
+    t = a - b + mod2;
+    // a + b in [0, 4 Q) is reduced to [0, 2 Q)
+    a = a + b;
+    csub_uint64((uint64_t*)src + indx_a, &a, &mod2);
+    // t twiddle in [0, 2 Q)
+    lazy_mulmod_Shoup_uint64((uint64_t*)src + indx_b, &t, twiddle, twiddle_Shoup, mod);
+
+}
+
+// ================================
+void Harvey_CT_NTT_uint64(
+    void *src,
+    const void *_root_table, const void *_root_table_Shoup,
+    struct compress_profile _profile,
+    const void *mod
+    ){
+
+    size_t step;
+    const uint64_t *real_root_table, *real_root_table_Shoup;
+    uint64_t mod2 = (*(uint64_t*)mod) << 1;
+
+    for(size_t level = 0; level < _profile.log_ntt_n; level++){
+
+        step = (_profile.array_n) >> (level + 1);
+        real_root_table = (const uint64_t*)_root_table + ((1u << level) - 1);
+        real_root_table_Shoup = (const uint64_t*)_root_table_Shoup + ((1u << level) - 1);
+
+        for(size_t i = 0; i < _profile.array_n; i += 2 * step){
+            for(size_t j = 0; j < step; j++){
+                Harvey_CT_butterfly_uint64((uint64_t*)src + i + j, 0, step, real_root_table, real_root_table_Shoup, mod);
+            }
+            real_root_table++;
+            real_root_table_Shoup++;
+        }
+
+    }
+
+    // Reduce from [0, 4 Q) to [0, Q).
+    for(size_t i = 0; i < _profile.array_n; i++){
+        csub_uint64((uint64_t*)src + i, (uint64_t*)src + i, &mod2);
+        csub_uint64((uint64_t*)src + i, (uint64_t*)src + i, mod);
+    }
+
+}
+
+// ================================
+void Harvey_GS_iNTT_uint64(
+    void *src,
+    const void *_root_table, const void *_root_table_Shoup,
+    struct compress_profile _profile,
+    const void *mod
+    ){
+
+    size_t step;
+    const uint64_t *real_root_table, *real_root_table_Shoup;
+
+    for(ptrdiff_t level = _profile.log_ntt_n - 1; level >= 0; level--){
+
+        step = (_profile.array_n) >> (level + 1);
+        real_root_table = (const uint64_t*)_root_table + ((1u << level) - 1);
+        real_root_table_Shoup = (const uint64_t*)_root_table_Shoup + ((1u << level) - 1);
+
+        for(size_t i = 0; i < _profile.array_n; i += 2 * step){
+            for(size_t j = 0; j < step; j++){
+                Harvey_GS_butterfly_uint64((uint64_t*)src + i + j, 0, step, real_root_table, real_root_table_Shoup, mod);
+            }
+            real_root_table++;
+            real_root_table_Shoup++;
+        }
+
+    }
+
+    // Reduce from [0, 2 Q) to [0, Q).
+    for(size_t i = 0; i < _profile.array_n; i++){
+        csub_uint64((uint64_t*)src + i, (uint64_t*)src + i, mod);
+    }
+
+}
+
+#endif
 
 // ================================
 // Multi-layer Cooley-Tukey butterfly for the forward transformation.
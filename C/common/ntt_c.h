@@ -56,6 +56,33 @@ void GS_iNTT_core(
     struct ring ring
     );
 
+// ================================
+// Core operations computing one layer of constant-geometry butterflies.
+
+// This function computes the level-th layer of Cooley--Tukey butterflies in the constant-geometry
+// (Pease) NTT. Every layer reads the pair (i, i + NTT_N / 2) from src and writes the results
+// to (2 i, 2 i + 1) in des, where each index refers to a chunk of ARRAY_N / NTT_N consecutive
+// elements. The twiddle factor of the i-th butterfly is _root_table[level * (NTT_N / 2) + i].
+// See gen_CG_DWT_table for the layout of the table.
+void CG_CT_NTT_core(
+    void *des, const void *src,
+    size_t level,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// This function computes the level-th layer of Gentleman--Sande butterflies in the constant-geometry
+// (Pease) iNTT. Every layer reads the pair (2 i, 2 i + 1) from src and writes the results
+// to (i, i + NTT_N / 2) in des. This is the exact reversal of CG_CT_NTT_core.
+void CG_GS_iNTT_core(
+    void *des, const void *src,
+    size_t level,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
 // ================================
 // NTT computations without layer-merging.
 
@@ -80,6 +107,322 @@ void GS_iNTT(
     struct ring ring
     );
 
+// Constant-geometry NTT with Cooley--Tukey butterflies.
+// The result is identical to CT_NTT with the table from gen_DWT_table.
+void CG_CT_NTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Constant-geometry iNTT with Gentleman--Sande butterflies.
+// The result is identical to GS_iNTT with the table from gen_DWT_table.
+void CG_GS_iNTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// ================================
+// Transposed NTTs.
+// For a Toeplitz matrix-vector product, we compute E^T (Hom-M(T) * E v) where the
+// matrix side Hom-M(T) = I^T T is computed once with gen_TMVP_table. See Toeplitz-TC.c for
+// the counterpart built upon Toom-4.
+
+// Transpose of CT_NTT with the same table.
+void CT_NTT_T(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Transpose of GS_iNTT with the same table.
+void GS_iNTT_T(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Toeplitz matrix-vector product des[i] = sum_j src_M'[len - 1 - i + j] src_V[j] for
+// i = 0, ..., len - 1 where src_M' is the compressed format of the len x len Toeplitz
+// matrix with 2 len - 1 elements, and src_M is the output of gen_TMVP_table for src_M'.
+// _root_table is the table of the cyclic NTT with NTT_N >= 2 len - 1 for CT_NTT.
+void NTT_TMVP(
+    void *des,
+    const void *src_M, const void *src_V,
+    size_t len,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// ================================
+// Multiplication with a prepared operand.
+// If one operand is multiplied by many polynomials (for example, the public matrix or the
+// secret), it is transformed once with NTT_prepare and only the other operand is transformed
+// for each product. We require ARRAY_N = NTT_N, so the products in the NTT domain are point-wise.
+
+// Transform src with CT_NTT and store the result at des.
+void NTT_prepare(
+    void *des,
+    const void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Multiply src1 by the polynomial prepared by NTT_prepare with the same _root_table, and
+// transform the product back with GS_iNTT and _iroot_table. The result is scaled by NTT_N.
+void NTT_mul_prepared(
+    void *des,
+    const void *src1, const void *src2_prepared,
+    const void *_root_table, const void *_iroot_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// ================================
+// Truncated Fourier transform.
+// We require ARRAY_N = NTT_N and src must hold NTT_N elements.
+// The tables are laid out as in CT_NTT (see gen_DWT_table).
+
+// Truncated Fourier transform with Cooley-Tukey butterflies.
+// The input consists of in_len coefficients and the remaining ones are treated as zeros.
+// Only the first out_len outputs of CT_NTT are computed.
+// The cost grows with max(in_len, out_len) instead of NTT_N.
+void TFT(
+    void *src,
+    size_t in_len, size_t out_len,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Inverse of the truncated Fourier transform.
+// The input consists of the first len outputs of CT_NTT of a polynomial with less than len
+// coefficients, and the elements at the positions [len, NTT_N) must be zeros.
+// The function recovers the len coefficients without any scaling.
+// _iroot_table is the table for the inverse twiddle factors and *inv2 is the inverse of 2.
+void iTFT(
+    void *src,
+    size_t len,
+    const void *_root_table, const void *_iroot_table,
+    const void *inv2,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// ================================
+// Rader's algorithm.
+
+// Size-p DFT des_k = sum_n src_n omega_p^(n k) for an odd prime p with the tables from
+// gen_Rader_table. The size-(p - 1) cyclic convolution is computed with CT_NTT and GS_iNTT
+// of size NTT_N where NTT_N = p - 1 or NTT_N >= 2 (p - 1).
+// des may be equal to src.
+void Rader_DFT(
+    void *des, const void *src,
+    size_t p,
+    const size_t *perm, const void *kernel,
+    const void *_root_table, const void *_iroot_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// ================================
+// Bruun's FFT.
+
+// Bruun butterfly reducing (src[0], src[m], src[2 m], src[3 m]) in
+// x^(4 m) - (c^2 - 2) x^(2 m) + 1 to x^(2 m) - c x^m + 1 (src[0], src[m]) and
+// x^(2 m) + c x^m + 1 (src[2 m], src[3 m]) where twiddle points to the pair (c, c^2 - 1).
+void Bruun_butterfly(
+    void *src,
+    size_t m,
+    const void *twiddle,
+    struct ring ring
+    );
+
+// Inverse of Bruun_butterfly scaled by 2 where twiddle points to the pair (c^(-1), c^2 - 1).
+void Bruun_ibutterfly(
+    void *src,
+    size_t m,
+    const void *twiddle,
+    struct ring ring
+    );
+
+// Bruun's FFT for x^ARRAY_N + 1 over rings without principal (2 ARRAY_N)-th roots of unity.
+// After LOGNTT_N layers, the k-th block of size ARRAY_N / NTT_N is in
+// R[x] / (x^(2 m) - t_k x^m + 1) where t_k is from gen_Bruun_mul_table.
+// We require ARRAY_N >= 2 NTT_N.
+// The layers are grouped as in merged_layers, and each group is applied block by block.
+// The table layout from gen_Bruun_table does not depend on the merging.
+void Bruun_NTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// Inverse of Bruun_NTT with the table from gen_Bruun_table for c^(-1).
+// The result is scaled by NTT_N.
+void Bruun_iNTT(
+    void *src,
+    const void *_iroot_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// ================================
+// NTT computations with twiddle factors generated on the fly.
+
+// NTT with Cooley-Tukey butterflies where the twiddle factors are regenerated from the
+// seed table of gen_OTF_DWT_seed with one multiplication per block.
+// The result is identical to CT_NTT with the table from gen_DWT_table.
+void OTF_CT_NTT(
+    void *src,
+    const void *_seed_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// iNTT with Gentleman-Sande butterflies where the twiddle factors are regenerated from the
+// seed table of gen_OTF_DWT_seed.
+// The result is identical to GS_iNTT with the table from gen_DWT_table.
+void OTF_GS_iNTT(
+    void *src,
+    const void *_seed_table,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// NTT with Cooley-Tukey butterflies where the twiddle factors are the products of the
+// entries of the two-level table from gen_two_level_DWT_table.
+void two_level_CT_NTT(
+    void *src,
+    const void *_two_level_table, size_t log_fine,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// iNTT with Gentleman-Sande butterflies where the twiddle factors are the products of the
+// entries of the two-level table from gen_two_level_DWT_table.
+void two_level_GS_iNTT(
+    void *src,
+    const void *_two_level_table, size_t log_fine,
+    struct compress_profile _profile,
+    struct ring ring
+    );
+
+// ================================
+// NTT computations with tables laid out for vectorization.
+// The butterflies of a level are processed in groups of _layout.vec_n consecutive butterflies,
+// modelling a vectorized implementation. The twiddle factors of a group are loaded as one
+// vector from the table of gen_vec_DWT_table: a broadcast for TWIDDLE_SCALAR and a plain load
+// for TWIDDLE_REPLICATE and TWIDDLE_INTERLEAVE, so no shuffles are needed.
+// We require check_twiddle_layout(_profile, _layout): TWIDDLE_SCALAR and TWIDDLE_REPLICATE are
+// only allowed for the levels with at least _layout.vec_n butterflies per block.
+
+// The result is identical to CT_NTT with the table from gen_DWT_table.
+void vec_CT_NTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct twiddle_layout _layout,
+    struct ring ring
+    );
+
+// The result is identical to GS_iNTT with the table from gen_DWT_table.
+void vec_GS_iNTT(
+    void *src,
+    const void *_root_table,
+    struct compress_profile _profile,
+    struct twiddle_layout _layout,
+    struct ring ring
+    );
+
+// ================================
+// Lazy butterflies over unsigned representations.
+
+// Harvey's lazy Cooley-Tukey butterfly over unsigned 32-bit integers.
+// Assume src[indx_a] and src[indx_b] are in [0, 4 *mod) and *mod < 2^30.
+// This function computes (src[indx_a] + (*twiddle) src[indx_b], src[indx_a] - (*twiddle) src[indx_b])
+// with the results in [0, 4 *mod). *twiddle_Shoup must be computed by Shoup_precomp_uint32.
+void Harvey_CT_butterfly_uint32(
+    void *src,
+    size_t indx_a, size_t indx_b,
+    const void *twiddle, const void *twiddle_Shoup,
+    const void *mod
+    );
+
+// Harvey's lazy Gentleman-Sande butterfly over unsigned 32-bit integers.
+// Assume src[indx_a] and src[indx_b] are in [0, 2 *mod) and *mod < 2^30.
+// This function computes (src[indx_a] + src[indx_b], (src[indx_a] - src[indx_b]) (*twiddle) )
+// with the results in [0, 2 *mod).
+void Harvey_GS_butterfly_uint32(
+    void *src,
+    size_t indx_a, size_t indx_b,
+    const void *twiddle, const void *twiddle_Shoup,
+    const void *mod
+    );
+
+// NTT with Harvey's lazy Cooley-Tukey butterflies.
+// The tables are laid out as in CT_NTT, see gen_Shoup_table_uint32.
+// The input must be in [0, 4 *mod). The values stay in [0, 4 *mod) throughout the layers
+// and are reduced to [0, *mod) with a single pass at the end.
+void Harvey_CT_NTT_uint32(
+    void *src,
+    const void *_root_table, const void *_root_table_Shoup,
+    struct compress_profile _profile,
+    const void *mod
+    );
+
+// iNTT with Harvey's lazy Gentleman-Sande butterflies.
+// The input must be in [0, 2 *mod). The values stay in [0, 2 *mod) throughout the layers
+// and are reduced to [0, *mod) with a single pass at the end.
+void Harvey_GS_iNTT_uint32(
+    void *src,
+    const void *_root_table, const void *_root_table_Shoup,
+    struct compress_profile _profile,
+    const void *mod
+    );
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+// The 64-bit counterparts of the above. We require *mod < 2^62.
+
+void Harvey_CT_butterfly_uint64(
+    void *src,
+    size_t indx_a, size_t indx_b,
+    const void *twiddle, const void *twiddle_Shoup,
+    const void *mod
+    );
+
+void Harvey_GS_butterfly_uint64(
+    void *src,
+    size_t indx_a, size_t indx_b,
+    const void *twiddle, const void *twiddle_Shoup,
+    const void *mod
+    );
+
+void Harvey_CT_NTT_uint64(
+    void *src,
+    const void *_root_table, const void *_root_table_Shoup,
+    struct compress_profile _profile,
+    const void *mod
+    );
+
+void Harvey_GS_iNTT_uint64(
+    void *src,
+    const void *_root_table, const void *_root_table_Shoup,
+    struct compress_profile _profile,
+    const void *mod
+    );
+
+#endif
+
 // ================================
 // Multi-layer butterly.
 
@@ -0,0 +1,609 @@
+#include <stdlib.h>
+#include <memory.h>
+
+#include "tools.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+#include "table_store.h"
+#include "rns.h"
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+// ================================
+// Arithmetic modulo a prime below 2^62.
+
+static
+uint64_t RNS_mulmod(uint64_t a, uint64_t b, uint64_t mod){
+    __extension__ unsigned __int128 t = (unsigned __int128)a * b;
+    return (uint64_t)(t % mod);
+}
+
+static
+uint64_t RNS_expmod(uint64_t a, uint64_t e, uint64_t mod){
+
+    uint64_t t = 1;
+
+    for(; e; e >>= 1){
+        if(e & 1){
+            t = RNS_mulmod(t, a, mod);
+        }
+        a = RNS_mulmod(a, a, mod);
+    }
+
+    return t;
+
+}
+
+// Deterministic Miller-Rabin for 64-bit integers.
+static
+int RNS_isprime(uint64_t n){
+
+    static const uint64_t bases[12] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    uint64_t d, x;
+    size_t s, r;
+
+    if(n < 2){
+        return 0;
+    }
+    for(size_t i = 0; i < 12; i++){
+        if(n % bases[i] == 0){
+            return n == bases[i];
+        }
+    }
+
+    d = n - 1;
+    s = 0;
+    while((d & 1) == 0){
+        d >>= 1;
+        s++;
+    }
+
+    for(size_t i = 0; i < 12; i++){
+        x = RNS_expmod(bases[i], d, n);
+        if((x == 1) || (x == n - 1)){
+            continue;
+        }
+        for(r = 1; r < s; r++){
+            x = RNS_mulmod(x, x, n);
+            if(x == n - 1){
+                break;
+            }
+        }
+        if(r == s){
+            return 0;
+        }
+    }
+
+    return 1;
+
+}
+
+// ================================
+// Multi-precision integers as little-endian 32-bit limbs.
+
+// des[0, limbs) += src[0, limbs) b.
+static
+void RNS_big_muladd(uint32_t *des, const uint32_t *src, uint64_t b, size_t limbs){
+
+    __extension__ unsigned __int128 carry, t;
+
+    carry = 0;
+    for(size_t i = 0; i < limbs; i++){
+        t = __extension__ (unsigned __int128)src[i] * b + des[i] + carry;
+        des[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+
+}
+
+// Returns src[0, limbs) mod mod.
+static
+uint64_t RNS_big_mod(const uint32_t *src, size_t limbs, uint64_t mod){
+
+    __extension__ unsigned __int128 t;
+    uint64_t r;
+
+    r = 0;
+    for(size_t i = limbs; i > 0; i--){
+        t = (__extension__ (unsigned __int128)r << 32) | src[i - 1];
+        r = (uint64_t)(t % mod);
+    }
+
+    return r;
+
+}
+
+// Returns 1 if src1[0, limbs) >= src2[0, limbs).
+static
+int RNS_big_geq(const uint32_t *src1, const uint32_t *src2, size_t limbs){
+
+    for(size_t i = limbs; i > 0; i--){
+        if(src1[i - 1] != src2[i - 1]){
+            return src1[i - 1] > src2[i - 1];
+        }
+    }
+
+    return 1;
+
+}
+
+// des[0, limbs) -= src[0, limbs).
+static
+void RNS_big_sub(uint32_t *des, const uint32_t *src, size_t limbs){
+
+    uint64_t borrow, t;
+
+    borrow = 0;
+    for(size_t i = 0; i < limbs; i++){
+        t = (uint64_t)des[i] - src[i] - borrow;
+        des[i] = (uint32_t)t;
+        borrow = (t >> 32) & 1;
+    }
+
+}
+
+// ================================
+// The ring Z_{RNS_mod} for generating the tables. RNS_mod is thread-local so that
+// the tables of different primes can be generated in parallel, and RNS_bind sets it on the
+// threads generating the levels of one table.
+
+static _Thread_local int64_t RNS_mod;
+
+static
+void RNS_memberZ(void *des, const void *src){
+    cmod_int64(des, src, &RNS_mod);
+}
+
+static
+void RNS_addZ(void *des, const void *src1, const void *src2){
+    addmod_int128(des, src1, src2, &RNS_mod);
+}
+
+static
+void RNS_subZ(void *des, const void *src1, const void *src2){
+    submod_int128(des, src1, src2, &RNS_mod);
+}
+
+static
+void RNS_mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int64(des, src1, src2, &RNS_mod);
+}
+
+static
+void RNS_expZ(void *des, const void *src, size_t e){
+    expmod_int64(des, src, e, &RNS_mod);
+}
+
+// Set RNS_mod to *ctx on a worker thread of gen_streamlined_DWT_table_direct_parallel.
+static
+void RNS_bind(const void *ctx){
+    RNS_mod = *(const int64_t*)ctx;
+}
+
+static
+struct ring RNS_ring = {
+    .sizeZ = sizeof(int64_t),
+    .memberZ = RNS_memberZ,
+    .addZ = RNS_addZ,
+    .subZ = RNS_subZ,
+    .mulZ = RNS_mulZ,
+    .expZ = RNS_expZ
+};
+
+// ================================
+// Plans.
+
+size_t RNS_gen_primes(
+    uint64_t *des,
+    size_t len, size_t bits, size_t order
+    ){
+
+    uint64_t q, lower;
+    size_t count;
+
+    // The largest q < 2^bits with q = 1 mod order.
+    q = (((1ULL << bits) - 2) / order) * order + 1;
+    lower = 1ULL << (bits - 1);
+
+    count = 0;
+    for(; (count < len) && (q > lower); q -= order){
+        if(RNS_isprime(q)){
+            des[count++] = q;
+        }
+    }
+
+    return count;
+
+}
+
+// The tables of a plan are one block of uint64_t: the primes (len), the forward twiddle factors
+// and their Shoup precomputations (2 len (NTT_N - 1)), the inverse ones (2 len (NTT_N - 1)),
+// and NTT_N^(-1) with its Shoup precomputation (2 len).
+static
+void RNS_set_tables(
+    struct RNS_plan *plan,
+    const uint64_t *block
+    ){
+
+    size_t len = plan->len;
+    size_t n = plan->profile.ntt_n;
+
+    plan->mods = block;
+    plan->NTT_tables = block + len;
+    plan->NTT_tables_Shoup = plan->NTT_tables + len * (n - 1);
+    plan->iNTT_tables = plan->NTT_tables_Shoup + len * (n - 1);
+    plan->iNTT_tables_Shoup = plan->iNTT_tables + len * (n - 1);
+    plan->NTT_N_inv = plan->iNTT_tables_Shoup + len * (n - 1);
+    plan->NTT_N_inv_Shoup = plan->NTT_N_inv + len;
+
+}
+
+// Generate the tables in the block.
+static
+void RNS_gen_tables(
+    uint64_t *block,
+    const uint64_t *mods, size_t len,
+    struct compress_profile _profile
+    ){
+
+    size_t n = _profile.ntt_n;
+    uint64_t *NTT_tables = block + len;
+    uint64_t *NTT_tables_Shoup = NTT_tables + len * (n - 1);
+    uint64_t *iNTT_tables = NTT_tables_Shoup + len * (n - 1);
+    uint64_t *iNTT_tables_Shoup = iNTT_tables + len * (n - 1);
+    uint64_t *NTT_N_inv = iNTT_tables_Shoup + len * (n - 1);
+    uint64_t *NTT_N_inv_Shoup = NTT_N_inv + len;
+
+    // The tables are level-ordered as in gen_DWT_table.
+    struct compress_profile level_profile = _profile;
+    level_profile.compressed_layers = _profile.log_ntt_n;
+    for(size_t i = 0; i < _profile.log_ntt_n; i++){
+        level_profile.merged_layers[i] = 1;
+    }
+
+    memcpy(block, mods, len * sizeof(uint64_t));
+
+    // The primes are independent.
+#if defined(_OPENMP)
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for(size_t i = 0; i < len; i++){
+
+        uint64_t q_i = mods[i], w;
+        int64_t zeta, omega, scale, mod_i;
+        int64_t *twiddle_table = malloc((n - 1) * sizeof(int64_t));
+
+        // Search for a principal (2 NTT_N)-th root of unity w with w^NTT_N = -1.
+        w = 1;
+        for(uint64_t g = 2; g < q_i; g++){
+            w = RNS_expmod(g, (q_i - 1) / (2 * n), q_i);
+            if(RNS_expmod(w, n, q_i) == q_i - 1){
+                break;
+            }
+        }
+
+        RNS_mod = (int64_t)q_i;
+        mod_i = (int64_t)q_i;
+        scale = 1;
+
+        zeta = (int64_t)w;
+        RNS_ring.memberZ(&zeta, &zeta);
+        RNS_ring.mulZ(&omega, &zeta, &zeta);
+        gen_streamlined_DWT_table_direct_parallel(twiddle_table, &scale, &omega, &zeta, level_profile, 0, RNS_ring, RNS_bind, &mod_i);
+        gen_Shoup_table_uint64(NTT_tables + i * (n - 1), NTT_tables_Shoup + i * (n - 1),
+            twiddle_table, n - 1, &q_i);
+
+        zeta = (int64_t)RNS_expmod(w, q_i - 2, q_i);
+        RNS_ring.memberZ(&zeta, &zeta);
+        RNS_ring.mulZ(&omega, &zeta, &zeta);
+        gen_streamlined_DWT_table_direct_parallel(twiddle_table, &scale, &omega, &zeta, level_profile, 0, RNS_ring, RNS_bind, &mod_i);
+        gen_Shoup_table_uint64(iNTT_tables + i * (n - 1), iNTT_tables_Shoup + i * (n - 1),
+            twiddle_table, n - 1, &q_i);
+
+        NTT_N_inv[i] = RNS_expmod(n % q_i, q_i - 2, q_i);
+        Shoup_precomp_uint64(NTT_N_inv_Shoup + i, NTT_N_inv + i, &q_i);
+
+        free(twiddle_table);
+
+    }
+
+}
+
+// Compute Q, Q / q_i, and (Q / q_i)^(-1) mod q_i.
+static
+void RNS_init_CRT(
+    struct RNS_plan *plan
+    ){
+
+    size_t len = plan->len;
+    const uint64_t *mods = plan->mods;
+    uint64_t q, t;
+
+    plan->Q = calloc(plan->limbs, sizeof(uint32_t));
+    plan->Q_hat = calloc(len * plan->limbs, sizeof(uint32_t));
+    plan->Q_hat_inv = malloc(len * sizeof(uint64_t));
+    plan->Q_hat_inv_Shoup = malloc(len * sizeof(uint64_t));
+
+    // Q = prod_i q_i and Q / q_i = prod_{k != i} q_k.
+    plan->Q[0] = 1;
+    for(size_t i = 0; i < len; i++){
+        plan->Q_hat[i * plan->limbs] = 1;
+    }
+    for(size_t k = 0; k < len; k++){
+        uint32_t tmp[plan->limbs];
+        memset(tmp, 0, sizeof(tmp));
+        RNS_big_muladd(tmp, plan->Q, mods[k], plan->limbs);
+        memcpy(plan->Q, tmp, sizeof(tmp));
+        for(size_t i = 0; i < len; i++){
+            if(i == k){
+                continue;
+            }
+            memset(tmp, 0, sizeof(tmp));
+            RNS_big_muladd(tmp, plan->Q_hat + i * plan->limbs, mods[k], plan->limbs);
+            memcpy(plan->Q_hat + i * plan->limbs, tmp, sizeof(tmp));
+        }
+    }
+
+    for(size_t i = 0; i < len; i++){
+        q = mods[i];
+        t = RNS_big_mod(plan->Q_hat + i * plan->limbs, plan->limbs, q);
+        plan->Q_hat_inv[i] = RNS_expmod(t, q - 2, q);
+        Shoup_precomp_uint64(plan->Q_hat_inv_Shoup + i, plan->Q_hat_inv + i, &q);
+    }
+
+}
+
+void RNS_init(
+    struct RNS_plan *plan,
+    const uint64_t *mods, size_t len,
+    struct compress_profile _profile
+    ){
+
+    plan->len = len;
+    plan->limbs = 2 * len;
+    plan->profile = _profile;
+
+    plan->table_block = malloc(RNS_tables_size(len, _profile));
+    RNS_gen_tables(plan->table_block, mods, len, _profile);
+    RNS_set_tables(plan, plan->table_block);
+
+    RNS_init_CRT(plan);
+
+}
+
+size_t RNS_tables_size(
+    size_t len,
+    struct compress_profile _profile
+    ){
+    return len * (3 + 4 * (_profile.ntt_n - 1)) * sizeof(uint64_t);
+}
+
+void RNS_table_key(
+    struct table_key *des,
+    const uint64_t *mods, size_t len,
+    struct compress_profile _profile
+    ){
+
+    table_key_init(des, "RNS", _profile);
+    des->params[0] = len;
+    des->params[1] = table_store_checksum(mods, len * sizeof(uint64_t));
+
+}
+
+const void *RNS_tables(
+    const struct RNS_plan *plan
+    ){
+    return plan->mods;
+}
+
+int RNS_init_from_store(
+    struct RNS_plan *plan,
+    const uint64_t *mods, size_t len,
+    struct compress_profile _profile,
+    const struct table_store *store
+    ){
+
+    struct table_key key;
+    const uint64_t *block;
+
+    block = NULL;
+    if(store != NULL){
+        RNS_table_key(&key, mods, len, _profile);
+        block = table_store_lookup(store, &key, RNS_tables_size(len, _profile));
+    }
+
+    // The primes are stored in front of the tables, so a collision of the keys is detected here.
+    if((block == NULL) || (memcmp(block, mods, len * sizeof(uint64_t)) != 0)){
+        RNS_init(plan, mods, len, _profile);
+        return 0;
+    }
+
+    plan->len = len;
+    plan->limbs = 2 * len;
+    plan->profile = _profile;
+
+    plan->table_block = NULL;
+    RNS_set_tables(plan, block);
+
+    RNS_init_CRT(plan);
+
+    return 1;
+
+}
+
+void RNS_free(
+    struct RNS_plan *plan
+    ){
+
+    free(plan->table_block);
+    free(plan->Q);
+    free(plan->Q_hat);
+    free(plan->Q_hat_inv);
+    free(plan->Q_hat_inv_Shoup);
+
+}
+
+// ================================
+// Conversions.
+
+void RNS_decompose(
+    uint64_t *des,
+    const uint32_t *src,
+    const struct RNS_plan *plan
+    ){
+
+    size_t n = plan->profile.array_n;
+
+#if defined(_OPENMP)
+    #pragma omp parallel for
+#endif
+    for(size_t i = 0; i < plan->len; i++){
+        for(size_t j = 0; j < n; j++){
+            des[i * n + j] = RNS_big_mod(src + j * plan->limbs, plan->limbs, plan->mods[i]);
+        }
+    }
+
+}
+
+void RNS_reconstruct(
+    uint32_t *des,
+    const uint64_t *src,
+    const struct RNS_plan *plan
+    ){
+
+    size_t n = plan->profile.array_n;
+    size_t limbs = plan->limbs;
+    uint64_t y;
+
+    // One more limb since the sum is below len Q.
+    uint32_t acc[limbs + 1], Q[limbs + 1], Q_hat[limbs + 1];
+
+    memcpy(Q, plan->Q, limbs * sizeof(uint32_t));
+    Q[limbs] = 0;
+    Q_hat[limbs] = 0;
+
+    for(size_t j = 0; j < n; j++){
+        memset(acc, 0, sizeof(acc));
+        for(size_t i = 0; i < plan->len; i++){
+            lazy_mulmod_Shoup_uint64(&y, src + i * n + j, plan->Q_hat_inv + i, plan->Q_hat_inv_Shoup + i, plan->mods + i);
+            csub_uint64(&y, &y, plan->mods + i);
+            memcpy(Q_hat, plan->Q_hat + i * limbs, limbs * sizeof(uint32_t));
+            RNS_big_muladd(acc, Q_hat, y, limbs + 1);
+        }
+        while(RNS_big_geq(acc, Q, limbs + 1)){
+            RNS_big_sub(acc, Q, limbs + 1);
+        }
+        memcpy(des + j * limbs, acc, limbs * sizeof(uint32_t));
+    }
+
+}
+
+void RNS_base_convert(
+    uint64_t *des,
+    const uint64_t *src,
+    const uint64_t *mods_to, size_t len_to,
+    const struct RNS_plan *plan
+    ){
+
+    size_t n = plan->profile.array_n;
+    uint64_t y[plan->len];
+    uint64_t Q_hat_mod[plan->len], Q_mod, p, acc;
+    double frac;
+    uint64_t v;
+
+    for(size_t k = 0; k < len_to; k++){
+
+        p = mods_to[k];
+        for(size_t i = 0; i < plan->len; i++){
+            Q_hat_mod[i] = RNS_big_mod(plan->Q_hat + i * plan->limbs, plan->limbs, p);
+        }
+        Q_mod = RNS_big_mod(plan->Q, plan->limbs, p);
+
+        for(size_t j = 0; j < n; j++){
+            frac = 0;
+            for(size_t i = 0; i < plan->len; i++){
+                lazy_mulmod_Shoup_uint64(y + i, src + i * n + j, plan->Q_hat_inv + i, plan->Q_hat_inv_Shoup + i, plan->mods + i);
+                csub_uint64(y + i, y + i, plan->mods + i);
+                frac += (double)y[i] / (double)plan->mods[i];
+            }
+            v = (uint64_t)(frac + 0.5);
+            acc = 0;
+            for(size_t i = 0; i < plan->len; i++){
+                acc += RNS_mulmod(y[i], Q_hat_mod[i], p);
+                acc -= (acc >= p) ? p : 0;
+            }
+            // acc - v Q mod p.
+            v = RNS_mulmod(v % p, Q_mod, p);
+            des[k * n + j] = (acc >= v) ? acc - v : acc + p - v;
+        }
+
+    }
+
+}
+
+// ================================
+// Transformations.
+
+void RNS_NTT(
+    uint64_t *src,
+    const struct RNS_plan *plan
+    ){
+
+    size_t n = plan->profile.ntt_n;
+
+#if defined(_OPENMP)
+    #pragma omp parallel for
+#endif
+    for(size_t i = 0; i < plan->len; i++){
+        Harvey_CT_NTT_uint64(src + i * plan->profile.array_n,
+            plan->NTT_tables + i * (n - 1), plan->NTT_tables_Shoup + i * (n - 1),
+            plan->profile, plan->mods + i);
+    }
+
+}
+
+void RNS_iNTT(
+    uint64_t *src,
+    const struct RNS_plan *plan
+    ){
+
+    size_t n = plan->profile.ntt_n;
+    uint64_t *poly;
+
+#if defined(_OPENMP)
+    #pragma omp parallel for private(poly)
+#endif
+    for(size_t i = 0; i < plan->len; i++){
+        poly = src + i * plan->profile.array_n;
+        Harvey_GS_iNTT_uint64(poly,
+            plan->iNTT_tables + i * (n - 1), plan->iNTT_tables_Shoup + i * (n - 1),
+            plan->profile, plan->mods + i);
+        for(size_t j = 0; j < plan->profile.array_n; j++){
+            lazy_mulmod_Shoup_uint64(poly + j, poly + j, plan->NTT_N_inv + i, plan->NTT_N_inv_Shoup + i, plan->mods + i);
+            csub_uint64(poly + j, poly + j, plan->mods + i);
+        }
+    }
+
+}
+
+void RNS_point_mul(
+    uint64_t *des,
+    const uint64_t *src1, const uint64_t *src2,
+    const struct RNS_plan *plan
+    ){
+
+    size_t n = plan->profile.array_n;
+
+#if defined(_OPENMP)
+    #pragma omp parallel for
+#endif
+    for(size_t i = 0; i < plan->len; i++){
+        for(size_t j = 0; j < n; j++){
+            des[i * n + j] = RNS_mulmod(src1[i * n + j], src2[i * n + j], plan->mods[i]);
+        }
+    }
+
+}
+
+#endif
+
@@ -0,0 +1,159 @@
+#ifndef RNS_H
+#define RNS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "tools.h"
+#include "table_store.h"
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+// ================================
+// Residue number system (RNS) over NTT-friendly primes.
+// Let Q = q_0 q_1 ... q_{len - 1} be a product of distinct primes with q_i = 1 mod 2 NTT_N and
+// q_i < 2^62. By the Chinese remainder theorem,
+// Z_Q[x] / (x^ARRAY_N + 1) \cong prod_i Z_{q_i}[x] / (x^ARRAY_N + 1),
+// and each component is transformed with Harvey_CT_NTT_uint64 and Harvey_GS_iNTT_uint64.
+// We require ARRAY_N = NTT_N.
+// - Elements of Z_Q are multi-precision integers in [0, Q) stored as plan->limbs
+//   little-endian 32-bit limbs.
+// - Residues are stored prime-major in [0, q_i): the j-th coefficient modulo q_i is at
+//   src[i * ARRAY_N + j]. All the primes share the layout of the tables from gen_DWT_table.
+
+struct RNS_plan {
+    // The number of primes.
+    size_t len;
+    // The number of 32-bit limbs of an element of Z_Q.
+    size_t limbs;
+    struct compress_profile profile;
+    // The block holding the following tables if it is owned by the plan, or NULL if the tables
+    // are mapped from a table store.
+    uint64_t *table_block;
+    // The primes q_i.
+    const uint64_t *mods;
+    // len x (NTT_N - 1) twiddle factors and their Shoup precomputations.
+    const uint64_t *NTT_tables, *NTT_tables_Shoup;
+    const uint64_t *iNTT_tables, *iNTT_tables_Shoup;
+    // NTT_N^(-1) mod q_i.
+    const uint64_t *NTT_N_inv, *NTT_N_inv_Shoup;
+    // Q, Q / q_i, and (Q / q_i)^(-1) mod q_i.
+    uint32_t *Q;
+    uint32_t *Q_hat;
+    uint64_t *Q_hat_inv, *Q_hat_inv_Shoup;
+};
+
+// ================================
+// Plans.
+
+// Generate len primes q with 2^(bits - 1) < q < 2^bits and q = 1 mod order in descending order.
+// We require bits <= 62. Returns the number of primes found.
+size_t RNS_gen_primes(
+    uint64_t *des,
+    size_t len, size_t bits, size_t order
+    );
+
+// Initialize the plan for the primes mods[0], ..., mods[len - 1] and the profile.
+// For each prime, the principal (2 NTT_N)-th root of unity is found by search, and the tables
+// are generated with gen_streamlined_DWT_table_direct in the layout of gen_DWT_table and
+// gen_Shoup_table_uint64. If OpenMP is enabled, the primes are processed in parallel.
+void RNS_init(
+    struct RNS_plan *plan,
+    const uint64_t *mods, size_t len,
+    struct compress_profile _profile
+    );
+
+void RNS_free(
+    struct RNS_plan *plan
+    );
+
+// ================================
+// Precomputed tables in a table store (see table_store.h).
+// The primes, the twiddle factors, and NTT_N^(-1) of a plan form one block of
+// RNS_tables_size bytes starting at RNS_tables(plan). The block is stored under the key from
+// RNS_table_key, which depends on the primes and the profile.
+
+size_t RNS_tables_size(
+    size_t len,
+    struct compress_profile _profile
+    );
+
+void RNS_table_key(
+    struct table_key *des,
+    const uint64_t *mods, size_t len,
+    struct compress_profile _profile
+    );
+
+const void *RNS_tables(
+    const struct RNS_plan *plan
+    );
+
+// Initialize the plan with the tables mapped from store without copying them.
+// If store is NULL or the tables are missing, the plan is initialized with RNS_init.
+// Returns 1 if the tables are mapped and 0 if they are generated. The checksum of the tables
+// is validated by the lookup, so a corrupted entry is generated instead. The store must stay
+// open until RNS_free.
+int RNS_init_from_store(
+    struct RNS_plan *plan,
+    const uint64_t *mods, size_t len,
+    struct compress_profile _profile,
+    const struct table_store *store
+    );
+
+// ================================
+// Conversions.
+
+// Decompose the ARRAY_N elements of Z_Q at src into their residues.
+void RNS_decompose(
+    uint64_t *des,
+    const uint32_t *src,
+    const struct RNS_plan *plan
+    );
+
+// Reconstruct the ARRAY_N elements of Z_Q in [0, Q) from their residues with
+// x = sum_i ((src_i (Q / q_i)^(-1)) mod q_i) (Q / q_i) mod Q.
+void RNS_reconstruct(
+    uint32_t *des,
+    const uint64_t *src,
+    const struct RNS_plan *plan
+    );
+
+// Convert the residues of the ARRAY_N elements at src to the primes mods_to[0], ..., mods_to[len_to - 1].
+// Let y_i = (src_i (Q / q_i)^(-1)) mod q_i. We have x = sum_i y_i (Q / q_i) - v Q with
+// v = round(sum_i y_i / q_i) for the signed representative x in [-Q / 2, Q / 2), and v is
+// computed in double precision. The result is exact unless |x| is within len 2^(-52) Q of Q / 2.
+// des is stored prime-major as the residues in the plan.
+void RNS_base_convert(
+    uint64_t *des,
+    const uint64_t *src,
+    const uint64_t *mods_to, size_t len_to,
+    const struct RNS_plan *plan
+    );
+
+// ================================
+// Transformations.
+// The primes are processed in a batch, and in parallel if OpenMP is enabled.
+
+// Apply Harvey_CT_NTT_uint64 to all the primes. The inputs must be in [0, q_i).
+void RNS_NTT(
+    uint64_t *src,
+    const struct RNS_plan *plan
+    );
+
+// Apply Harvey_GS_iNTT_uint64 to all the primes and multiply by NTT_N^(-1).
+void RNS_iNTT(
+    uint64_t *src,
+    const struct RNS_plan *plan
+    );
+
+// Point-wise multiplication for all the primes.
+void RNS_point_mul(
+    uint64_t *des,
+    const uint64_t *src1, const uint64_t *src2,
+    const struct RNS_plan *plan
+    );
+
+#endif
+
+#endif
+
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tools.h"
+#include "table_store.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define TABLE_STORE_MMAP
+#endif
+
+static const char table_store_magic[8] = {'P', 'M', 'L', 'T', 'A', 'B', 'L', 'E'};
+
+#define TABLE_STORE_BYTE_ORDER 0x01020304u
+
+// ================================
+
+void table_key_init(
+    struct table_key *des,
+    const char *name,
+    struct compress_profile _profile
+    ){
+
+    memset(des, 0, sizeof(struct table_key));
+    strncpy(des->name, name, sizeof(des->name) - 1);
+
+    des->profile[0] = _profile.array_n;
+    des->profile[1] = _profile.ntt_n;
+    des->profile[2] = _profile.log_ntt_n;
+    des->profile[3] = _profile.compressed_layers;
+    for(size_t i = 0; i < _profile.compressed_layers && i < 16; i++){
+        des->profile[4 + i] = _profile.merged_layers[i];
+    }
+
+}
+
+uint64_t table_store_checksum(
+    const void *src, size_t size
+    ){
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    for(size_t i = 0; i < size; i++){
+        h ^= ((const uint8_t*)src)[i];
+        h *= 0x100000001b3ULL;
+    }
+
+    return h;
+
+}
+
+// ================================
+
+int table_store_write(
+    const char *path,
+    const struct table_store_item *items, size_t count
+    ){
+
+    struct table_store_header header;
+    struct table_store_entry *entries;
+    static const char zeros[TABLE_STORE_ALIGN] = {0};
+    char *tmp_path;
+    size_t offset, pad;
+    FILE *fp;
+    int ret = -1;
+
+    entries = calloc(count ? count : 1, sizeof(struct table_store_entry));
+    tmp_path = malloc(strlen(path) + 8);
+    sprintf(tmp_path, "%s.XXXXXX", path);
+
+    offset = sizeof(header) + count * sizeof(struct table_store_entry);
+    for(size_t i = 0; i < count; i++){
+        offset = (offset + TABLE_STORE_ALIGN - 1) / TABLE_STORE_ALIGN * TABLE_STORE_ALIGN;
+        entries[i].key = items[i].key;
+        entries[i].offset = offset;
+        entries[i].size = items[i].size;
+        entries[i].checksum = table_store_checksum(items[i].data, items[i].size);
+        offset += items[i].size;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, table_store_magic, sizeof(header.magic));
+    header.version = TABLE_STORE_VERSION;
+    header.byte_order = TABLE_STORE_BYTE_ORDER;
+    header.count = count;
+    header.checksum = table_store_checksum(entries, count * sizeof(struct table_store_entry));
+
+    // Each writer gets its own temporary file in the directory of path, so concurrent writers
+    // do not interleave and the rename stays within one file system.
+#if defined(TABLE_STORE_MMAP)
+    int fd = mkstemp(tmp_path);
+    if(fd < 0){
+        goto end;
+    }
+    // mkstemp creates the file with mode 0600, but the store is shared by all the processes.
+    if((fchmod(fd, 0644) != 0) || ((fp = fdopen(fd, "wb")) == NULL)){
+        close(fd);
+        remove(tmp_path);
+        goto end;
+    }
+#else
+    fp = fopen(tmp_path, "wb");
+    if(fp == NULL){
+        goto end;
+    }
+#endif
+
+    if(fwrite(&header, sizeof(header), 1, fp) != 1){
+        goto fail;
+    }
+    if(count && (fwrite(entries, sizeof(struct table_store_entry), count, fp) != count)){
+        goto fail;
+    }
+    offset = sizeof(header) + count * sizeof(struct table_store_entry);
+    for(size_t i = 0; i < count; i++){
+        pad = entries[i].offset - offset;
+        if(pad && (fwrite(zeros, 1, pad, fp) != pad)){
+            goto fail;
+        }
+        if(items[i].size && (fwrite(items[i].data, 1, items[i].size, fp) != items[i].size)){
+            goto fail;
+        }
+        offset = entries[i].offset + entries[i].size;
+    }
+
+    if(fclose(fp) != 0){
+        remove(tmp_path);
+        goto end;
+    }
+    if(rename(tmp_path, path) != 0){
+        remove(tmp_path);
+        goto end;
+    }
+
+    ret = 0;
+    goto end;
+
+fail:
+    fclose(fp);
+    remove(tmp_path);
+
+end:
+    free(tmp_path);
+    free(entries);
+    return ret;
+
+}
+
+// ================================
+
+int table_store_open(
+    struct table_store *store,
+    const char *path
+    ){
+
+    memset(store, 0, sizeof(struct table_store));
+
+#if defined(TABLE_STORE_MMAP)
+
+    const struct table_store_header *header;
+    const struct table_store_entry *entries;
+    struct stat st;
+    void *map;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if(fd < 0){
+        return -1;
+    }
+    if((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(struct table_store_header))){
+        close(fd);
+        return -1;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED){
+        return -1;
+    }
+
+    header = map;
+    entries = (const struct table_store_entry*)(header + 1);
+
+    if((memcmp(header->magic, table_store_magic, sizeof(header->magic)) != 0) ||
+       (header->version != TABLE_STORE_VERSION) ||
+       (header->byte_order != TABLE_STORE_BYTE_ORDER) ||
+       (header->count > ((size_t)st.st_size - sizeof(struct table_store_header)) / sizeof(struct table_store_entry)) ||
+       (header->checksum != table_store_checksum(entries, header->count * sizeof(struct table_store_entry)))){
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    for(size_t i = 0; i < header->count; i++){
+        if((entries[i].offset > (uint64_t)st.st_size) || (entries[i].size > (uint64_t)st.st_size - entries[i].offset)){
+            munmap(map, st.st_size);
+            return -1;
+        }
+    }
+
+    store->map = map;
+    store->map_size = st.st_size;
+    store->entries = entries;
+    store->count = header->count;
+
+    return 0;
+
+#else
+
+    (void)path;
+    return -1;
+
+#endif
+
+}
+
+void table_store_close(
+    struct table_store *store
+    ){
+
+#if defined(TABLE_STORE_MMAP)
+    if(store->map != NULL){
+        munmap((void*)store->map, store->map_size);
+    }
+#endif
+
+    memset(store, 0, sizeof(struct table_store));
+
+}
+
+const void *table_store_lookup(
+    const struct table_store *store,
+    const struct table_key *key, size_t size
+    ){
+
+    const void *data;
+
+    for(size_t i = 0; i < store->count; i++){
+        if(memcmp(&store->entries[i].key, key, sizeof(struct table_key)) != 0){
+            continue;
+        }
+        if(store->entries[i].size != size){
+            return NULL;
+        }
+        data = (const char*)store->map + store->entries[i].offset;
+        if(table_store_checksum(data, size) != store->entries[i].checksum){
+            return NULL;
+        }
+        return data;
+    }
+
+    return NULL;
+
+}
+
+int table_store_verify(
+    const struct table_store *store
+    ){
+
+    const void *data;
+
+    for(size_t i = 0; i < store->count; i++){
+        data = (const char*)store->map + store->entries[i].offset;
+        if(table_store_checksum(data, store->entries[i].size) != store->entries[i].checksum){
+            return -1;
+        }
+    }
+
+    return 0;
+
+}
+
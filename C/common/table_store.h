@@ -0,0 +1,117 @@
+#ifndef TABLE_STORE_H
+#define TABLE_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "tools.h"
+
+// ================================
+// Memory-mapped store of precomputed tables.
+// A store is a single file holding tables keyed by struct table_key. The file is mapped
+// read-only and shared, so all the processes opening the same store share one physical copy
+// of the tables, and opening costs no generation.
+// File format (version TABLE_STORE_VERSION, native byte order):
+// - struct table_store_header: magic, version, byte-order mark, the number of entries, and
+//   the checksum of the directory.
+// - count x struct table_store_entry: the key, the offset and size (in bytes) of the table,
+//   and the checksum of the table.
+// - the tables, each starting at a multiple of TABLE_STORE_ALIGN bytes.
+// Checksums are 64-bit FNV-1a. The header and the directory are validated when opening, and
+// the checksum of a table when it is looked up, so opening a store with many tables only hashes
+// the tables in use. Callers fall back to generation if the store cannot be opened or a lookup
+// fails.
+
+#define TABLE_STORE_VERSION 1
+#define TABLE_STORE_ALIGN 64
+
+// The key of a table. Keys are compared byte by byte, so they must be initialized with
+// table_key_init before the fields are assigned.
+// - name: the kind of the table, for example "RNS".
+// - params: the parameters of the ring, for example the modulus and the roots of unity.
+// - profile: array_n, ntt_n, log_ntt_n, compressed_layers, and merged_layers.
+// - layout: the layout of the table, for example pad or the fields of struct twiddle_layout.
+struct table_key {
+    char name[16];
+    uint64_t params[4];
+    uint64_t profile[20];
+    uint64_t layout[4];
+};
+
+struct table_store_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t count;
+    uint64_t checksum;
+};
+
+struct table_store_entry {
+    struct table_key key;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+// An opened store.
+struct table_store {
+    const void *map;
+    size_t map_size;
+    const struct table_store_entry *entries;
+    size_t count;
+};
+
+// A table to be written.
+struct table_store_item {
+    struct table_key key;
+    const void *data;
+    size_t size;
+};
+
+// Zero the key and fill name and profile.
+void table_key_init(
+    struct table_key *des,
+    const char *name,
+    struct compress_profile _profile
+    );
+
+// 64-bit FNV-1a.
+uint64_t table_store_checksum(
+    const void *src, size_t size
+    );
+
+// Write the tables to path. The file is written to a temporary file created with mkstemp in the
+// same directory and renamed so that readers never see a partial store and concurrent writers
+// never share a temporary file. Returns 0 on success and -1 on failure.
+int table_store_write(
+    const char *path,
+    const struct table_store_item *items, size_t count
+    );
+
+// Map the store at path read-only. Returns 0 on success and -1 if the file cannot be mapped or
+// its header or directory is invalid. On failure, store is left empty and lookups fail.
+int table_store_open(
+    struct table_store *store,
+    const char *path
+    );
+
+void table_store_close(
+    struct table_store *store
+    );
+
+// Return the table with the key and the size in bytes, or NULL if there is no such table or
+// its checksum does not match.
+const void *table_store_lookup(
+    const struct table_store *store,
+    const struct table_key *key, size_t size
+    );
+
+// Validate the checksums of all the tables. Returns 0 if they match and -1 otherwise.
+// Lookups validate only their table; call it to check a whole store, for example when it is
+// installed.
+int table_store_verify(
+    const struct table_store *store
+    );
+
+#endif
+
@@ -166,6 +166,104 @@ void expmod_int32(void *des, const void *src, size_t e, const void *mod){
 
 }
 
+// ================================
+// Explicit Chinese remainder theorem for a pair of moduli with at most 16 bits.
+
+void explicit_CRT_int16(void *des, const void *src1, const void *src2, const void *mod1, const void *mod2,
+                        const void *mod1_inv, const void *mod1_inv_hi){
+
+    int32_t src1_v = *(int16_t*)src1;
+    int32_t mod1_v = *(int16_t*)mod1;
+    int32_t mod2_v = *(int16_t*)mod2;
+    int32_t mod_v = mod1_v * mod2_v;
+    int16_t d, lo, hi;
+    int32_t t;
+
+    // |src2 - src1| < 2^15.
+    d = (int16_t)(*(int16_t*)src2 - src1_v);
+
+    // Barrett multiplication: hi = round(d mod1_inv / mod2) and
+    // lo = d mod1_inv - hi mod2 with |lo| < 3/4 mod2, computed with 16-bit products.
+    hi = (int16_t)(((int32_t)d * *(int16_t*)mod1_inv_hi + (1 << 15)) >> 16);
+    lo = (int16_t)((uint16_t)d * (uint16_t)*(int16_t*)mod1_inv - (uint16_t)hi * (uint16_t)mod2_v);
+
+    // The only 32-bit multiply-accumulate.
+    t = src1_v + mod1_v * (int32_t)lo;
+
+    if(t < -(mod_v >> 1)){
+        t += mod_v;
+    }
+    if(t > (mod_v >> 1)){
+        t -= mod_v;
+    }
+
+    *(int32_t*)des = t;
+
+}
+
+// ================================
+// Unsigned lazy arithmetic with Shoup's precomputation.
+
+void Shoup_precomp_uint32(void *des, const void *src, const void *mod){
+    *(uint32_t*)des = (uint32_t)(((uint64_t)(*(uint32_t*)src) << 32) / (*(uint32_t*)mod));
+}
+
+void lazy_mulmod_Shoup_uint32(void *des, const void *src, const void *twiddle, const void *twiddle_Shoup, const void *mod){
+
+    uint32_t src_v = *(uint32_t*)src;
+    uint32_t hi;
+
+    // hi = floor(src twiddle' / 2^32)
+    hi = (uint32_t)(((uint64_t)src_v * (*(uint32_t*)twiddle_Shoup)) >> 32);
+    // (src twiddle - hi Q) mod 2^32 = src twiddle - hi Q since the latter is in [0, 2 Q)
+    *(uint32_t*)des = src_v * (*(uint32_t*)twiddle) - hi * (*(uint32_t*)mod);
+
+}
+
+void csub_uint32(void *des, const void *src, const void *bound){
+    uint32_t t = *(uint32_t*)src;
+    if(t >= *(uint32_t*)bound){
+        t -= *(uint32_t*)bound;
+    }
+    *(uint32_t*)des = t;
+}
+
+// ================================
+// Complex floating-point arithmetic.
+
+void member_complex(void *des, const void *src){
+    *(double _Complex*)des = *(double _Complex*)src;
+}
+
+void add_complex(void *des, const void *src1, const void *src2){
+    *(double _Complex*)des = *(double _Complex*)src1 + *(double _Complex*)src2;
+}
+
+void sub_complex(void *des, const void *src1, const void *src2){
+    *(double _Complex*)des = *(double _Complex*)src1 - *(double _Complex*)src2;
+}
+
+void mul_complex(void *des, const void *src1, const void *src2){
+    *(double _Complex*)des = *(double _Complex*)src1 * *(double _Complex*)src2;
+}
+
+void exp_complex(void *des, const void *src, size_t e){
+
+    double _Complex src_v = *(double _Complex*)src;
+    double _Complex tmp_v;
+
+    tmp_v = 1;
+    for(; e; e >>= 1){
+        if(e & 1){
+            tmp_v *= src_v;
+        }
+        src_v *= src_v;
+    }
+
+    *(double _Complex*)des = tmp_v;
+
+}
+
 // ================================
 // In-place bit-reversal.
 
@@ -229,7 +327,7 @@ void submod_int128(void *des, const void *src1, const void *src2, const void *mo
 
 void mulmod_int64(void *des, const void *src1, const void *src2, const void *mod){
 
-    int64_t tmp_v, mod_v, des_v;
+    __extension__ __int128 tmp_v, mod_v, des_v;
 
     tmp_v = (__int128)(*(int64_t*)src1) * (__int128)(*(int64_t*)src2);
     mod_v = (__int128)(*(int64_t*)mod);
@@ -257,6 +355,28 @@ void expmod_int64(void *des, const void *src, size_t e, const void *mod){
 
 }
 
+void Shoup_precomp_uint64(void *des, const void *src, const void *mod){
+    *(uint64_t*)des = (uint64_t)(((unsigned __int128)(*(uint64_t*)src) << 64) / (*(uint64_t*)mod));
+}
+
+void lazy_mulmod_Shoup_uint64(void *des, const void *src, const void *twiddle, const void *twiddle_Shoup, const void *mod){
+
+    uint64_t src_v = *(uint64_t*)src;
+    uint64_t hi;
+
+    hi = (uint64_t)(((unsigned __int128)src_v * (*(uint64_t*)twiddle_Shoup)) >> 64);
+    *(uint64_t*)des = src_v * (*(uint64_t*)twiddle) - hi * (*(uint64_t*)mod);
+
+}
+
+void csub_uint64(void *des, const void *src, const void *bound){
+    uint64_t t = *(uint64_t*)src;
+    if(t >= *(uint64_t*)bound){
+        t -= *(uint64_t*)bound;
+    }
+    *(uint64_t*)des = t;
+}
+
 #pragma GCC diagnostic pop
 
 #endif
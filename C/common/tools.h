@@ -29,6 +29,37 @@ struct compress_profile {
     size_t merged_layers[16];
 };
 
+// ================================
+// Structure twiddle_layout
+
+// This structure describes how the twiddle factors of each level are laid out in memory for
+// a vectorized NTT over ARRAY_N coefficients with vec_n lanes per vector. Let
+// step = ARRAY_N / 2^(level + 1) be the number of butterflies of a block in the level.
+// See gen_vec_DWT_table and check_twiddle_layout.
+// - vec_n
+//      - The number of lanes of a vector. vec_n must be a power of two.
+// - align
+//      - The table of each level starts at a multiple of align elements. The gaps are zeros.
+// - mode[16]
+//      - TWIDDLE_SCALAR: one twiddle factor per block (2^level elements). A vector is filled
+//        with a broadcast load. Requires step >= vec_n.
+//      - TWIDDLE_REPLICATE: each twiddle factor is replicated vec_n times (2^level vec_n elements).
+//        A vector is filled with a plain load. Requires step >= vec_n.
+//      - TWIDDLE_INTERLEAVE: one twiddle factor per butterfly (ARRAY_N / 2 elements) where the
+//        t-th lane of the v-th vector holds the twiddle factor of the (v vec_n + t)-th butterfly.
+//        For step < vec_n, a vector feeds vec_n butterflies across vec_n / step blocks.
+enum twiddle_mode {
+    TWIDDLE_SCALAR,
+    TWIDDLE_REPLICATE,
+    TWIDDLE_INTERLEAVE
+};
+
+struct twiddle_layout {
+    size_t vec_n;
+    size_t align;
+    enum twiddle_mode mode[16];
+};
+
 // ================================
 // Structure ring
 
@@ -132,6 +163,45 @@ void expmod_int16(void *des, const void *src, size_t e, const void *mod);
 // representative in the ring Z_{*mod} with signed representation.
 void expmod_int32(void *des, const void *src, size_t e, const void *mod);
 
+// ================================
+// Explicit Chinese remainder theorem for a pair of moduli with at most 16 bits.
+
+// This function assumes *src1 in Z_{*mod1} and *src2 in Z_{*mod2} with signed representation
+// in 16-bit, *mod1_inv = (*mod1)^(-1) mod *mod2, *mod1_inv_hi = round(*mod1_inv 2^16 / *mod2),
+// and *mod1 *mod2 < 2^30. It computes *src1 + *mod1 t where t = (*src2 - *src1) *mod1_inv
+// modulo *mod2 is reduced with Barrett multiplication, and maps the result to the representative
+// in the ring Z_{*mod1 *mod2} with signed representation in 32-bit.
+void explicit_CRT_int16(void *des, const void *src1, const void *src2, const void *mod1, const void *mod2,
+                        const void *mod1_inv, const void *mod1_inv_hi);
+
+// ================================
+// Unsigned lazy arithmetic with Shoup's precomputation.
+// In contrast to the functions above, the values are represented by unsigned integers that are
+// only reduced into [0, *mod) on demand. Let w be the size of the arithmetic (32 or 64).
+// Given a known operand b in [0, *mod), we precompute b' = floor(b 2^w / *mod). Then
+// a b - floor(a b' / 2^w) *mod lies in [0, 2 *mod) for all a in [0, 2^w),
+// and can be computed with the low and high halves of two long products.
+
+// This function assumes sizeZ = 4 and *src in [0, *mod). It computes floor(*src 2^32 / *mod).
+void Shoup_precomp_uint32(void *des, const void *src, const void *mod);
+// This function assumes sizeZ = 4. Given *twiddle in [0, *mod) and *twiddle_Shoup computed by
+// Shoup_precomp_uint32, it computes a value in [0, 2 *mod) equivalent to *src * (*twiddle) modulo *mod.
+void lazy_mulmod_Shoup_uint32(void *des, const void *src, const void *twiddle, const void *twiddle_Shoup, const void *mod);
+// This function assumes sizeZ = 4. It subtracts *bound from *src if *src >= *bound.
+void csub_uint32(void *des, const void *src, const void *bound);
+
+// ================================
+// Complex floating-point arithmetic.
+// These functions assume sizeZ = sizeof(double _Complex) and can be used directly as
+// memberZ, addZ, subZ, mulZ, and expZ for the field of complex numbers. There is no reduction
+// and the results are subject to rounding. See fft_c.h.
+
+void member_complex(void *des, const void *src);
+void add_complex(void *des, const void *src1, const void *src2);
+void sub_complex(void *des, const void *src1, const void *src2);
+void mul_complex(void *des, const void *src1, const void *src2);
+void exp_complex(void *des, const void *src, size_t e);
+
 // ================================
 // In-place bit-reversal.
 
@@ -147,6 +217,12 @@ void submod_int128(void *des, const void *src1, const void *src2, const void *mo
 void mulmod_int64(void *des, const void *src1, const void *src2, const void *mod);
 void expmod_int64(void *des, const void *src, size_t e, const void *mod);
 
+// The 64-bit counterparts of the unsigned lazy arithmetic.
+// Shoup_precomp_uint64 computes floor(*src 2^64 / *mod).
+void Shoup_precomp_uint64(void *des, const void *src, const void *mod);
+void lazy_mulmod_Shoup_uint64(void *des, const void *src, const void *twiddle, const void *twiddle_Shoup, const void *mod);
+void csub_uint64(void *des, const void *src, const void *bound);
+
 #endif
 
 
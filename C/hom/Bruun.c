@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// ================
+// This file demonstrates Bruun's FFT for Z_Q[x] / (x^256 + 1) with Q = 3583.
+// Since Q = 3 mod 4, there is no principal 4-th root of unity in Z_Q, and
+// x^256 + 1 does not split into linear factors over Z_Q.
+
+// ================
+// Theory.
+// Let psi be a principal 512-th root of unity in Z_Q[i] / (i^2 + 1). Since 512 | Q + 1,
+// we can choose psi with psi^(Q + 1) = 1, so psi^Q = psi^(-1) and
+// C_e = psi^e + psi^(-e) is fixed by the Frobenius map, i.e., C_e is in Z_Q.
+// For a modulus x^(4 m) - (c^2 - 2) x^(2 m) + 1, we have
+// x^(4 m) - (c^2 - 2) x^(2 m) + 1 = (x^(2 m) - c x^m + 1) (x^(2 m) + c x^m + 1).
+// Starting from x^256 + 1 with c = C_64 (c^2 = 2), each child is again of the same shape,
+// and after log_2(NTT_N) layers we have NTT_N trinomials x^(2 m) -+ c x^m + 1 with
+// 2 m = 256 / NTT_N [Bru78]. This is the "real" counterpart of the complex FFT; see [BGM93]
+// for the explicit factorization of x^(2^k) + 1 over Z_p with p = 3 mod 4.
+// Each layer costs three multiplications per four coefficients. The inverse requires
+// c^(-1) and is scaled by 2 per layer.
+
+// ================
+// A small example.
+// Over Z_7 (7 + 1 = 8), we have C_1 = psi + psi^(-1) with psi^8 = 1, and
+// C_1^2 = C_2 + 2 = 2, so C_1 = 3 and
+// x^4 + 1 = (x^2 - 3 x + 1) (x^2 + 3 x + 1).
+
+// ================
+// Optimization guide.
+/*
+
+1. Bruun's FFT only requires arithmetic in Z_Q. The trinomials in the base multiplications
+   are handled with Karatsuba or schoolbook.
+
+2. The product (c^2 - 1) f3 can be skipped at the first layer since c^2 - 1 = 1.
+
+3. As for Cooley--Tukey FFT, we can merge layers or stop early (incomplete Bruun's FFT).
+   Bruun_NTT applies each group of merged_layers block by block, so a group of 3 layers
+   loads each block once instead of three times.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// See [HLY24] and [Hwa24] for Bruun's FFT in lattice-based cryptosystems.
+
+#define ARRAY_N 256
+#define NTT_N 128
+#define LOGNTT_N 7
+#define INCOMPLETE_NTT_N 32
+#define INCOMPLETE_LOGNTT_N 5
+
+#define Q (3583)
+
+// psi + psi^(-1) for a principal (4 NTT_N)-th root of unity psi in Z_Q[i] / (i^2 + 1).
+#define COS (-673)
+// psi^4 + psi^(-4).
+#define INCOMPLETE_COS (993)
+
+// ================
+// Z_Q
+
+int16_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int16(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int16(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int16(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int16(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int16(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+
+int16_t root_table[2 * (NTT_N - 1)], iroot_table[2 * (NTT_N - 1)];
+int16_t mul_table[NTT_N];
+
+// Multiply poly1 and poly2 in Z_Q[x] / (x^ARRAY_N + 1) with Bruun's FFT and compare with ref.
+static
+void test_Bruun(const int16_t *poly1, const int16_t *poly2, const int16_t *ref,
+    int16_t cos, struct compress_profile profile){
+
+    int16_t poly1_NTT[ARRAY_N], poly2_NTT[ARRAY_N], res[ARRAY_N];
+    int16_t scale, t;
+    size_t len;
+
+    gen_Bruun_table(root_table, &cos, 1, profile, coeff_ring);
+    gen_Bruun_table(iroot_table, &cos, Q - 2, profile, coeff_ring);
+    gen_Bruun_mul_table(mul_table, &cos, profile, coeff_ring);
+
+    memcpy(poly1_NTT, poly1, ARRAY_N * sizeof(int16_t));
+    memcpy(poly2_NTT, poly2, ARRAY_N * sizeof(int16_t));
+
+    Bruun_NTT(poly1_NTT, root_table, profile, coeff_ring);
+    Bruun_NTT(poly2_NTT, root_table, profile, coeff_ring);
+
+    len = profile.array_n / profile.ntt_n;
+    for(size_t i = 0; i < profile.ntt_n; i++){
+        naive_mul_trinomial(res + i * len, poly1_NTT + i * len, poly2_NTT + i * len,
+            len, mul_table + i, coeff_ring);
+    }
+
+    Bruun_iNTT(res, iroot_table, profile, coeff_ring);
+
+// ================
+// Multiply the scale to reference.
+
+    scale = profile.ntt_n;
+    for(size_t i = 0; i < ARRAY_N; i++){
+        coeff_ring.mulZ(&t, ref + i, &scale);
+        assert(t == res[i]);
+    }
+
+}
+
+int main(void){
+
+    int16_t poly1[ARRAY_N], poly2[ARRAY_N];
+    int16_t ref[ARRAY_N];
+    int16_t twiddle, t;
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N, {1, 1, 1, 1, 1, 1, 1}
+    };
+
+    struct compress_profile merged_profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, 3, {3, 2, 2}
+    };
+
+    struct compress_profile incomplete_profile = {
+        ARRAY_N, INCOMPLETE_NTT_N, INCOMPLETE_LOGNTT_N, INCOMPLETE_LOGNTT_N, {1, 1, 1, 1, 1}
+    };
+
+    struct compress_profile incomplete_merged_profile = {
+        ARRAY_N, INCOMPLETE_NTT_N, INCOMPLETE_LOGNTT_N, 2, {2, 3}
+    };
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+    }
+
+// ================
+// Compute the product in Z_Q[x] / (x^256 + 1).
+
+    twiddle = -1;
+    naive_mulR(ref,
+        poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+
+// ================
+// Split into 128 quadratic trinomials x^2 -+ c x + 1.
+
+    test_Bruun(poly1, poly2, ref, COS, profile);
+    test_Bruun(poly1, poly2, ref, COS, merged_profile);
+
+// ================
+// Split into 32 trinomials x^8 -+ c x^4 + 1.
+
+    test_Bruun(poly1, poly2, ref, INCOMPLETE_COS, incomplete_profile);
+    test_Bruun(poly1, poly2, ref, INCOMPLETE_COS, incomplete_merged_profile);
+
+    printf("Test finished!\n");
+
+}
+
@@ -201,6 +201,41 @@ int main(void){
         assert(ref[i] == res[i]);
     }
 
+// ================
+// Reuse the transformed poly2 as a prepared operand.
+// Only poly1 is transformed for each product.
+
+    int16_t poly2_prepared[ARRAY_N];
+
+    memcpy(poly2_prepared, poly2, sizeof(poly2_prepared));
+    GS_iNTT(poly2, streamlined_iNTT_table, profile, coeff_ring);
+    scale = NTT_N;
+    coeff_ring.expZ(&scale, &scale, Q - 2);
+    for(size_t i = 0; i < ARRAY_N; i++){
+        coeff_ring.mulZ(poly2 + i, poly2 + i, &scale);
+    }
+
+    NTT_prepare(res, poly2, streamlined_NTT_table, profile, coeff_ring);
+    assert(memcmp(res, poly2_prepared, sizeof(res)) == 0);
+
+    for(size_t k = 0; k < 4; k++){
+
+        for(size_t i = 0; i < ARRAY_N; i++){
+            t = rand();
+            coeff_ring.memberZ(poly1 + i, &t);
+        }
+
+        naive_mulR(ref, poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+        NTT_mul_prepared(res, poly1, poly2_prepared, streamlined_NTT_table, streamlined_iNTT_table, profile, coeff_ring);
+
+        scale = NTT_N;
+        for(size_t i = 0; i < ARRAY_N; i++){
+            coeff_ring.mulZ(ref + i, ref + i, &scale);
+            assert(ref[i] == res[i]);
+        }
+
+    }
+
     printf("Test finished!\n");
 
 }
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// ================
+// This file demonstrates the DWT for Z_Q[x] / (x^256 + 1) with Harvey's lazy butterflies
+// over unsigned 32-bit and 64-bit integers.
+
+// ================
+// Theory.
+// Let w be the size of the arithmetic. For a fixed twiddle factor b in [0, Q), we precompute
+// b' = floor(b 2^w / Q). For any a in [0, 2^w), the value
+// r = a b - floor(a b' / 2^w) Q
+// satisfies 0 <= r < 2 Q. Therefore, r can be computed modulo 2^w with the low product a b,
+// the high product a b', and the low product floor(a b' / 2^w) Q (Shoup's multiplication).
+// Harvey observed that the butterflies need not reduce their outputs to [0, Q):
+// - Cooley--Tukey: inputs in [0, 4 Q). We first reduce a to [0, 2 Q) with a conditional
+//   subtraction, compute t = b twiddle in [0, 2 Q), and output a + t and a - t + 2 Q in [0, 4 Q).
+// - Gentleman--Sande: inputs in [0, 2 Q). We output a + b reduced to [0, 2 Q) with a conditional
+//   subtraction and (a - b + 2 Q) twiddle in [0, 2 Q).
+// As long as 4 Q < 2^w, no overflow occurs and only one pass of conditional subtractions is
+// needed at the end of the transformation.
+
+// ================
+// Optimization guide.
+/*
+
+1. The table of Shoup's precomputation doubles the size of the twiddle factors.
+   Interleave both tables if the platform prefers one stream of loads.
+
+2. The final reduction can be merged into the following point-wise multiplication or
+   the last layer.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// Harvey's butterflies are the standard choice for scalar implementations of the NTT
+// over word-size primes, for example, in the residue number systems of homomorphic encryption.
+
+#define ARRAY_N 256
+#define NTT_N 256
+#define LOGNTT_N 8
+
+// A 32-bit instance.
+#define Q32 (8380417)
+#define OMEGA32 (1753)
+#define OMEGA32_INV (731434)
+
+// A 64-bit instance.
+#define Q64 (2305843009213687297LL)
+#define OMEGA64 (502364153934162438LL)
+#define OMEGA64_INV (1073366549995548077LL)
+
+// ================
+// Z_Q32 with signed arithmetic for generating the tables and the reference.
+
+int32_t mod32 = Q32;
+
+void memberZ32(void *des, const void *src){
+    cmod_int32(des, src, &mod32);
+}
+
+void addZ32(void *des, const void *src1, const void *src2){
+    addmod_int32(des, src1, src2, &mod32);
+}
+
+void subZ32(void *des, const void *src1, const void *src2){
+    submod_int32(des, src1, src2, &mod32);
+}
+
+void mulZ32(void *des, const void *src1, const void *src2){
+    mulmod_int32(des, src1, src2, &mod32);
+}
+
+void expZ32(void *des, const void *src, size_t e){
+    expmod_int32(des, src, e, &mod32);
+}
+
+struct ring coeff_ring32 = {
+    .sizeZ = sizeof(int32_t),
+    .memberZ = memberZ32,
+    .addZ = addZ32,
+    .subZ = subZ32,
+    .mulZ = mulZ32,
+    .expZ = expZ32
+};
+
+// ================
+// Z_Q64 with signed arithmetic for generating the tables and the reference.
+
+int64_t mod64 = Q64;
+
+void memberZ64(void *des, const void *src){
+    cmod_int64(des, src, &mod64);
+}
+
+void addZ64(void *des, const void *src1, const void *src2){
+    addmod_int128(des, src1, src2, &mod64);
+}
+
+void subZ64(void *des, const void *src1, const void *src2){
+    submod_int128(des, src1, src2, &mod64);
+}
+
+void mulZ64(void *des, const void *src1, const void *src2){
+    mulmod_int64(des, src1, src2, &mod64);
+}
+
+void expZ64(void *des, const void *src, size_t e){
+    expmod_int64(des, src, e, &mod64);
+}
+
+struct ring coeff_ring64 = {
+    .sizeZ = sizeof(int64_t),
+    .memberZ = memberZ64,
+    .addZ = addZ64,
+    .subZ = subZ64,
+    .mulZ = mulZ64,
+    .expZ = expZ64
+};
+
+// ================
+
+int32_t twiddle_table32[NTT_N - 1];
+uint32_t Harvey_table32[NTT_N - 1], Harvey_table32_Shoup[NTT_N - 1];
+uint32_t Harvey_itable32[NTT_N - 1], Harvey_itable32_Shoup[NTT_N - 1];
+
+int64_t twiddle_table64[NTT_N - 1];
+uint64_t Harvey_table64[NTT_N - 1], Harvey_table64_Shoup[NTT_N - 1];
+uint64_t Harvey_itable64[NTT_N - 1], Harvey_itable64_Shoup[NTT_N - 1];
+
+static
+void test32(struct compress_profile profile){
+
+    int32_t poly1[ARRAY_N], poly2[ARRAY_N], ref[ARRAY_N];
+    uint32_t upoly1[ARRAY_N], upoly2[ARRAY_N], res[ARRAY_N];
+    uint32_t q = Q32;
+
+    int32_t omega, zeta, twiddle, scale, t;
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = rand();
+        coeff_ring32.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring32.memberZ(poly2 + i, &t);
+    }
+
+    // Compute the product in Z_Q[x] / (x^256 + 1).
+    twiddle = -1;
+    naive_mulR(ref, poly1, poly2, ARRAY_N, &twiddle, coeff_ring32);
+
+    // Generate the tables for the forward and inverse transformations.
+    scale = 1;
+    zeta = OMEGA32;
+    coeff_ring32.expZ(&omega, &zeta, 2);
+    gen_DWT_table(twiddle_table32, &scale, &omega, &zeta, profile, coeff_ring32);
+    gen_Shoup_table_uint32(Harvey_table32, Harvey_table32_Shoup, twiddle_table32, NTT_N - 1, &q);
+
+    zeta = OMEGA32_INV;
+    coeff_ring32.expZ(&omega, &zeta, 2);
+    gen_DWT_table(twiddle_table32, &scale, &omega, &zeta, profile, coeff_ring32);
+    gen_Shoup_table_uint32(Harvey_itable32, Harvey_itable32_Shoup, twiddle_table32, NTT_N - 1, &q);
+
+    // Map the inputs to [0, Q).
+    for(size_t i = 0; i < ARRAY_N; i++){
+        upoly1[i] = (uint32_t)(poly1[i] < 0 ? poly1[i] + Q32 : poly1[i]);
+        upoly2[i] = (uint32_t)(poly2[i] < 0 ? poly2[i] + Q32 : poly2[i]);
+    }
+
+    Harvey_CT_NTT_uint32(upoly1, Harvey_table32, Harvey_table32_Shoup, profile, &q);
+    Harvey_CT_NTT_uint32(upoly2, Harvey_table32, Harvey_table32_Shoup, profile, &q);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        res[i] = (uint32_t)(((uint64_t)upoly1[i] * upoly2[i]) % q);
+    }
+
+    Harvey_GS_iNTT_uint32(res, Harvey_itable32, Harvey_itable32_Shoup, profile, &q);
+
+    // Multiply the scale to reference.
+    scale = NTT_N;
+    for(size_t i = 0; i < ARRAY_N; i++){
+        coeff_ring32.mulZ(ref + i, ref + i, &scale);
+        if(ref[i] < 0){
+            ref[i] += Q32;
+        }
+        assert((uint32_t)ref[i] == res[i]);
+    }
+
+}
+
+static
+void test64(struct compress_profile profile){
+
+    int64_t poly1[ARRAY_N], poly2[ARRAY_N], ref[ARRAY_N];
+    uint64_t upoly1[ARRAY_N], upoly2[ARRAY_N], res[ARRAY_N];
+    uint64_t q = Q64;
+
+    int64_t omega, zeta, twiddle, scale, t;
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = ((int64_t)rand() << 32) ^ rand();
+        coeff_ring64.memberZ(poly1 + i, &t);
+        t = ((int64_t)rand() << 32) ^ rand();
+        coeff_ring64.memberZ(poly2 + i, &t);
+    }
+
+    // Compute the product in Z_Q[x] / (x^256 + 1).
+    twiddle = -1;
+    naive_mulR(ref, poly1, poly2, ARRAY_N, &twiddle, coeff_ring64);
+
+    // Generate the tables for the forward and inverse transformations.
+    scale = 1;
+    zeta = OMEGA64;
+    coeff_ring64.expZ(&omega, &zeta, 2);
+    gen_DWT_table(twiddle_table64, &scale, &omega, &zeta, profile, coeff_ring64);
+    gen_Shoup_table_uint64(Harvey_table64, Harvey_table64_Shoup, twiddle_table64, NTT_N - 1, &q);
+
+    zeta = OMEGA64_INV;
+    coeff_ring64.expZ(&omega, &zeta, 2);
+    gen_DWT_table(twiddle_table64, &scale, &omega, &zeta, profile, coeff_ring64);
+    gen_Shoup_table_uint64(Harvey_itable64, Harvey_itable64_Shoup, twiddle_table64, NTT_N - 1, &q);
+
+    // Map the inputs to [0, Q).
+    for(size_t i = 0; i < ARRAY_N; i++){
+        upoly1[i] = (uint64_t)(poly1[i] < 0 ? poly1[i] + Q64 : poly1[i]);
+        upoly2[i] = (uint64_t)(poly2[i] < 0 ? poly2[i] + Q64 : poly2[i]);
+    }
+
+    Harvey_CT_NTT_uint64(upoly1, Harvey_table64, Harvey_table64_Shoup, profile, &q);
+    Harvey_CT_NTT_uint64(upoly2, Harvey_table64, Harvey_table64_Shoup, profile, &q);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = (int64_t)upoly1[i];
+        twiddle = (int64_t)upoly2[i];
+        coeff_ring64.mulZ(&t, &t, &twiddle);
+        res[i] = (uint64_t)(t < 0 ? t + Q64 : t);
+    }
+
+    Harvey_GS_iNTT_uint64(res, Harvey_itable64, Harvey_itable64_Shoup, profile, &q);
+
+    // Multiply the scale to reference.
+    scale = NTT_N;
+    for(size_t i = 0; i < ARRAY_N; i++){
+        coeff_ring64.mulZ(ref + i, ref + i, &scale);
+        if(ref[i] < 0){
+            ref[i] += Q64;
+        }
+        assert((uint64_t)ref[i] == res[i]);
+    }
+
+}
+
+int main(void){
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N
+    };
+
+    for(size_t i = 0; i < profile.compressed_layers; i++){
+        profile.merged_layers[i] = 1;
+    }
+
+    test32(profile);
+    test64(profile);
+
+    printf("Test finished!\n");
+
+}
+
@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// The headers are generated at build time by gen_table_header (see Makefile).
+#include "DWT_const_table.h"
+#include "DWT_const_table_Shoup.h"
+
+// ================
+// This file demonstrates the DWT for Z_12289[x] / (x^512 + 1) with constant tables generated at
+// build time.
+
+// ================
+// Theory.
+// The twiddle factors depend only on (q, n, zeta, the layer-merging strategy, the representation,
+// and the layout). If these are fixed at build time, the tables can be emitted as const arrays.
+// The tables then cost nothing at startup, reside in .rodata, and are shared across processes
+// mapping the same binary. gen_table_header emits such headers with the generators of gen_table.c:
+// - form=plain|montgomery|shoup selects signed representatives, the Montgomery form w 2^16 or
+//   w 2^32, or unsigned representatives with Shoup's precomputation for Harvey's butterflies.
+// - layout=streamlined|padded|vec:V selects gen_streamlined_DWT_table or gen_vec_DWT_table.
+
+// ================
+// Optimization guide.
+/*
+
+1. Generate the tables for the exact representation and layout consumed by the implementation
+   so that no conversion is needed at run time.
+
+2. Keep the generator and the run-time generators in the same source tree. This file checks
+   the generated tables against gen_streamlined_DWT_table and gen_Shoup_table_uint32.
+
+*/
+
+#define ARRAY_N 512
+#define NTT_N 512
+#define LOGNTT_N 9
+
+#define Q (12289)
+
+// OMEGA is a principal (2 NTT_N)-th root of unity in Z_Q.
+#define OMEGA (49)
+#define OMEGA_INV (1254)
+
+// ================
+// Z_Q
+
+int16_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int16(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int16(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int16(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int16(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int16(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+// Check the generated tables against the run-time generators.
+
+static
+void check_tables(void){
+
+    int16_t twiddle_table[NTT_N - 1];
+    int32_t twiddle_table32[NTT_N - 1];
+    uint32_t Shoup_table[NTT_N - 1], Shoup_table_Shoup[NTT_N - 1];
+    int16_t omega, zeta, scale;
+    uint32_t q = Q;
+
+    struct compress_profile merged_profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, 4, {3, 2, 2, 2}
+    };
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N
+    };
+
+    for(size_t i = 0; i < profile.compressed_layers; i++){
+        profile.merged_layers[i] = 1;
+    }
+
+    assert(DWT_CONST_TABLE_LEN == NTT_N - 1);
+    assert(DWT_SHOUP_TABLE_LEN == NTT_N - 1);
+
+    scale = 1;
+    zeta = OMEGA;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    gen_streamlined_DWT_table(twiddle_table, &scale, &omega, &zeta, merged_profile, 0, coeff_ring);
+    assert(memcmp(twiddle_table, DWT_CONST_NTT_table, sizeof(twiddle_table)) == 0);
+
+    zeta = OMEGA_INV;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    gen_streamlined_DWT_table(twiddle_table, &scale, &omega, &zeta, merged_profile, 0, coeff_ring);
+    assert(memcmp(twiddle_table, DWT_CONST_iNTT_table, sizeof(twiddle_table)) == 0);
+
+    // The Shoup tables are generated from 32-bit signed representatives.
+    scale = 1;
+    for(size_t k = 0; k < 2; k++){
+        zeta = (k == 0) ? OMEGA : OMEGA_INV;
+        coeff_ring.expZ(&omega, &zeta, 2);
+        gen_DWT_table(twiddle_table, &scale, &omega, &zeta, profile, coeff_ring);
+        for(size_t i = 0; i < NTT_N - 1; i++){
+            twiddle_table32[i] = twiddle_table[i];
+        }
+        gen_Shoup_table_uint32(Shoup_table, Shoup_table_Shoup, twiddle_table32, NTT_N - 1, &q);
+        assert(memcmp(Shoup_table, (k == 0) ? DWT_SHOUP_NTT_table : DWT_SHOUP_iNTT_table, sizeof(Shoup_table)) == 0);
+        assert(memcmp(Shoup_table_Shoup, (k == 0) ? DWT_SHOUP_NTT_table_Shoup : DWT_SHOUP_iNTT_table_Shoup, sizeof(Shoup_table)) == 0);
+    }
+
+}
+
+int main(void){
+
+    int16_t poly1[ARRAY_N], poly2[ARRAY_N];
+    int16_t ref[ARRAY_N], res[ARRAY_N];
+    uint32_t upoly1[ARRAY_N], upoly2[ARRAY_N], ures[ARRAY_N];
+    int16_t twiddle, scale, t;
+    uint32_t q = Q;
+
+    struct compress_profile merged_profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, 4, {3, 2, 2, 2}
+    };
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N
+    };
+
+    for(size_t i = 0; i < profile.compressed_layers; i++){
+        profile.merged_layers[i] = 1;
+    }
+
+    check_tables();
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+    }
+
+    // Compute the product in Z_Q[x] / (x^512 + 1) scaled by NTT_N.
+    twiddle = -1;
+    naive_mulR(ref, poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+    scale = NTT_N;
+    for(size_t i = 0; i < ARRAY_N; i++){
+        coeff_ring.mulZ(ref + i, ref + i, &scale);
+    }
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        upoly1[i] = (uint32_t)(poly1[i] < 0 ? poly1[i] + Q : poly1[i]);
+        upoly2[i] = (uint32_t)(poly2[i] < 0 ? poly2[i] + Q : poly2[i]);
+    }
+
+    // Signed arithmetic with the merged layers and the constant tables.
+    compressed_CT_NTT(poly1, 0, merged_profile.compressed_layers - 1, DWT_CONST_NTT_table, merged_profile, coeff_ring);
+    compressed_CT_NTT(poly2, 0, merged_profile.compressed_layers - 1, DWT_CONST_NTT_table, merged_profile, coeff_ring);
+    point_mul(res, poly1, poly2, ARRAY_N, 1, coeff_ring);
+    compressed_GS_iNTT(res, 0, merged_profile.compressed_layers - 1, DWT_CONST_iNTT_table, merged_profile, coeff_ring);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        assert(ref[i] == res[i]);
+    }
+
+    // Harvey's butterflies with the constant Shoup tables.
+    Harvey_CT_NTT_uint32(upoly1, DWT_SHOUP_NTT_table, DWT_SHOUP_NTT_table_Shoup, profile, &q);
+    Harvey_CT_NTT_uint32(upoly2, DWT_SHOUP_NTT_table, DWT_SHOUP_NTT_table_Shoup, profile, &q);
+    for(size_t i = 0; i < ARRAY_N; i++){
+        ures[i] = (uint32_t)(((uint64_t)upoly1[i] * upoly2[i]) % Q);
+    }
+    Harvey_GS_iNTT_uint32(ures, DWT_SHOUP_iNTT_table, DWT_SHOUP_iNTT_table_Shoup, profile, &q);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        assert((uint32_t)(ref[i] < 0 ? ref[i] + Q : ref[i]) == ures[i]);
+    }
+
+    printf("Test finished!\n");
+
+}
+
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// ================
+// This file demonstrates the constant-geometry (Pease) formulation of the discrete weighted
+// transformation (DWT) and its inversion for Z_Q[x] / (x^256 + 1).
+
+// ================
+// Theory.
+// In the Cooley--Tukey FFT (see DWT.c), the distance between the inputs of a butterfly halves
+// every layer. For vectorized implementations, this means the last layers require in-register
+// permutations that differ from layer to layer.
+// The constant-geometry formulation relocates the elements after each layer so that every layer
+// reads the pair (i, i + n / 2) and writes the pair (2 i, 2 i + 1).
+// Let (k, j) be the j-th element of the k-th block after level layers of Cooley--Tukey butterflies.
+// If we store (k, j) at j 2^level + k, then the butterfly merging (k, j) and (k, j + n / 2^(level + 1))
+// reads the indices i = j 2^level + k and i + n / 2, and produces (2 k, j) and (2 k + 1, j) stored
+// at 2 i and 2 i + 1. After the last layer, (k, 0) is stored at k, so the output is identical to
+// the one of the Cooley--Tukey FFT.
+// The price is that the layers can no longer be computed in-place.
+
+// ================
+// A small example.
+// For n = 8, the three layers all compute the butterflies on the pairs
+// (0, 4), (1, 5), (2, 6), (3, 7) and write the results to (0, 1), (2, 3), (4, 5), (6, 7).
+// Only the twiddle factors differ:
+// - Layer 0: all butterflies use the twiddle factor of block 0.
+// - Layer 1: the butterflies use the twiddle factors of blocks 0, 1, 0, 1.
+// - Layer 2: the butterflies use the twiddle factors of blocks 0, 1, 2, 3.
+// gen_CG_DWT_table stores n / 2 twiddle factors per layer so they can be loaded contiguously.
+
+// ================
+// Optimization guide.
+/*
+
+1. Since every layer shares the same addressing, a vectorized implementation only needs
+   one load pattern and one interleaving store pattern (zip) for all the layers.
+
+2. The twiddle factors of the initial layers are replicated in the table.
+   If memory is a concern, load the 2^level distinct twiddle factors and broadcast them instead.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// See DWT.c.
+
+// ================
+// Below are the parameters for this file.
+// We demonstrate how to compute products of two polynomials in Z_8380417[x] / (x^256 + 1) with size-256 DWT.
+
+#define ARRAY_N 256
+#define NTT_N 256
+#define LOGNTT_N 8
+
+#define Q (8380417)
+
+// OMEGA is a principal (2 NTT_N)-th root of unity in Z_Q.
+#define OMEGA (1753)
+#define OMEGA_INV (731434)
+
+// ================
+// Z_Q
+
+int32_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int32(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int32(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int32(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int32(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int32(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int32_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+
+int32_t twiddle_table[NTT_N - 1];
+int32_t CG_twiddle_table[LOGNTT_N * (NTT_N / 2)];
+
+int main(void){
+
+    int32_t poly1[ARRAY_N], poly2[ARRAY_N];
+    int32_t poly1_CT[ARRAY_N];
+    int32_t ref[ARRAY_N], res[ARRAY_N];
+
+    int32_t omega, zeta, twiddle, scale, t;
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+    }
+
+// ================
+// Compute the product in Z_Q[x] / (x^256 + 1).
+
+    twiddle = -1;
+    naive_mulR(ref,
+        poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+
+// ================
+// Specify the profile.
+// The constant-geometry transformation does not merge layers.
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N
+    };
+
+    for(size_t i = 0; i < profile.compressed_layers; i++){
+        profile.merged_layers[i] = 1;
+    }
+
+// ================
+// Generate twiddle factors for the constant-geometry Cooley--Tukey FFT.
+
+    zeta = OMEGA;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    scale = 1;
+    gen_CG_DWT_table(CG_twiddle_table,
+        &scale, &omega, &zeta, profile, coeff_ring);
+    gen_DWT_table(twiddle_table,
+        &scale, &omega, &zeta, profile, coeff_ring);
+
+// ================
+// Apply constant-geometry Cooley--Tukey FFT.
+// The result must be identical to the in-place Cooley--Tukey FFT.
+
+    memcpy(poly1_CT, poly1, sizeof(poly1));
+    CT_NTT(poly1_CT, twiddle_table, profile, coeff_ring);
+
+    CG_CT_NTT(poly1, CG_twiddle_table, profile, coeff_ring);
+    CG_CT_NTT(poly2, CG_twiddle_table, profile, coeff_ring);
+
+    assert(memcmp(poly1, poly1_CT, sizeof(poly1)) == 0);
+
+// ================
+
+    point_mul(res, poly1, poly2, ARRAY_N, 1, coeff_ring);
+
+// ================
+// Generate twiddle factors for the inverse via constant-geometry Gentleman--Sande FFT.
+
+    zeta = OMEGA_INV;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    scale = 1;
+    gen_CG_DWT_table(CG_twiddle_table,
+        &scale, &omega, &zeta, profile, coeff_ring);
+
+// ================
+// Apply constant-geometry Gentleman--Sande FFT.
+
+    CG_GS_iNTT(res, CG_twiddle_table, profile, coeff_ring);
+
+// ================
+// Multiply the scale to reference.
+
+    scale = NTT_N;
+    for(size_t i = 0; i < ARRAY_N; i++){
+        coeff_ring.mulZ(ref + i, ref + i, &scale);
+    }
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        assert(ref[i] == res[i]);
+    }
+
+    printf("Test finished!\n");
+
+}
+
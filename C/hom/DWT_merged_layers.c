@@ -116,6 +116,60 @@ int16_t streamlined_iNTT_table[NTT_N - 1] = {
 
 int16_t streamlined_twiddle_table[(NTT_N - 1)];
 
+// ================
+// Check that the direct generators, serial and parallel, reproduce the streamlined tables byte by byte
+// for several layer-merging strategies, with and without padding.
+
+static
+void test_direct_tables(void){
+
+    // The padded tables hold at most NTT_N - 1 + NTT_N / 2 elements.
+    int16_t table[2 * NTT_N], table_direct[2 * NTT_N];
+    int16_t omega, zeta, scale;
+
+    struct compress_profile profiles[4] = {
+        {ARRAY_N, NTT_N, LOGNTT_N, 4, {3, 2, 2, 2}},
+        {ARRAY_N, NTT_N, LOGNTT_N, 3, {2, 3, 4}},
+        {ARRAY_N, NTT_N, LOGNTT_N, 1, {9}},
+        {ARRAY_N, NTT_N, LOGNTT_N, 9, {1, 1, 1, 1, 1, 1, 1, 1, 1}}
+    };
+
+    zeta = OMEGA;
+    coeff_ring.expZ(&omega, &zeta, 2);
+
+    for(size_t i = 0; i < 4; i++){
+        for(int pad = 0; pad < 2; pad++){
+            // The Montgomery factor 2^16 mod Q as a non-trivial scale.
+            scale = 4091;
+
+            memset(table, 0, sizeof(table));
+            memset(table_direct, 0, sizeof(table_direct));
+            gen_streamlined_DWT_table(table,
+                &scale, &omega, &zeta, profiles[i], pad, coeff_ring);
+            gen_streamlined_DWT_table_direct(table_direct,
+                &scale, &omega, &zeta, profiles[i], pad, coeff_ring);
+            assert(memcmp(table, table_direct, sizeof(table)) == 0);
+            memset(table_direct, 0, sizeof(table_direct));
+            gen_streamlined_DWT_table_direct_parallel(table_direct,
+                &scale, &omega, &zeta, profiles[i], pad, coeff_ring, NULL, NULL);
+            assert(memcmp(table, table_direct, sizeof(table)) == 0);
+
+            memset(table, 0, sizeof(table));
+            memset(table_direct, 0, sizeof(table_direct));
+            gen_streamlined_inv_CT_table(table,
+                &scale, &omega, profiles[i], pad, coeff_ring);
+            gen_streamlined_inv_CT_table_direct(table_direct,
+                &scale, &omega, profiles[i], pad, coeff_ring);
+            assert(memcmp(table, table_direct, sizeof(table)) == 0);
+            memset(table_direct, 0, sizeof(table_direct));
+            gen_streamlined_inv_CT_table_direct_parallel(table_direct,
+                &scale, &omega, profiles[i], pad, coeff_ring);
+            assert(memcmp(table, table_direct, sizeof(table)) == 0);
+        }
+    }
+
+}
+
 int main(void){
 
     int16_t poly1[ARRAY_N], poly2[ARRAY_N];
@@ -196,6 +250,8 @@ int main(void){
         assert(ref[i] == res[i]);
     }
 
+    test_direct_tables();
+
     printf("Test finished!\n");
 
 }
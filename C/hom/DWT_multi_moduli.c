@@ -0,0 +1,417 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// ================
+// This file demonstrates multi-moduli NTTs for Z_8192[x] / (x^256 + 1) where one of the
+// input polynomials has small coefficients (Saber).
+
+// ================
+// Theory.
+// Let a be a polynomial with coefficients in [-4096, 4096) and s be a polynomial with
+// coefficients in [-ETA, ETA]. The product a s in Z[x] / (x^256 + 1) has coefficients bounded
+// by 256 * 4096 * ETA in absolute value. If Q' > 2 * 256 * 4096 * ETA, we can compute
+// a s in Z_Q'[x] / (x^256 + 1), take the signed representatives, and reduce them to Z_8192.
+// Since 8192 is a power of two, there is no NTT over Z_8192, but we can choose Q' to be
+// - an NTT-friendly prime, e.g., Q' = 25166081 ([CHK+21]), or
+// - a product of NTT-friendly primes, e.g., Q' = 3329 * 7681 ([ACC+22]).
+// For the latter, we compute the NTTs over Z_3329 and Z_7681 independently and recombine
+// the results with the explicit Chinese remainder theorem
+// c = c_1 + 3329 (((c_2 - c_1) 3329^(-1)) mod 7681)
+// where c_1 and c_2 are the signed representatives modulo 3329 and 7681.
+// Each computation can be done with 16-bit arithmetic except the last multiplication by 3329.
+// Neither 3329 - 1 nor 25166081 - 1 is divisible by 512, so we use size-128 DWTs and
+// base multiplications in Z_Q'[x] / (x^2 -+ omega).
+
+// ================
+// A small example.
+// For 3329 and 7681, 3329^(-1) = -3161 mod 7681.
+// For c = 5000000, we have c_1 = c - 3329 * 1502 = -158, c_2 = c - 7681 * 651 = -331,
+// ((-331 + 158) * (-3161)) mod 7681 = 1502, and -158 + 3329 * 1502 = 5000000.
+
+// ================
+// Optimization guide.
+/*
+
+1. The explicit CRT replaces the expensive reduction modulo 3329 * 7681 by three 16-bit
+   multiplications (a Barrett multiplication modulo 7681) and one 32-bit multiply-accumulate.
+
+2. The reduction to Z_8192 is free since we only keep the lower 13 bits.
+
+3. For the matrix-vector multiplication in Saber, the NTTs of the small polynomials are
+   computed only once and the inverse is applied after accumulating in the NTT domain.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// See [CHK+21] and [ACC+22] for Saber.
+
+#define ARRAY_N 256
+#define NTT_N 128
+#define LOGNTT_N 7
+
+#define Q (8192)
+#define ETA 5
+
+#define Q1 (3329)
+#define Q2 (7681)
+#define Q_PRIME (25166081)
+
+// Principal 256-th roots of unity and their inverses.
+#define OMEGA1 (17)
+#define OMEGA1_INV (1175)
+#define OMEGA2 (-1996)
+#define OMEGA2_INV (-2028)
+#define OMEGA_PRIME (1708789)
+#define OMEGA_PRIME_INV (3881784)
+
+// Inverses of NTT_N.
+#define NTT_N_INV1 (-26)
+#define NTT_N_INV2 (-60)
+#define NTT_N_INV_PRIME (-196610)
+
+// Q1^(-1) mod Q2.
+#define Q1_INV (-3161)
+// round(Q1_INV 2^16 / Q2).
+#define Q1_INV_HI (-26970)
+
+// ================
+// Z_Q
+
+int16_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int16(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int16(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int16(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int16(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int16(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+// Z_Q1
+
+int16_t mod1 = Q1;
+
+void memberZ1(void *des, const void *src){
+    cmod_int16(des, src, &mod1);
+}
+
+void addZ1(void *des, const void *src1, const void *src2){
+    addmod_int16(des, src1, src2, &mod1);
+}
+
+void subZ1(void *des, const void *src1, const void *src2){
+    submod_int16(des, src1, src2, &mod1);
+}
+
+void mulZ1(void *des, const void *src1, const void *src2){
+    mulmod_int16(des, src1, src2, &mod1);
+}
+
+void expZ1(void *des, const void *src, size_t e){
+    expmod_int16(des, src, e, &mod1);
+}
+
+struct ring ring1 = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ1,
+    .addZ = addZ1,
+    .subZ = subZ1,
+    .mulZ = mulZ1,
+    .expZ = expZ1
+};
+
+// ================
+// Z_Q2
+
+int16_t mod2 = Q2;
+
+void memberZ2(void *des, const void *src){
+    cmod_int16(des, src, &mod2);
+}
+
+void addZ2(void *des, const void *src1, const void *src2){
+    addmod_int16(des, src1, src2, &mod2);
+}
+
+void subZ2(void *des, const void *src1, const void *src2){
+    submod_int16(des, src1, src2, &mod2);
+}
+
+void mulZ2(void *des, const void *src1, const void *src2){
+    mulmod_int16(des, src1, src2, &mod2);
+}
+
+void expZ2(void *des, const void *src, size_t e){
+    expmod_int16(des, src, e, &mod2);
+}
+
+struct ring ring2 = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ2,
+    .addZ = addZ2,
+    .subZ = subZ2,
+    .mulZ = mulZ2,
+    .expZ = expZ2
+};
+
+// ================
+// Z_Q_PRIME
+
+int32_t mod_prime = Q_PRIME;
+
+void memberZ_prime(void *des, const void *src){
+    cmod_int32(des, src, &mod_prime);
+}
+
+void addZ_prime(void *des, const void *src1, const void *src2){
+    addmod_int32(des, src1, src2, &mod_prime);
+}
+
+void subZ_prime(void *des, const void *src1, const void *src2){
+    submod_int32(des, src1, src2, &mod_prime);
+}
+
+void mulZ_prime(void *des, const void *src1, const void *src2){
+    mulmod_int32(des, src1, src2, &mod_prime);
+}
+
+void expZ_prime(void *des, const void *src, size_t e){
+    expmod_int32(des, src, e, &mod_prime);
+}
+
+struct ring ring_prime = {
+    .sizeZ = sizeof(int32_t),
+    .memberZ = memberZ_prime,
+    .addZ = addZ_prime,
+    .subZ = subZ_prime,
+    .mulZ = mulZ_prime,
+    .expZ = expZ_prime
+};
+
+// ================
+// Tables of an NTT-friendly modulus.
+
+struct DWT_tables {
+    void *NTT_table;
+    void *iNTT_table;
+    void *mul_table;
+    const void *NTT_N_inv;
+};
+
+// Generate the tables for the size-NTT_N DWT of Z_Q'[x] / (x^ARRAY_N + 1) and
+// the twiddle factors of the base multiplications in Z_Q'[x] / (x^2 -+ omega).
+static
+void gen_tables(struct DWT_tables tables,
+    const void *omega, const void *omega_inv,
+    struct compress_profile profile, struct ring ring){
+
+    char zeta[ring.sizeZ], omega2[ring.sizeZ], scale[ring.sizeZ];
+
+    ring.expZ(scale, omega, 0);
+
+    memcpy(zeta, omega, ring.sizeZ);
+    ring.expZ(omega2, zeta, 2);
+    gen_DWT_table(tables.NTT_table, scale, omega2, zeta, profile, ring);
+    gen_mul_table(tables.mul_table, zeta, omega2, profile, ring);
+
+    memcpy(zeta, omega_inv, ring.sizeZ);
+    ring.expZ(omega2, zeta, 2);
+    gen_DWT_table(tables.iNTT_table, scale, omega2, zeta, profile, ring);
+
+}
+
+// Multiply src1 and src2 in Z_Q'[x] / (x^ARRAY_N + 1) with the size-NTT_N DWT.
+// The inputs are mapped to Z_Q' with ring.memberZ.
+static
+void DWT_mul(void *des, const void *src1, const void *src2,
+    struct DWT_tables tables,
+    struct compress_profile profile, struct ring ring){
+
+    size_t len = profile.array_n / profile.ntt_n;
+    char buff1[profile.array_n * ring.sizeZ], buff2[profile.array_n * ring.sizeZ];
+    char twiddle[ring.sizeZ], zero[ring.sizeZ];
+
+    for(size_t i = 0; i < profile.array_n; i++){
+        ring.memberZ(buff1 + i * ring.sizeZ, src1 + i * ring.sizeZ);
+        ring.memberZ(buff2 + i * ring.sizeZ, src2 + i * ring.sizeZ);
+    }
+
+    CT_NTT(buff1, tables.NTT_table, profile, ring);
+    CT_NTT(buff2, tables.NTT_table, profile, ring);
+
+    // The 2 i-th and (2 i + 1)-th blocks are in Z_Q'[x] / (x^len - omega_i) and
+    // Z_Q'[x] / (x^len + omega_i).
+    memset(zero, 0, ring.sizeZ);
+    for(size_t i = 0; i < profile.ntt_n; i++){
+        if(i & 1){
+            ring.subZ(twiddle, zero, tables.mul_table + (i >> 1) * ring.sizeZ);
+        }else{
+            memcpy(twiddle, tables.mul_table + (i >> 1) * ring.sizeZ, ring.sizeZ);
+        }
+        naive_mulR(des + i * len * ring.sizeZ,
+            buff1 + i * len * ring.sizeZ, buff2 + i * len * ring.sizeZ,
+            len, twiddle, ring);
+    }
+
+    GS_iNTT(des, tables.iNTT_table, profile, ring);
+
+    for(size_t i = 0; i < profile.array_n; i++){
+        ring.mulZ(des + i * ring.sizeZ, des + i * ring.sizeZ, tables.NTT_N_inv);
+    }
+
+}
+
+// ================
+
+int16_t NTT_table1[NTT_N - 1], iNTT_table1[NTT_N - 1], mul_table1[NTT_N / 2];
+int16_t NTT_table2[NTT_N - 1], iNTT_table2[NTT_N - 1], mul_table2[NTT_N / 2];
+int32_t NTT_table_prime[NTT_N - 1], iNTT_table_prime[NTT_N - 1], mul_table_prime[NTT_N / 2];
+
+int16_t NTT_N_inv1 = NTT_N_INV1, NTT_N_inv2 = NTT_N_INV2;
+int32_t NTT_N_inv_prime = NTT_N_INV_PRIME;
+
+// Multiply src1 and src2 in Z_Q[x] / (x^ARRAY_N + 1) over (Z_Q1 x Z_Q2)[x] / (x^ARRAY_N + 1).
+static
+void multi_moduli_mul(int16_t *des, const int16_t *src1, const int16_t *src2,
+    struct DWT_tables tables1, struct DWT_tables tables2,
+    struct compress_profile profile){
+
+    int16_t res1[ARRAY_N], res2[ARRAY_N];
+    int16_t q1 = Q1, q2 = Q2, q1_inv = Q1_INV, q1_inv_hi = Q1_INV_HI;
+    int32_t t;
+
+    DWT_mul(res1, src1, src2, tables1, profile, ring1);
+    DWT_mul(res2, src1, src2, tables2, profile, ring2);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        explicit_CRT_int16(&t, res1 + i, res2 + i, &q1, &q2, &q1_inv, &q1_inv_hi);
+        des[i] = (int16_t)(t & (Q - 1));
+        coeff_ring.memberZ(des + i, des + i);
+    }
+
+}
+
+// Multiply src1 and src2 in Z_Q[x] / (x^ARRAY_N + 1) over Z_Q_PRIME[x] / (x^ARRAY_N + 1).
+static
+void single_modulus_mul(int16_t *des, const int16_t *src1, const int16_t *src2,
+    struct DWT_tables tables,
+    struct compress_profile profile){
+
+    int32_t src1_prime[ARRAY_N], src2_prime[ARRAY_N], res[ARRAY_N];
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        src1_prime[i] = src1[i];
+        src2_prime[i] = src2[i];
+    }
+
+    DWT_mul(res, src1_prime, src2_prime, tables, profile, ring_prime);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        des[i] = (int16_t)(res[i] & (Q - 1));
+        coeff_ring.memberZ(des + i, des + i);
+    }
+
+}
+
+int main(void){
+
+    int16_t poly1[ARRAY_N], poly2[ARRAY_N];
+    int16_t ref[ARRAY_N], res[ARRAY_N];
+
+    int16_t twiddle, t;
+    int16_t omega1, omega1_inv, omega2, omega2_inv;
+    int32_t omega_prime, omega_prime_inv;
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N, {1, 1, 1, 1, 1, 1, 1}
+    };
+
+    struct DWT_tables tables1 = {NTT_table1, iNTT_table1, mul_table1, &NTT_N_inv1};
+    struct DWT_tables tables2 = {NTT_table2, iNTT_table2, mul_table2, &NTT_N_inv2};
+    struct DWT_tables tables_prime = {NTT_table_prime, iNTT_table_prime, mul_table_prime, &NTT_N_inv_prime};
+
+// ================
+// poly1 is uniform in Z_Q and poly2 is small.
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        poly2[i] = (int16_t)(rand() % (2 * ETA + 1)) - ETA;
+    }
+
+// ================
+// Compute the product in Z_Q[x] / (x^256 + 1).
+
+    twiddle = -1;
+    naive_mulR(ref,
+        poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+
+// ================
+// Generate the tables.
+
+    omega1 = OMEGA1;
+    omega1_inv = OMEGA1_INV;
+    gen_tables(tables1, &omega1, &omega1_inv, profile, ring1);
+
+    omega2 = OMEGA2;
+    omega2_inv = OMEGA2_INV;
+    gen_tables(tables2, &omega2, &omega2_inv, profile, ring2);
+
+    omega_prime = OMEGA_PRIME;
+    omega_prime_inv = OMEGA_PRIME_INV;
+    gen_tables(tables_prime, &omega_prime, &omega_prime_inv, profile, ring_prime);
+
+// ================
+// Compute the product over (Z_3329 x Z_7681)[x] / (x^256 + 1).
+
+    multi_moduli_mul(res, poly1, poly2, tables1, tables2, profile);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        assert(ref[i] == res[i]);
+    }
+
+// ================
+// Compute the product over Z_25166081[x] / (x^256 + 1).
+
+    single_modulus_mul(res, poly1, poly2, tables_prime, profile);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        assert(ref[i] == res[i]);
+    }
+
+    printf("Test finished!\n");
+
+}
+
@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// ================
+// This file demonstrates the DWT for Z_Q[x] / (x^65536 + 1) with a 61-bit prime Q where
+// the twiddle factors are generated on the fly.
+
+// ================
+// Theory.
+// Let L = LOGNTT_N. In gen_DWT_table, the twiddle factor of the k-th block at the level-th layer is
+// T(level, k) = scale zeta^(2^(L - 1 - level)) omega^(brv(k))
+// where brv reverses L - 1 bits. Writing k = sum_b k_b 2^b, we have
+// brv(k) = sum_b k_b 2^(L - 2 - b).
+// Therefore, T(level, k) = T(level, 0) prod_{b : k_b = 1} g_b with g_b = omega^(2^(L - 2 - b))
+// and the g_b's do not depend on level.
+// 1. Seed table: going from k to k + 1 clears the t trailing ones of k and sets the t-th bit.
+//    Hence T(level, k + 1) = T(level, k) g_t / prod_{b < t} g_b. We store the L values T(level, 0)
+//    and the L - 1 ratios, and spend one multiplication per block.
+// 2. Two-level table: we split k into the coarse part k >> f and the fine part k mod 2^f and
+//    store the 2^f + 2^(L - 1 - f) products of the g_b's. Each twiddle factor is then one
+//    multiplication of a fine factor with the coarse factor shared by 2^f consecutive blocks.
+// In both cases, the results are identical to the ones with the full table.
+
+// ================
+// A small example.
+// For L = 4, the twiddle factors of the 3-rd layer are
+// T(3, 0), T(3, 0) g_0, T(3, 0) g_1, T(3, 0) g_0 g_1, T(3, 0) g_2, ...
+// and the seed table contains the ratios g_0, g_1 / g_0, and g_2 / (g_0 g_1).
+
+// ================
+// Optimization guide.
+/*
+
+1. The full table for NTT_N = 2^20 and 64-bit Q occupies 8 MB and evicts the data from the cache.
+   The seed table occupies 2 L elements and the two-level table with f = (L - 1) / 2 occupies
+   about 2 sqrt(NTT_N / 2) elements.
+
+2. The seed table serializes the multiplications within a layer. If the platform has enough
+   registers, interleave several layers or use the two-level table instead.
+
+3. The regenerated twiddle factors are exact, so no error accumulates.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// Large transformations over 64-bit primes appear in the residue number systems of
+// homomorphic encryption schemes built upon lattices.
+
+#define ARRAY_N 65536
+#define NTT_N 65536
+#define LOGNTT_N 16
+#define LOG_FINE 7
+
+#define Q (2305843009211596801LL)
+
+// OMEGA is a principal (2 NTT_N)-th root of unity in Z_Q.
+#define OMEGA (-624680389869381553LL)
+#define OMEGA_INV (-1089480150624839955LL)
+
+// ================
+// Z_Q
+
+int64_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int64(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int128(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int128(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int64(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int64(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int64_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+
+int64_t streamlined_twiddle_table[NTT_N - 1];
+int64_t OTF_seed[2 * LOGNTT_N - 1];
+int64_t two_level_table[LOGNTT_N + (1 << LOG_FINE) + ((NTT_N / 2) >> LOG_FINE)];
+
+int64_t poly[ARRAY_N];
+int64_t ref[ARRAY_N], res_OTF[ARRAY_N], res_two_level[ARRAY_N];
+
+int main(void){
+
+    int64_t omega, zeta, scale, t;
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = ((int64_t)rand() << 32) ^ rand();
+        coeff_ring.memberZ(poly + i, &t);
+    }
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N
+    };
+
+    for(size_t i = 0; i < profile.compressed_layers; i++){
+        profile.merged_layers[i] = 1;
+    }
+
+// ================
+// Generate the full table, the seed table, and the two-level table.
+// Notice that gen_streamlined_DWT_table keeps its temporary buffer on the heap.
+
+    zeta = OMEGA;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    scale = 1;
+    gen_streamlined_DWT_table(streamlined_twiddle_table,
+        &scale, &omega, &zeta, profile, 0, coeff_ring);
+    gen_OTF_DWT_seed(OTF_seed,
+        &scale, &omega, &zeta, profile, coeff_ring);
+    gen_two_level_DWT_table(two_level_table,
+        &scale, &omega, &zeta, LOG_FINE, profile, coeff_ring);
+
+// ================
+// Apply Cooley--Tukey FFT with the three tables and compare the results.
+
+    memcpy(ref, poly, sizeof(poly));
+    memcpy(res_OTF, poly, sizeof(poly));
+    memcpy(res_two_level, poly, sizeof(poly));
+
+    CT_NTT(ref, streamlined_twiddle_table, profile, coeff_ring);
+    OTF_CT_NTT(res_OTF, OTF_seed, profile, coeff_ring);
+    two_level_CT_NTT(res_two_level, two_level_table, LOG_FINE, profile, coeff_ring);
+
+    assert(memcmp(ref, res_OTF, sizeof(ref)) == 0);
+    assert(memcmp(ref, res_two_level, sizeof(ref)) == 0);
+
+// ================
+// Generate the tables for the inverse and apply Gentleman--Sande FFT.
+
+    zeta = OMEGA_INV;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    scale = 1;
+    gen_OTF_DWT_seed(OTF_seed,
+        &scale, &omega, &zeta, profile, coeff_ring);
+    gen_two_level_DWT_table(two_level_table,
+        &scale, &omega, &zeta, LOG_FINE, profile, coeff_ring);
+
+    OTF_GS_iNTT(res_OTF, OTF_seed, profile, coeff_ring);
+    two_level_GS_iNTT(res_two_level, two_level_table, LOG_FINE, profile, coeff_ring);
+
+// ================
+// Multiply the scale to the input.
+
+    scale = NTT_N;
+    for(size_t i = 0; i < ARRAY_N; i++){
+        coeff_ring.mulZ(poly + i, poly + i, &scale);
+    }
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        assert(poly[i] == res_OTF[i]);
+        assert(poly[i] == res_two_level[i]);
+    }
+
+    printf("Test finished!\n");
+
+}
+
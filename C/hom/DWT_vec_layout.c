@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// ================
+// This file demonstrates the layouts of twiddle factors for vectorized DWTs for
+// Z_7681[x] / (x^256 + 1).
+
+// ================
+// Theory.
+// Consider a vector unit with V lanes and the level with blocks of step = ARRAY_N / 2^(level + 1)
+// butterflies. A vectorized implementation processes V consecutive butterflies at once.
+// - If step >= V, the V butterflies share one twiddle factor. Either the twiddle factor is
+//   broadcast from memory (TWIDDLE_SCALAR), or the table holds V copies and a plain load
+//   suffices (TWIDDLE_REPLICATE). The latter is for platforms without broadcast loads or
+//   where broadcasts compete with the arithmetic for ports.
+// - If step < V, the V butterflies span V / step blocks. The table holds one twiddle factor
+//   per butterfly (TWIDDLE_INTERLEAVE): the t-th lane of the v-th vector is the twiddle factor
+//   of the (v V + t)-th butterfly, i.e., each twiddle factor of the level appears step times.
+// In all cases, one aligned load without shuffles feeds a vector of butterflies.
+// The price is memory: TWIDDLE_REPLICATE stores 2^level V elements and TWIDDLE_INTERLEAVE
+// stores ARRAY_N / 2 elements for the level.
+
+// ================
+// A small example.
+// Let ARRAY_N = 16 and V = 4. The levels have step = 8, 4, 2, 1 and the tables (in terms of the
+// indices of gen_DWT_table within each level) are
+// - level 0 (replicate): 0 0 0 0
+// - level 1 (replicate): 0 0 0 0 1 1 1 1
+// - level 2 (interleave): 0 0 1 1 2 2 3 3
+// - level 3 (interleave): 0 1 2 3 4 5 6 7
+
+// ================
+// Optimization guide.
+/*
+
+1. Choose align as the vector size in elements so that all the loads of twiddle factors are
+   aligned.
+
+2. For the last layers, the coefficients must be permuted so that the V lanes hold the V
+   butterflies of a group. Usually, the permutation is merged into the loads and stores of
+   the coefficients, or into a transposition of V x V blocks.
+
+3. Mixing TWIDDLE_SCALAR for the early layers with TWIDDLE_INTERLEAVE for the last layers
+   minimizes the size of the table on platforms with cheap broadcasts.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// AVX2 implementations with 16 lanes of 16-bit integers and Neon implementations with 8 lanes
+// of 16-bit integers store the twiddle factors of the last layers replicated and interleaved.
+
+#define ARRAY_N 256
+#define NTT_N 256
+#define LOGNTT_N 8
+
+#define Q (7681)
+
+// OMEGA is a principal (2 NTT_N)-th root of unity in Z_Q.
+#define OMEGA (-3626)
+#define OMEGA_INV (2811)
+
+// ================
+// Z_Q
+
+int16_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int16(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int16(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int16(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int16(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int16(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+// Multiply poly1 and poly2 in Z_Q[x] / (x^256 + 1) with vec_CT_NTT and vec_GS_iNTT
+// and compare with CT_NTT and the reference.
+
+static
+void test_layout(
+    const int16_t *poly1, const int16_t *poly2, const int16_t *ref,
+    struct compress_profile profile,
+    struct twiddle_layout layout
+    ){
+
+    int16_t a[ARRAY_N], b[ARRAY_N], c[ARRAY_N];
+    int16_t DWT_table[NTT_N - 1];
+    int16_t *table, *itable;
+    int16_t omega, zeta, scale;
+    size_t offsets[LOGNTT_N], len;
+
+    len = get_twiddle_layout_offsets(offsets, profile, layout);
+    table = malloc(len * sizeof(int16_t));
+    itable = malloc(len * sizeof(int16_t));
+
+    scale = 1;
+    zeta = OMEGA;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    gen_vec_DWT_table(table, &scale, &omega, &zeta, profile, layout, coeff_ring);
+    gen_DWT_table(DWT_table, &scale, &omega, &zeta, profile, coeff_ring);
+
+    zeta = OMEGA_INV;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    gen_vec_DWT_table(itable, &scale, &omega, &zeta, profile, layout, coeff_ring);
+
+    // The forward transformation agrees with CT_NTT.
+    memcpy(a, poly1, sizeof(a));
+    memcpy(c, poly1, sizeof(c));
+    vec_CT_NTT(a, table, profile, layout, coeff_ring);
+    CT_NTT(c, DWT_table, profile, coeff_ring);
+    assert(memcmp(a, c, sizeof(a)) == 0);
+
+    memcpy(b, poly2, sizeof(b));
+    vec_CT_NTT(b, table, profile, layout, coeff_ring);
+
+    point_mul(c, a, b, ARRAY_N, 1, coeff_ring);
+
+    vec_GS_iNTT(c, itable, profile, layout, coeff_ring);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        assert(c[i] == ref[i]);
+    }
+
+    free(table);
+    free(itable);
+
+}
+
+int main(void){
+
+    int16_t poly1[ARRAY_N], poly2[ARRAY_N], ref[ARRAY_N];
+    int16_t twiddle, scale, t;
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N
+    };
+
+    for(size_t i = 0; i < profile.compressed_layers; i++){
+        profile.merged_layers[i] = 1;
+    }
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+    }
+
+    // Compute the product in Z_Q[x] / (x^256 + 1) scaled by NTT_N.
+    twiddle = -1;
+    naive_mulR(ref, poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+    scale = NTT_N;
+    for(size_t i = 0; i < ARRAY_N; i++){
+        coeff_ring.mulZ(ref + i, ref + i, &scale);
+    }
+
+    struct twiddle_layout layout;
+
+    // 16 lanes of 16-bit integers as in AVX2.
+    gen_default_twiddle_layout(&layout, 16, 16, profile);
+    test_layout(poly1, poly2, ref, profile, layout);
+
+    // 8 lanes of 16-bit integers as in Neon.
+    gen_default_twiddle_layout(&layout, 8, 8, profile);
+    test_layout(poly1, poly2, ref, profile, layout);
+
+    // Broadcasts for the early layers and interleaving for the last layers without alignment.
+    layout.vec_n = 8;
+    layout.align = 1;
+    for(size_t i = 0; i < LOGNTT_N; i++){
+        layout.mode[i] = (((ARRAY_N) >> (i + 1)) >= 8) ? TWIDDLE_SCALAR : TWIDDLE_INTERLEAVE;
+    }
+    test_layout(poly1, poly2, ref, profile, layout);
+
+    // A broadcast for the last layer would span several blocks and is rejected.
+    layout.mode[LOGNTT_N - 1] = TWIDDLE_SCALAR;
+    assert(!check_twiddle_layout(profile, layout));
+    layout.mode[LOGNTT_N - 1] = TWIDDLE_REPLICATE;
+    assert(!check_twiddle_layout(profile, layout));
+
+    printf("Test finished!\n");
+
+}
+
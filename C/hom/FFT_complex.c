@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+#include <complex.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "ntt_c.h"
+#include "fft_c.h"
+
+// ================
+// This file demonstrates the complex floating-point FFT for Z_Q[x] / (x^1024 + 1) with
+// Q = 12289.
+
+// ================
+// Theory.
+// We regard the coefficients in [-Q / 2, Q / 2] as integers. The product in Z[x] / (x^1024 + 1)
+// has coefficients bounded by 1024 (Q / 2)^2 < 2^53, so we can compute it over the
+// complex numbers and round each coefficient to the nearest integer as long as the
+// accumulated rounding error is below 1 / 2.
+// Since x^1024 + 1 = (x^512 - i) (x^512 + i) and the factors are conjugate, the image of
+// a real polynomial in C[x] / (x^512 - i) determines the image in C[x] / (x^512 + i).
+// The map a_0 + ... + a_1023 x^1023 -> (a_0 + i a_512) + ... + (a_511 + i a_1023) x^511 is the
+// reduction modulo x^512 - i, which we call folding. We then split C[x] / (x^512 - i) with
+// a DWT of size 512 over the complex numbers.
+// See fft_c.h for the error bound.
+
+// ================
+// A small example.
+// For a_0 + a_1 x + a_2 x^2 + a_3 x^3 in Z[x] / (x^4 + 1), we have
+// (a_0 + i a_2) + (a_1 + i a_3) x in C[x] / (x^2 - i), and the DWT evaluates it at
+// x = exp(i pi / 4) and x = -exp(i pi / 4).
+
+// ================
+// Optimization guide.
+/*
+
+1. Folding halves the size of the transforms compared to embedding into C[x] / (x^1024 + 1).
+
+2. The conversions between integers and floating-point numbers are exact, and the scaling by
+   512^(-1) is exact since 512 is a power of two.
+
+3. The transform is vectorized with packed double-precision arithmetic.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// Falcon computes in Z_Q[x] / (x^n + 1) with the complex FFT.
+
+#define ARRAY_N 1024
+#define FFT_N 512
+#define LOGFFT_N 9
+
+#define Q (12289)
+
+// ================
+// Z_Q
+
+int32_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int32(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int32(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int32(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int32(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int32(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int32_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+// The complex numbers.
+
+struct ring complex_ring = {
+    .sizeZ = sizeof(double _Complex),
+    .memberZ = member_complex,
+    .addZ = add_complex,
+    .subZ = sub_complex,
+    .mulZ = mul_complex,
+    .expZ = exp_complex
+};
+
+// ================
+
+double _Complex FFT_table[FFT_N - 1], iFFT_table[FFT_N - 1];
+
+int main(void){
+
+    int32_t poly1[ARRAY_N], poly2[ARRAY_N];
+    int32_t ref[ARRAY_N], res[ARRAY_N];
+    double _Complex poly1_FFT[FFT_N], poly2_FFT[FFT_N], res_FFT[FFT_N];
+
+    int32_t twiddle, t;
+    double scale;
+
+    struct compress_profile profile = {
+        FFT_N, FFT_N, LOGFFT_N, LOGFFT_N, {1, 1, 1, 1, 1, 1, 1, 1, 1}
+    };
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+    }
+
+// ================
+// Compute the product in Z_Q[x] / (x^1024 + 1).
+
+    twiddle = -1;
+    naive_mulR(ref,
+        poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+
+// ================
+// Check that rounding recovers the exact product.
+// The coefficients of the inputs are bounded by Q / 2. For a 31-bit modulus, the bound fails
+// and the FFT must not be used.
+
+    assert(FFT_check_bound(ARRAY_N, Q / 2, Q / 2));
+    assert(!FFT_check_bound(ARRAY_N, 1 << 30, 1 << 30));
+
+// ================
+// Generate the tables of roots.
+
+    gen_FFT_table(FFT_table, false, profile);
+    gen_FFT_table(iFFT_table, true, profile);
+
+// ================
+// Fold to C[x] / (x^512 - i) and apply the FFT.
+
+    FFT_fold_int32(poly1_FFT, poly1, ARRAY_N);
+    FFT_fold_int32(poly2_FFT, poly2, ARRAY_N);
+
+    CT_NTT(poly1_FFT, FFT_table, profile, complex_ring);
+    CT_NTT(poly2_FFT, FFT_table, profile, complex_ring);
+
+// ================
+
+    point_mul(res_FFT, poly1_FFT, poly2_FFT, FFT_N, 1, complex_ring);
+
+// ================
+// Apply the inverse, unfold, and round back to Z_Q.
+
+    GS_iNTT(res_FFT, iFFT_table, profile, complex_ring);
+
+    scale = 1.0 / FFT_N;
+    FFT_unfold_int32(res, res_FFT, ARRAY_N, &scale, &mod);
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        assert(ref[i] == res[i]);
+    }
+
+    printf("Test finished!\n");
+
+}
+
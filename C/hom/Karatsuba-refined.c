@@ -0,0 +1,371 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+
+// ================
+// This file demonstrates refined Karatsuba, recursive and with striding.
+// We compute the products of two size-256 polynomials in Z_{2^32}[x] and
+// Z_{2^32}[x] / (x^256 + 1), and count the additions and multiplications in Z_{2^32}.
+
+// ================
+// Theory.
+// Let n = 2 h. Karatsuba computes (A0 + A1 t) (B0 + B1 t) for t = x^h from
+// L = A0 B0, H = A1 B1, and M = (A0 + A1) (B0 + B1) as
+//     L + (M - L - H) t + H t^2.
+// Refined Karatsuba rewrites this as
+//     (1 - t) (L - t H) + t M.
+// Write L = L0 + L1 t and H = H0 + H1 t with size-h blocks. The blocks of the result are
+//     L0, M0 - L0 + (L1 - H0), M1 - H1 - (L1 - H0), H1,
+// where the difference D = L1 - H0 is shared between the two middle blocks.
+// Per level, the interpolation costs h + 2 h + 2 (h - 1) = 5 h - 2 additions instead of
+// 3 (2 h - 1) = 6 h - 3 for subtracting L and H from M and adding the overlaps.
+
+// ================
+// A small example.
+// Let n = 4. The products L = l0 + l1 x + l2 x^2, H = h0 + h1 x + h2 x^2, and M = m0 + m1 x + m2 x^2
+// give D = (l2 - h0, -h1) and the result
+//     l0, l1, m0 - l0 + (l2 - h0), m1 - l1 - h1, m2 - h2 - (l2 - h0), h1, h2.
+
+// ================
+// Optimization guide.
+/*
+
+1. Once the base case is vectorized, the additions of the interpolation dominate the cost of
+   the upper layers. Refined Karatsuba saves h - 1 additions per product of size 2 h.
+
+2. With striding, the coefficients are polynomials in R[y] / (y^m + 1) and each addition
+   costs m additions in R. The savings scale accordingly.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+
+// ARRAY_N / THRESHOLD must be a power of two.
+#define ARRAY_N 256
+#define THRESHOLD 16
+
+// ================
+// Z_{2^32} with operation counts.
+
+size_t add_count, mul_count;
+
+void memberZ(void *des, const void *src){
+    *(int32_t*)des = *(int32_t*)src;
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    add_count++;
+    *(int32_t*)des = (*(int32_t*)src1) + (*(int32_t*)src2);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    add_count++;
+    *(int32_t*)des = (*(int32_t*)src1) - (*(int32_t*)src2);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mul_count++;
+    *(int32_t*)des = (*(int32_t*)src1) * (*(int32_t*)src2);
+}
+
+void expZ(void *des, const void *src, size_t e){
+
+    int32_t src_v = *(int32_t*)src;
+    int32_t tmp_v;
+
+    tmp_v = 1;
+    for(; e; e >>= 1){
+        if(e & 1){
+            tmp_v = tmp_v * src_v;
+        }
+        src_v = src_v * src_v;
+    }
+
+    memmove(des, &tmp_v, sizeof(int32_t));
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int32_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+// Z_{2^32}[y] / (y^STRIDE_M + 1) for striding.
+
+// STRIDE_M = ARRAY_N / K where K is the number of strided polynomials.
+size_t STRIDE_M;
+
+void poly_memberZ(void *des, const void *src){
+    memmove(des, src, STRIDE_M * sizeof(int32_t));
+}
+
+void poly_addZ(void *des, const void *src1, const void *src2){
+    for(size_t i = 0; i < STRIDE_M; i++){
+        coeff_ring.addZ((int32_t*)des + i, (int32_t*)src1 + i, (int32_t*)src2 + i);
+    }
+}
+
+void poly_subZ(void *des, const void *src1, const void *src2){
+    for(size_t i = 0; i < STRIDE_M; i++){
+        coeff_ring.subZ((int32_t*)des + i, (int32_t*)src1 + i, (int32_t*)src2 + i);
+    }
+}
+
+void poly_mulZ(void *des, const void *src1, const void *src2){
+    const int32_t twiddle = -1;
+    naive_mulR(des, src1, src2, STRIDE_M, &twiddle, coeff_ring);
+}
+
+void poly_expZ(void *des, const void *src, size_t e){
+    (void)des;
+    (void)src;
+    (void)e;
+    assert(0);
+}
+
+// The size of an element is set when STRIDE_M is chosen.
+struct ring poly_ring = {
+    .memberZ = poly_memberZ,
+    .addZ = poly_addZ,
+    .subZ = poly_subZ,
+    .mulZ = poly_mulZ,
+    .expZ = poly_expZ
+};
+
+// ================
+// Karatsuba as in Karatsuba.c.
+
+// len must be even.
+static
+void karatsuba_eval(void *des, const void *src, size_t len, struct ring ring){
+
+    for(size_t i = 0; i < (len / 2); i++){
+        ring.addZ(des + i * ring.sizeZ, src + i * ring.sizeZ, src + ((len / 2) + i) * ring.sizeZ);
+    }
+
+}
+
+// len must be even.
+static
+void karatsuba_interpol(void *des, void *src, size_t len, struct ring ring){
+
+    // Interpolation.
+    for(size_t i = 0; i < len - 1; i++){
+        ring.subZ(src + i * ring.sizeZ, src + i * ring.sizeZ, des + i * ring.sizeZ);
+        ring.subZ(src + i * ring.sizeZ, src + i * ring.sizeZ, des + (len + i) * ring.sizeZ);
+    }
+
+    // Sum up the overlapped parts.
+    for(size_t i = 0; i < len - 1; i++){
+        ring.addZ(des + ((len / 2) + i) * ring.sizeZ, des + ((len / 2) + i) * ring.sizeZ, src + i * ring.sizeZ);
+    }
+
+}
+
+// threshold | len,
+// len / threshold must be a power of two.
+static
+void karatsuba_recur(void *des, const void *src1, const void *src2, size_t len, size_t threshold, struct ring ring){
+
+    if(len <= threshold){
+        naive_mul_long(des, src1, src2, len, ring);
+        return;
+    }
+
+    char src1mid[(len / 2) * ring.sizeZ], src2mid[(len / 2) * ring.sizeZ];
+    char desmid[(len - 1) * ring.sizeZ];
+
+    karatsuba_eval(src1mid, src1, len, ring);
+    karatsuba_eval(src2mid, src2, len, ring);
+
+    memset(des, 0, (2 * len - 1) * ring.sizeZ);
+
+    karatsuba_recur(des, src1, src2, len / 2, threshold, ring);
+    karatsuba_recur(des + len * ring.sizeZ, src1 + (len / 2) * ring.sizeZ, src2 + (len / 2) * ring.sizeZ, len / 2, threshold, ring);
+    karatsuba_recur(desmid, src1mid, src2mid, len / 2, threshold, ring);
+
+    karatsuba_interpol(des, desmid, len, ring);
+
+}
+
+// ================
+// Refined Karatsuba.
+
+// len must be even.
+// des holds L at [0, len - 1), zero at len - 1, and H at [len, 2 len - 1).
+// src holds M with len - 1 coefficients.
+// With h = len / 2, this function computes the blocks
+// [h, 2 h) = M0 - L0 + D and [2 h, 3 h) = M1 - H1 - D where D = L1 - H0.
+static
+void refined_karatsuba_interpol(void *des, const void *src, size_t len, struct ring ring){
+
+    size_t h = len / 2;
+    char D[ring.sizeZ];
+
+    for(size_t i = 0; i < h; i++){
+        // D = L1 - H0.
+        ring.subZ(D, des + (h + i) * ring.sizeZ, des + (2 * h + i) * ring.sizeZ);
+        // The (h + i)-th coefficient: M0 - L0 + D.
+        ring.subZ(des + (h + i) * ring.sizeZ, src + i * ring.sizeZ, des + i * ring.sizeZ);
+        ring.addZ(des + (h + i) * ring.sizeZ, des + (h + i) * ring.sizeZ, D);
+        // The (2 h + i)-th coefficient: M1 - H1 - D.
+        // For i = h - 1, M1 and H1 vanish and the coefficient H0 = -D is already in place.
+        if(i < h - 1){
+            ring.subZ(des + (2 * h + i) * ring.sizeZ, src + (h + i) * ring.sizeZ, des + (3 * h + i) * ring.sizeZ);
+            ring.subZ(des + (2 * h + i) * ring.sizeZ, des + (2 * h + i) * ring.sizeZ, D);
+        }
+    }
+
+}
+
+// threshold | len,
+// len / threshold must be a power of two.
+static
+void refined_karatsuba_recur(void *des, const void *src1, const void *src2, size_t len, size_t threshold, struct ring ring){
+
+    if(len <= threshold){
+        naive_mul_long(des, src1, src2, len, ring);
+        return;
+    }
+
+    char src1mid[(len / 2) * ring.sizeZ], src2mid[(len / 2) * ring.sizeZ];
+    char desmid[(len - 1) * ring.sizeZ];
+
+    karatsuba_eval(src1mid, src1, len, ring);
+    karatsuba_eval(src2mid, src2, len, ring);
+
+    // L and H cover the output except the (len - 1)-th coefficient.
+    refined_karatsuba_recur(des, src1, src2, len / 2, threshold, ring);
+    memset(des + (len - 1) * ring.sizeZ, 0, ring.sizeZ);
+    refined_karatsuba_recur(des + len * ring.sizeZ, src1 + (len / 2) * ring.sizeZ, src2 + (len / 2) * ring.sizeZ, len / 2, threshold, ring);
+    refined_karatsuba_recur(desmid, src1mid, src2mid, len / 2, threshold, ring);
+
+    refined_karatsuba_interpol(des, desmid, len, ring);
+
+}
+
+// ================
+// Striding followed by (refined) Karatsuba.
+
+// Multiply two size-len polynomials in Z_{2^32}[x] / (x^len + 1) via
+// (Z_{2^32}[y] / (y^(len / K) + 1))[x] / (x^K - y)
+// and (refined) Karatsuba in x over Z_{2^32}[y] / (y^(len / K) + 1) down to size 1.
+// K must be a power of two dividing len.
+static
+void negacyclic_Karatsuba_striding(int32_t *des, const int32_t *src1, const int32_t *src2, size_t len, size_t K, int refined){
+
+    size_t m = len / K;
+    int32_t src1_strided[K][m], src2_strided[K][m];
+    int32_t res[2 * K - 1][m];
+
+    STRIDE_M = m;
+    poly_ring.sizeZ = m * sizeof(int32_t);
+
+    for(size_t t = 0; t < K; t++){
+        for(size_t i = 0; i < m; i++){
+            src1_strided[t][i] = src1[K * i + t];
+            src2_strided[t][i] = src2[K * i + t];
+        }
+    }
+
+    if(refined){
+        refined_karatsuba_recur(res, src1_strided, src2_strided, K, 1, poly_ring);
+    }else{
+        karatsuba_recur(res, src1_strided, src2_strided, K, 1, poly_ring);
+    }
+
+    // Reduce x^K = y and unstride: the s-th coefficient is res[s] + y res[s + K].
+    for(size_t s = 0; s < K; s++){
+        for(size_t i = 0; i < m; i++){
+            des[K * i + s] = res[s][i];
+        }
+        if(s + K < 2 * K - 1){
+            coeff_ring.subZ(des + s, des + s, &res[s + K][m - 1]);
+            for(size_t i = 1; i < m; i++){
+                coeff_ring.addZ(des + K * i + s, des + K * i + s, &res[s + K][i - 1]);
+            }
+        }
+    }
+
+}
+
+int main(void){
+
+    int32_t poly1[ARRAY_N], poly2[ARRAY_N];
+    int32_t ref[2 * ARRAY_N], res[2 * ARRAY_N];
+    size_t adds[2], muls[2];
+
+    const int32_t twiddle = -1;
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        poly1[i] = rand();
+        poly2[i] = rand();
+    }
+
+    // Compute the product in Z_{2^32}[x].
+    naive_mul_long(ref, poly1, poly2, ARRAY_N, coeff_ring);
+
+    for(size_t refined = 0; refined < 2; refined++){
+
+        add_count = mul_count = 0;
+        if(refined){
+            refined_karatsuba_recur(res, poly1, poly2, ARRAY_N, THRESHOLD, coeff_ring);
+        }else{
+            karatsuba_recur(res, poly1, poly2, ARRAY_N, THRESHOLD, coeff_ring);
+        }
+        adds[refined] = add_count;
+        muls[refined] = mul_count;
+
+        for(size_t i = 0; i < 2 * ARRAY_N - 1; i++){
+            assert(ref[i] == res[i]);
+        }
+
+    }
+
+    printf("recursive Karatsuba, size %d, threshold %d:\n", ARRAY_N, THRESHOLD);
+    printf("    standard: %zu additions, %zu multiplications\n", adds[0], muls[0]);
+    printf("    refined:  %zu additions, %zu multiplications\n", adds[1], muls[1]);
+    assert(adds[1] < adds[0]);
+    assert(muls[1] == muls[0]);
+
+    // Compute the product in Z_{2^32}[x] / (x^ARRAY_N + 1).
+    naive_mulR(ref, poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+
+    for(size_t K = 4; K <= 16; K *= 2){
+
+        for(size_t refined = 0; refined < 2; refined++){
+
+            add_count = mul_count = 0;
+            negacyclic_Karatsuba_striding(res, poly1, poly2, ARRAY_N, K, refined);
+            adds[refined] = add_count;
+            muls[refined] = mul_count;
+
+            for(size_t i = 0; i < ARRAY_N; i++){
+                assert(ref[i] == res[i]);
+            }
+
+        }
+
+        printf("striding by %zu with Karatsuba, size %d:\n", K, ARRAY_N);
+        printf("    standard: %zu additions, %zu multiplications\n", adds[0], muls[0]);
+        printf("    refined:  %zu additions, %zu multiplications\n", adds[1], muls[1]);
+        assert(adds[1] < adds[0]);
+        assert(muls[1] == muls[0]);
+
+    }
+
+    printf("Test finished!\n");
+
+}
+
@@ -9,12 +9,24 @@
 #include "tools.h"
 #include "naive_mult.h"
 
+// The header is generated at build time by gen_Karatsuba_striding (see Makefile).
+#include "Karatsuba_striding_kernels.h"
+
 // ================
 // This file demonstrates 2-layer Karatsuba with symmetric inputs.
 // We compute the product of two size-256 polynomials in Z_{2^32}[x].
 
 // ================
 // Optimization guide.
+/*
+
+1. The kernel below is hand-written for 2 layers. gen_Karatsuba_striding emits the analogous
+   kernels for 1 to 4 layers, cyclic and negacyclic, with the same load/cache schedule.
+   Each additional layer trades a product of size len / K for three of size len / (2 K), but
+   the evaluation keeps 3^k values in registers. Benchmark the generated kernels for the target
+   register count and len.
+
+*/
 
 // ================
 // Applications to lattice-based cryptosystems.
@@ -219,6 +231,34 @@ int main(void){
         assert(ref[i] == res[i]);
     }
 
+    // The generated kernels for 1 to 4 layers.
+    void (*negacyclic_kernels[4])(int32_t*, const int32_t*, const int32_t*, size_t) = {
+        GEN_negacyclic_1_layer_Karatsuba_striding, GEN_negacyclic_2_layer_Karatsuba_striding,
+        GEN_negacyclic_3_layer_Karatsuba_striding, GEN_negacyclic_4_layer_Karatsuba_striding
+    };
+    void (*cyclic_kernels[4])(int32_t*, const int32_t*, const int32_t*, size_t) = {
+        GEN_cyclic_1_layer_Karatsuba_striding, GEN_cyclic_2_layer_Karatsuba_striding,
+        GEN_cyclic_3_layer_Karatsuba_striding, GEN_cyclic_4_layer_Karatsuba_striding
+    };
+
+    for(size_t k = 0; k < 4; k++){
+        negacyclic_kernels[k](res, poly1, poly2, ARRAY_N);
+        for(size_t i = 0; i < ARRAY_N; i++){
+            assert(ref[i] == res[i]);
+        }
+    }
+
+    twiddle = 1;
+    // Compute the product in Z_{2^32}[x] / (x^ARRAY_N - 1).
+    naive_mulR(ref, poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+
+    for(size_t k = 0; k < 4; k++){
+        cyclic_kernels[k](res, poly1, poly2, ARRAY_N);
+        for(size_t i = 0; i < ARRAY_N; i++){
+            assert(ref[i] == res[i]);
+        }
+    }
+
     printf("Test finished!\n");
 
 
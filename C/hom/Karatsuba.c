@@ -90,6 +90,18 @@
 1. For the recursive Karatsuba,
    instead of computing one layer at a time, try to compute multiple layers at once and save memory operations.
 
+2. Avoid allocating buffers at each level of the recursion. The buffers of the levels are nested,
+   so their total size is sum_{len > threshold} (2 len - 1) < 4 n elements and can be computed up front
+   (karatsuba_arena_size). The caller supplies one workspace, for example per worker thread,
+   and the recursion only moves a pointer (karatsuba_arena).
+   Furthermore, the products at the points 0 and \infty cover the output except one coefficient,
+   so there is no need to clear the entire output at each level.
+
+3. For lengths that are not of the form threshold 2^k, do not pad to the next power of two.
+   Split a size-n input unevenly into ceil(n / 2) and floor(n / 2) coefficients
+   (karatsuba_arena). For unbalanced products, cut the longer operand into chunks of the size
+   of the shorter one (karatsuba_unbalanced).
+
 */
 
 // ================
@@ -97,6 +109,8 @@
 
 // ARRAY_N must be even.
 #define ARRAY_N 96
+// The size for karatsuba_arena with the heap-allocated arena.
+#define ARRAY_N_LARGE 4096
 
 // ================
 // Z_{2^32}
@@ -204,6 +218,161 @@ void karatsuba_recur(void *des, void *src1, void *src2, size_t len, size_t thres
 
 }
 
+// Scratch size in bytes of karatsuba_arena for size-len inputs.
+// Each level with len > threshold and h = ceil(len / 2) requires src1mid, src2mid, and desmid of
+// h + h + (2 h - 1) elements, and the levels are nested.
+static
+size_t karatsuba_arena_size(size_t len, size_t threshold, struct ring ring){
+
+    size_t size = 0;
+
+    for(; len > threshold; len = (len + 1) / 2){
+        size += (4 * ((len + 1) / 2) - 1) * ring.sizeZ;
+    }
+
+    return size;
+
+}
+
+// des must not overlap with src1 and src2.
+// This function clears des and writes the size-(2 len - 1) product of the naive long
+// multiplication directly there, without the buffer of naive_mul_long.
+static
+void naive_mul_long_nobuff(void *des, const void *src1, const void *src2, size_t len, struct ring ring){
+
+    char tmp[ring.sizeZ];
+
+    memset(des, 0, (2 * len - 1) * ring.sizeZ);
+
+    for(size_t i = 0; i < len; i++){
+        for(size_t j = 0; j < len; j++){
+            ring.mulZ(tmp, src1 + i * ring.sizeZ, src2 + j * ring.sizeZ);
+            ring.addZ(des + (i + j) * ring.sizeZ, des + (i + j) * ring.sizeZ, tmp);
+        }
+    }
+
+}
+
+// threshold must be positive, and len is arbitrary.
+// des must not overlap with src1 and src2.
+// This function computes the same as karatsuba_recur without any allocation.
+// The buffers of all the levels are carved from arena, which must hold
+// karatsuba_arena_size(len, threshold, ring) bytes. Each level only clears the coefficient
+// not covered by the products at the points 0 and \infty.
+// For an odd len, the inputs are split unevenly into the low h = (len + 1) / 2 and
+// the high len - h coefficients. The missing top coefficient of the high part is
+// treated as zero in the evaluation at 1, so no padding is needed.
+static
+void karatsuba_arena(void *des, void *src1, void *src2, size_t len, size_t threshold, void *arena, struct ring ring){
+
+    if(len <= threshold){
+        naive_mul_long_nobuff(des, src1, src2, len, ring);
+        return;
+    }
+
+    size_t h = (len + 1) / 2;
+    size_t l = len - h;
+
+    void *src1mid = arena;
+    void *src2mid = src1mid + h * ring.sizeZ;
+    void *desmid = src2mid + h * ring.sizeZ;
+    void *next = desmid + (2 * h - 1) * ring.sizeZ;
+
+    // Evaluating half-size polynomials at 1.
+    for(size_t i = 0; i < l; i++){
+        ring.addZ(src1mid + i * ring.sizeZ, src1 + i * ring.sizeZ, src1 + (h + i) * ring.sizeZ);
+        ring.addZ(src2mid + i * ring.sizeZ, src2 + i * ring.sizeZ, src2 + (h + i) * ring.sizeZ);
+    }
+    if(l < h){
+        memcpy(src1mid + l * ring.sizeZ, src1 + l * ring.sizeZ, ring.sizeZ);
+        memcpy(src2mid + l * ring.sizeZ, src2 + l * ring.sizeZ, ring.sizeZ);
+    }
+
+    // Karatsuba for the point 0.
+    karatsuba_arena(des, src1, src2, h, threshold, next, ring);
+    // The (2 h - 1)-th coefficient lies between the products at the points 0 and \infty.
+    memset(des + (2 * h - 1) * ring.sizeZ, 0, ring.sizeZ);
+    // Karatsuba for the point \infty.
+    karatsuba_arena(des + 2 * h * ring.sizeZ, src1 + h * ring.sizeZ, src2 + h * ring.sizeZ, l, threshold, next, ring);
+    // Karatsuba for the point 1.
+    karatsuba_arena(desmid, src1mid, src2mid, h, threshold, next, ring);
+
+    // Interpolation.
+    for(size_t i = 0; i < 2 * h - 1; i++){
+        ring.subZ(desmid + i * ring.sizeZ, desmid + i * ring.sizeZ, des + i * ring.sizeZ);
+    }
+    for(size_t i = 0; i < 2 * l - 1; i++){
+        ring.subZ(desmid + i * ring.sizeZ, desmid + i * ring.sizeZ, des + (2 * h + i) * ring.sizeZ);
+    }
+
+    // Sum up the overlapped parts.
+    for(size_t i = 0; i < 2 * h - 1; i++){
+        ring.addZ(des + (h + i) * ring.sizeZ, des + (h + i) * ring.sizeZ, desmid + i * ring.sizeZ);
+    }
+
+}
+
+// Scratch size in bytes of karatsuba_unbalanced for inputs of sizes len1 and len2.
+static
+size_t karatsuba_unbalanced_arena_size(size_t len1, size_t len2, size_t threshold, struct ring ring){
+
+    size_t size, size_r, r;
+
+    if(len1 < len2){
+        return karatsuba_unbalanced_arena_size(len2, len1, threshold, ring);
+    }
+
+    size = (2 * len2 - 1) * ring.sizeZ + karatsuba_arena_size(len2, threshold, ring);
+
+    r = len1 % len2;
+    if(r){
+        size_r = (len2 + r - 1) * ring.sizeZ + karatsuba_unbalanced_arena_size(len2, r, threshold, ring);
+        size = (size_r > size) ? size_r : size;
+    }
+
+    return size;
+
+}
+
+// Multiply the size-len1 polynomial src1 and the size-len2 polynomial src2 with len1, len2 > 0.
+// The result consists of len1 + len2 - 1 coefficients.
+// des must not overlap with src1 and src2, and arena must hold
+// karatsuba_unbalanced_arena_size(len1, len2, threshold, ring) bytes.
+// The longer operand is cut into chunks of the size of the shorter one. Each chunk is
+// multiplied with karatsuba_arena and the products are summed up with the overlaps.
+// The remaining shorter chunk is multiplied recursively with the roles of the operands swapped.
+static
+void karatsuba_unbalanced(void *des, void *src1, size_t len1, void *src2, size_t len2, size_t threshold, void *arena, struct ring ring){
+
+    if(len1 < len2){
+        karatsuba_unbalanced(des, src2, len2, src1, len1, threshold, arena, ring);
+        return;
+    }
+
+    size_t q = len1 / len2;
+    size_t r = len1 % len2;
+    void *prod = arena;
+    void *next = prod + (2 * len2 - 1) * ring.sizeZ;
+
+    memset(des, 0, (len1 + len2 - 1) * ring.sizeZ);
+
+    for(size_t c = 0; c < q; c++){
+        karatsuba_arena(prod, src1 + c * len2 * ring.sizeZ, src2, len2, threshold, next, ring);
+        for(size_t i = 0; i < 2 * len2 - 1; i++){
+            ring.addZ(des + (c * len2 + i) * ring.sizeZ, des + (c * len2 + i) * ring.sizeZ, prod + i * ring.sizeZ);
+        }
+    }
+
+    if(r){
+        next = prod + (len2 + r - 1) * ring.sizeZ;
+        karatsuba_unbalanced(prod, src2, len2, src1 + q * len2 * ring.sizeZ, r, threshold, next, ring);
+        for(size_t i = 0; i < len2 + r - 1; i++){
+            ring.addZ(des + (q * len2 + i) * ring.sizeZ, des + (q * len2 + i) * ring.sizeZ, prod + i * ring.sizeZ);
+        }
+    }
+
+}
+
 int main(void){
 
     int32_t src1[ARRAY_N], src2[ARRAY_N];
@@ -224,6 +393,93 @@ int main(void){
         assert(ref[i] == res[i]);
     }
 
+    // Apply Karatsuba with a caller-supplied arena.
+    char arena[karatsuba_arena_size(ARRAY_N, 6, coeff_ring)];
+
+    karatsuba_arena(res, src1, src2, ARRAY_N, 6, arena, coeff_ring);
+
+    for(size_t i = 0; i < 2 * ARRAY_N - 1; i++){
+        assert(ref[i] == res[i]);
+    }
+
+    // For large sizes, the arena is allocated once on the heap and
+    // the stack usage is independent of the size.
+    int32_t *big1 = malloc(ARRAY_N_LARGE * sizeof(int32_t));
+    int32_t *big2 = malloc(ARRAY_N_LARGE * sizeof(int32_t));
+    int32_t *big_ref = malloc((2 * ARRAY_N_LARGE - 1) * sizeof(int32_t));
+    int32_t *big_res = malloc((2 * ARRAY_N_LARGE - 1) * sizeof(int32_t));
+    void *big_arena = malloc(karatsuba_arena_size(ARRAY_N_LARGE, 16, coeff_ring));
+
+    for(size_t i = 0; i < ARRAY_N_LARGE; i++){
+        big1[i] = rand();
+        big2[i] = rand();
+    }
+
+    // The reference is computed with naive_mul_long, independent of the leaf routine of karatsuba_arena.
+    naive_mul_long(big_ref, big1, big2, ARRAY_N_LARGE, coeff_ring);
+    karatsuba_arena(big_res, big1, big2, ARRAY_N_LARGE, 16, big_arena, coeff_ring);
+
+    for(size_t i = 0; i < 2 * ARRAY_N_LARGE - 1; i++){
+        assert(big_ref[i] == big_res[i]);
+    }
+
+    free(big1);
+    free(big2);
+    free(big_ref);
+    free(big_res);
+    free(big_arena);
+
+    // Odd lengths with uneven splitting.
+    size_t lens[4] = {509, 677, 761, 821};
+    int32_t odd1[821], odd2[821], odd_ref[2 * 821], odd_res[2 * 821];
+
+    for(size_t k = 0; k < 4; k++){
+
+        for(size_t i = 0; i < lens[k]; i++){
+            odd1[i] = rand();
+            odd2[i] = rand();
+        }
+
+        naive_mul_long(odd_ref, odd1, odd2, lens[k], coeff_ring);
+
+        char odd_arena[karatsuba_arena_size(lens[k], 16, coeff_ring)];
+        karatsuba_arena(odd_res, odd1, odd2, lens[k], 16, odd_arena, coeff_ring);
+
+        for(size_t i = 0; i < 2 * lens[k] - 1; i++){
+            assert(odd_ref[i] == odd_res[i]);
+        }
+
+    }
+
+    // Unbalanced lengths by chunking the longer operand.
+    // The reference is the product with the shorter operand padded with zeros.
+    size_t unbalanced_lens[4][2] = {{761, 509}, {509, 821}, {821, 96}, {677, 1}};
+
+    for(size_t k = 0; k < 4; k++){
+
+        size_t len1 = unbalanced_lens[k][0], len2 = unbalanced_lens[k][1];
+        size_t len_max = (len1 > len2) ? len1 : len2;
+
+        memset(odd1, 0, sizeof(odd1));
+        memset(odd2, 0, sizeof(odd2));
+        for(size_t i = 0; i < len1; i++){
+            odd1[i] = rand();
+        }
+        for(size_t i = 0; i < len2; i++){
+            odd2[i] = rand();
+        }
+
+        naive_mul_long(odd_ref, odd1, odd2, len_max, coeff_ring);
+
+        char unbalanced_arena[karatsuba_unbalanced_arena_size(len1, len2, 16, coeff_ring)];
+        karatsuba_unbalanced(odd_res, odd1, len1, odd2, len2, 16, unbalanced_arena, coeff_ring);
+
+        for(size_t i = 0; i < len1 + len2 - 1; i++){
+            assert(odd_ref[i] == odd_res[i]);
+        }
+
+    }
+
     printf("Test finished!\n");
 
 }
@@ -0,0 +1,344 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+#include "table_store.h"
+#include "rns.h"
+
+// ================
+// This file demonstrates the residue number system (RNS) for Z_Q[x] / (x^1024 + 1)
+// where Q is a product of four 50-bit NTT-friendly primes.
+
+// ================
+// Theory.
+// Let Q = q_0 q_1 ... q_{k - 1} with distinct primes q_i = 1 mod 2n. The Chinese remainder theorem gives
+// Z_Q[x] / (x^n + 1) \cong prod_i Z_{q_i}[x] / (x^n + 1),
+// and each component admits a size-n negacyclic NTT. A multi-precision coefficient x in [0, Q)
+// is replaced by its residues x_i = x mod q_i, the polynomials are multiplied independently
+// for each prime with word-size arithmetic, and the product is recovered with
+// x = sum_i ((x_i (Q / q_i)^(-1)) mod q_i) (Q / q_i) mod Q.
+// Homomorphic encryption rarely reconstructs x. Instead, it switches the residues to another
+// set of primes p_j (base conversion). With y_i = (x_i (Q / q_i)^(-1)) mod q_i, we have
+// x = sum_i y_i (Q / q_i) - v Q
+// for an integer v. For the signed representative x in [-Q / 2, Q / 2), v = round(sum_i y_i / q_i),
+// which is computed in floating-point arithmetic, and x mod p_j follows without any
+// multi-precision arithmetic.
+
+// ================
+// A small example.
+// Let Q = 7 * 11 = 77 and x = -5. We have (x_0, x_1) = (2, 6), Q / q_0 = 11, Q / q_1 = 7,
+// y_0 = 2 * 11^(-1) mod 7 = 2 * 2 = 4, and y_1 = 6 * 7^(-1) mod 11 = 6 * 8 mod 11 = 4.
+// Then v = round(4 / 7 + 4 / 11) = round(0.935) = 1 and
+// x = 4 * 11 + 4 * 7 - 77 = -5.
+// Converting to p = 13 gives (4 * 11 + 4 * 7 - 77) mod 13 = 8 = -5 mod 13.
+
+// ================
+// Optimization guide.
+/*
+
+1. The primes are independent. Batch them in one loop so that the tables of a prime stay in
+   cache, and parallelize the loop over primes across threads (OpenMP in rns.c).
+
+2. Keep the residues in [0, q_i) between the operations so that Harvey's lazy butterflies
+   apply without an extra reduction pass.
+
+3. Precompute (Q / q_i)^(-1) with Shoup's precomputation, and (Q / q_i) mod p_j and Q mod p_j
+   once per target prime.
+
+4. Generating the tables dominates the setup for many primes. Store them once with
+   table_store_write and map them with RNS_init_from_store so that the processes share one
+   read-only copy and start without generation.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// The RNS variants of BFV and CKKS represent ciphertext moduli of hundreds of bits as
+// products of word-size primes, and base conversion implements modulus switching,
+// rescaling, and key switching.
+
+#define ARRAY_N 1024
+#define NTT_N 1024
+#define LOGNTT_N 10
+
+// The number of primes and their sizes.
+#define RNS_LEN 4
+#define RNS_BITS 50
+#define RNS_TO_LEN 2
+#define RNS_TO_BITS 40
+
+// ================
+// Z_{q_i} with signed arithmetic for the reference. mod64 is set to each prime in turn.
+
+int64_t mod64;
+
+void memberZ(void *des, const void *src){
+    cmod_int64(des, src, &mod64);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int128(des, src1, src2, &mod64);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int128(des, src1, src2, &mod64);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int64(des, src1, src2, &mod64);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int64(des, src, e, &mod64);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int64_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// Returns a random 64-bit integer.
+static
+uint64_t rand64(void){
+    return ((uint64_t)rand() << 62) ^ ((uint64_t)rand() << 31) ^ (uint64_t)rand();
+}
+
+// Returns a mod p in [0, p) for the signed a.
+static
+uint64_t signed_mod(int64_t a, uint64_t p){
+    int64_t t = a % (int64_t)p;
+    return (uint64_t)(t < 0 ? t + (int64_t)p : t);
+}
+
+static
+void test_mul(const struct RNS_plan *plan){
+
+    uint64_t *poly1, *poly2, *res;
+    int64_t ref1[ARRAY_N], ref2[ARRAY_N], ref[ARRAY_N], twiddle;
+
+    poly1 = malloc(RNS_LEN * ARRAY_N * sizeof(uint64_t));
+    poly2 = malloc(RNS_LEN * ARRAY_N * sizeof(uint64_t));
+    res = malloc(RNS_LEN * ARRAY_N * sizeof(uint64_t));
+
+    for(size_t i = 0; i < RNS_LEN * ARRAY_N; i++){
+        poly1[i] = rand64() % plan->mods[i / ARRAY_N];
+        poly2[i] = rand64() % plan->mods[i / ARRAY_N];
+    }
+
+    RNS_NTT(poly1, plan);
+    RNS_NTT(poly2, plan);
+    RNS_point_mul(res, poly1, poly2, plan);
+    RNS_iNTT(res, plan);
+    RNS_iNTT(poly1, plan);
+    RNS_iNTT(poly2, plan);
+
+    // Compare each component with the product in Z_{q_i}[x] / (x^1024 + 1).
+    for(size_t i = 0; i < RNS_LEN; i++){
+        mod64 = (int64_t)plan->mods[i];
+        for(size_t j = 0; j < ARRAY_N; j++){
+            coeff_ring.memberZ(ref1 + j, poly1 + i * ARRAY_N + j);
+            coeff_ring.memberZ(ref2 + j, poly2 + i * ARRAY_N + j);
+        }
+        twiddle = -1;
+        naive_mulR(ref, ref1, ref2, ARRAY_N, &twiddle, coeff_ring);
+        for(size_t j = 0; j < ARRAY_N; j++){
+            assert(signed_mod(ref[j], plan->mods[i]) == res[i * ARRAY_N + j]);
+        }
+    }
+
+    free(poly1);
+    free(poly2);
+    free(res);
+
+}
+
+static
+void test_CRT(const struct RNS_plan *plan){
+
+    size_t limbs = plan->limbs;
+    uint32_t *big, *res;
+    uint64_t *residue;
+
+    big = calloc(ARRAY_N * limbs, sizeof(uint32_t));
+    res = malloc(ARRAY_N * limbs * sizeof(uint32_t));
+    residue = malloc(RNS_LEN * ARRAY_N * sizeof(uint64_t));
+
+    // Random integers below 2^(4 (RNS_BITS - 1)) < Q.
+    for(size_t j = 0; j < ARRAY_N; j++){
+        for(size_t k = 0; k < 6; k++){
+            big[j * limbs + k] = (uint32_t)rand64();
+        }
+        big[j * limbs + 6] = (uint32_t)rand64() & 0xf;
+    }
+
+    RNS_decompose(residue, big, plan);
+    RNS_reconstruct(res, residue, plan);
+
+    assert(memcmp(big, res, ARRAY_N * limbs * sizeof(uint32_t)) == 0);
+
+    free(big);
+    free(res);
+    free(residue);
+
+}
+
+static
+void test_base_convert(const struct RNS_plan *plan){
+
+    uint64_t mods_to[RNS_TO_LEN];
+    uint64_t *residue, *res;
+    int64_t a[ARRAY_N], b[ARRAY_N];
+    uint64_t p, t;
+
+    t = RNS_gen_primes(mods_to, RNS_TO_LEN, RNS_TO_BITS, 2 * NTT_N);
+    assert(t == RNS_TO_LEN);
+
+    residue = malloc(RNS_LEN * ARRAY_N * sizeof(uint64_t));
+    res = malloc(RNS_TO_LEN * ARRAY_N * sizeof(uint64_t));
+
+    // Signed 126-bit values x = a b.
+    for(size_t j = 0; j < ARRAY_N; j++){
+        a[j] = (int64_t)rand64();
+        b[j] = (int64_t)rand64();
+        for(size_t i = 0; i < RNS_LEN; i++){
+            p = plan->mods[i];
+            residue[i * ARRAY_N + j] = (uint64_t)((__extension__ (unsigned __int128)signed_mod(a[j], p) * signed_mod(b[j], p)) % p);
+        }
+    }
+
+    RNS_base_convert(res, residue, mods_to, RNS_TO_LEN, plan);
+
+    for(size_t k = 0; k < RNS_TO_LEN; k++){
+        p = mods_to[k];
+        for(size_t j = 0; j < ARRAY_N; j++){
+            t = (uint64_t)((__extension__ (unsigned __int128)signed_mod(a[j], p) * signed_mod(b[j], p)) % p);
+            assert(res[k * ARRAY_N + j] == t);
+        }
+    }
+
+    free(residue);
+    free(res);
+
+}
+
+// Store the tables of the plan, map them back, and check the fallbacks on mismatches.
+static
+void test_store(const struct RNS_plan *plan){
+
+    char path[] = "/tmp/RNS_store_XXXXXX";
+    struct table_store store;
+    struct table_store_item item;
+    struct RNS_plan mapped;
+    uint64_t mods[RNS_LEN];
+    size_t size = RNS_tables_size(RNS_LEN, plan->profile);
+    int fd, ret;
+    FILE *fp;
+
+    fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    RNS_table_key(&item.key, plan->mods, RNS_LEN, plan->profile);
+    item.data = RNS_tables(plan);
+    item.size = size;
+    ret = table_store_write(path, &item, 1);
+    assert(ret == 0);
+
+    // The tables are mapped without copying.
+    ret = table_store_open(&store, path);
+    assert(ret == 0);
+    ret = table_store_verify(&store);
+    assert(ret == 0);
+    ret = RNS_init_from_store(&mapped, plan->mods, RNS_LEN, plan->profile, &store);
+    assert(ret == 1);
+    assert(mapped.table_block == NULL);
+    assert(((const char*)mapped.mods >= (const char*)store.map) && ((const char*)mapped.mods < (const char*)store.map + store.map_size));
+    assert(memcmp(RNS_tables(&mapped), RNS_tables(plan), size) == 0);
+    test_mul(&mapped);
+    RNS_free(&mapped);
+
+    // Other primes are not in the store.
+    for(size_t i = 0; i < RNS_LEN; i++){
+        mods[i] = plan->mods[RNS_LEN - 1 - i];
+    }
+    ret = RNS_init_from_store(&mapped, mods, RNS_LEN, plan->profile, &store);
+    assert(ret == 0);
+    assert(memcmp(mapped.mods, mods, sizeof(mods)) == 0);
+    RNS_free(&mapped);
+
+    table_store_close(&store);
+
+    // Corrupt the last byte of the tables. The lookup rejects the entry and the tables are
+    // generated.
+    fp = fopen(path, "r+b");
+    assert(fp != NULL);
+    fseek(fp, -1, SEEK_END);
+    ret = fgetc(fp);
+    fseek(fp, -1, SEEK_END);
+    fputc(ret ^ 1, fp);
+    fclose(fp);
+
+    ret = table_store_open(&store, path);
+    assert(ret == 0);
+    ret = table_store_verify(&store);
+    assert(ret == -1);
+    ret = RNS_init_from_store(&mapped, plan->mods, RNS_LEN, plan->profile, &store);
+    assert(ret == 0);
+    assert(mapped.table_block != NULL);
+    assert(memcmp(RNS_tables(&mapped), RNS_tables(plan), size) == 0);
+    RNS_free(&mapped);
+    table_store_close(&store);
+
+    // Corrupt the magic. The store cannot be opened.
+    fp = fopen(path, "r+b");
+    assert(fp != NULL);
+    fputc('X', fp);
+    fclose(fp);
+
+    ret = table_store_open(&store, path);
+    assert(ret == -1);
+
+    remove(path);
+
+}
+
+int main(void){
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N
+    };
+
+    for(size_t i = 0; i < profile.compressed_layers; i++){
+        profile.merged_layers[i] = 1;
+    }
+
+    uint64_t mods[RNS_LEN];
+    struct RNS_plan plan;
+
+    size_t len = RNS_gen_primes(mods, RNS_LEN, RNS_BITS, 2 * NTT_N);
+    assert(len == RNS_LEN);
+    RNS_init(&plan, mods, RNS_LEN, profile);
+
+    test_mul(&plan);
+    test_CRT(&plan);
+    test_base_convert(&plan);
+    test_store(&plan);
+
+    RNS_free(&plan);
+
+    printf("Test finished!\n");
+
+}
+
@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// ================
+// This file demonstrates Rader's algorithm for prime-size DFTs over Z_Q and its composition
+// with Good--Thomas for the isomorphism Z_Q[x] / (x^544 - 1) \cong
+// Z_Q[z] / (z^17 - 1) \otimes Z_Q[y] / (y^32 - 1).
+
+// ================
+// Theory.
+// Let p be an odd prime, omega_p be a principal p-th root of unity, and g be a generator of Z_p^*.
+// We wish to compute X_k = sum_n x_n omega_p^(n k) for k = 0, ..., p - 1.
+// X_0 is the sum of all the x_n's. For the rest, we write n = g^(-a) and k = g^b and find
+// X_{g^b} = x_0 + sum_{a = 0}^{p - 2} x_{g^(-a)} omega_p^(g^(b - a)).
+// The sum is the size-(p - 1) cyclic convolution of u_a = x_{g^(-a)} and v_c = omega_p^(g^c).
+// Since v is fixed, we precompute its NTT and the cyclic convolution costs one NTT, one point-wise
+// multiplication, and one inverse NTT.
+// - If p - 1 is a power of two, we use the size-(p - 1) cyclic NTT.
+// - Otherwise, we extend v periodically to 2 (p - 1) - 1 elements, compute the linear convolution
+//   with a power-of-two NTT of size at least 2 (p - 1), and read the results at [p - 1, 2 (p - 1)).
+// For Z_Q[x] / (x^(p 2^k) - 1), gcd(p, 2^k) = 1 implies (Good--Thomas, see GT.c)
+// Z_Q[x] / (x^(p 2^k) - 1) \cong Z_Q[z] / (z^p - 1) \otimes Z_Q[y] / (y^(2^k) - 1)
+// with x -> z y. The size-p DFTs in z are computed with Rader's algorithm and the size-2^k
+// DFTs in y with Cooley--Tukey FFT.
+
+// ================
+// A small example.
+// For p = 5 and g = 2, we have (g^(-a))_a = (1, 3, 4, 2) and (g^b)_b = (1, 2, 4, 3).
+// The size-4 cyclic convolution of (x_1, x_3, x_4, x_2) and
+// (omega_5, omega_5^2, omega_5^4, omega_5^3) yields (X_1, X_2, X_4, X_3) after adding x_0.
+
+// ================
+// Optimization guide.
+/*
+
+1. The NTT of v is precomputed and scaled by NTT_N^(-1) in gen_Rader_table.
+
+2. For the composition with Good--Thomas, the permutations of Rader's algorithm and
+   Good--Thomas can be merged into one.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// See [ACC+21] for Rader's algorithm in NTRU Prime.
+
+#define ARRAY_N 544
+#define P 17
+#define Y_N 32
+#define LOGY_N 5
+
+#define RADER_NTT_N 16
+#define LOGRADER_NTT_N 4
+
+#define Q (15233)
+
+// Principal roots of unity in Z_Q.
+#define OMEGA17 (-6571)
+#define OMEGA17_INV (-6083)
+#define OMEGA7 (4382)
+#define OMEGA16 (-3334)
+#define OMEGA16_INV (-3742)
+#define OMEGA32 (386)
+#define OMEGA32_INV (2723)
+
+// Inverse of RADER_NTT_N in Z_Q.
+#define RADER_NTT_N_INV (-952)
+
+// ================
+// Z_Q
+
+int16_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int16(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int16(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int16(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int16(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int16(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+
+int16_t Rader_NTT_table[RADER_NTT_N - 1], Rader_iNTT_table[RADER_NTT_N - 1];
+int16_t Y_NTT_table[Y_N - 1], Y_iNTT_table[Y_N - 1];
+
+size_t perm17[2 * (P - 1)], perm7[2 * (7 - 1)];
+int16_t kernel17[RADER_NTT_N], ikernel17[RADER_NTT_N], kernel7[RADER_NTT_N];
+
+// Compare Rader's algorithm against the definition of the size-p DFT.
+static
+void test_Rader(size_t p, int16_t omega_p, size_t *perm, int16_t *kernel, struct compress_profile profile){
+
+    int16_t src[p], ref[p], res[p];
+    int16_t twiddle, t;
+
+    for(size_t i = 0; i < p; i++){
+        t = rand();
+        coeff_ring.memberZ(src + i, &t);
+    }
+
+    for(size_t k = 0; k < p; k++){
+        ref[k] = 0;
+        for(size_t n = 0; n < p; n++){
+            coeff_ring.expZ(&twiddle, &omega_p, (n * k) % p);
+            coeff_ring.mulZ(&t, src + n, &twiddle);
+            coeff_ring.addZ(ref + k, ref + k, &t);
+        }
+    }
+
+    Rader_DFT(res, src, p, perm, kernel, Rader_NTT_table, Rader_iNTT_table, profile, coeff_ring);
+
+    for(size_t k = 0; k < p; k++){
+        assert(ref[k] == res[k]);
+    }
+
+}
+
+int main(void){
+
+    int16_t poly1[ARRAY_N], poly2[ARRAY_N];
+    int16_t ref[ARRAY_N], res[ARRAY_N];
+    int16_t poly1_NTT[ARRAY_N], poly2_NTT[ARRAY_N], res_NTT[ARRAY_N];
+    int16_t column[Y_N];
+
+    int16_t omega, zeta, twiddle, scale, t;
+
+    struct compress_profile Rader_profile = {
+        RADER_NTT_N, RADER_NTT_N, LOGRADER_NTT_N, LOGRADER_NTT_N, {1, 1, 1, 1}
+    };
+
+    struct compress_profile Y_profile = {
+        Y_N, Y_N, LOGY_N, LOGY_N, {1, 1, 1, 1, 1}
+    };
+
+// ================
+// Generate the tables for the size-16 cyclic NTT inside Rader's algorithm.
+
+    zeta = 1;
+    scale = 1;
+    omega = OMEGA16;
+    gen_DWT_table(Rader_NTT_table, &scale, &omega, &zeta, Rader_profile, coeff_ring);
+    omega = OMEGA16_INV;
+    gen_DWT_table(Rader_iNTT_table, &scale, &omega, &zeta, Rader_profile, coeff_ring);
+
+// ================
+// Generate the tables for Rader's algorithm.
+// For p = 17, p - 1 = 16 is the size of the NTT.
+// For p = 7, the size-6 cyclic convolution is computed with the size-16 NTT.
+
+    scale = RADER_NTT_N_INV;
+    omega = OMEGA17;
+    gen_Rader_table(perm17, kernel17, 17, &omega, &scale, Rader_NTT_table, Rader_profile, coeff_ring);
+    omega = OMEGA17_INV;
+    gen_Rader_table(perm17, ikernel17, 17, &omega, &scale, Rader_NTT_table, Rader_profile, coeff_ring);
+    omega = OMEGA7;
+    gen_Rader_table(perm7, kernel7, 7, &omega, &scale, Rader_NTT_table, Rader_profile, coeff_ring);
+
+    test_Rader(17, OMEGA17, perm17, kernel17, Rader_profile);
+    test_Rader(7, OMEGA7, perm7, kernel7, Rader_profile);
+
+// ================
+// Compute the product in Z_Q[x] / (x^544 - 1).
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+    }
+
+    twiddle = 1;
+    naive_mulR(ref,
+        poly1, poly2, ARRAY_N, &twiddle, coeff_ring);
+
+// ================
+// Permute so we have Z_Q[x] / (x^544 - 1) \cong
+// Z_Q[y] / (y^32 - 1) \otimes Z_Q[z] / (z^17 - 1).
+// The 17 coefficients in z are stored consecutively.
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        poly1_NTT[(i % Y_N) * P + (i % P)] = poly1[i];
+        poly2_NTT[(i % Y_N) * P + (i % P)] = poly2[i];
+    }
+
+// ================
+// Apply Rader's algorithm in z and Cooley--Tukey FFT in y.
+
+    zeta = 1;
+    scale = 1;
+    omega = OMEGA32;
+    gen_DWT_table(Y_NTT_table, &scale, &omega, &zeta, Y_profile, coeff_ring);
+    omega = OMEGA32_INV;
+    gen_DWT_table(Y_iNTT_table, &scale, &omega, &zeta, Y_profile, coeff_ring);
+
+    for(size_t i = 0; i < Y_N; i++){
+        Rader_DFT(poly1_NTT + i * P, poly1_NTT + i * P, P, perm17, kernel17,
+            Rader_NTT_table, Rader_iNTT_table, Rader_profile, coeff_ring);
+        Rader_DFT(poly2_NTT + i * P, poly2_NTT + i * P, P, perm17, kernel17,
+            Rader_NTT_table, Rader_iNTT_table, Rader_profile, coeff_ring);
+    }
+
+    for(size_t j = 0; j < P; j++){
+        for(size_t i = 0; i < Y_N; i++){
+            column[i] = poly1_NTT[i * P + j];
+        }
+        CT_NTT(column, Y_NTT_table, Y_profile, coeff_ring);
+        for(size_t i = 0; i < Y_N; i++){
+            poly1_NTT[i * P + j] = column[i];
+        }
+        for(size_t i = 0; i < Y_N; i++){
+            column[i] = poly2_NTT[i * P + j];
+        }
+        CT_NTT(column, Y_NTT_table, Y_profile, coeff_ring);
+        for(size_t i = 0; i < Y_N; i++){
+            poly2_NTT[i * P + j] = column[i];
+        }
+    }
+
+// ================
+
+    point_mul(res_NTT, poly1_NTT, poly2_NTT, ARRAY_N, 1, coeff_ring);
+
+// ================
+// Apply the inverses. The result is scaled by 32 * 17 = 544.
+
+    for(size_t j = 0; j < P; j++){
+        for(size_t i = 0; i < Y_N; i++){
+            column[i] = res_NTT[i * P + j];
+        }
+        GS_iNTT(column, Y_iNTT_table, Y_profile, coeff_ring);
+        for(size_t i = 0; i < Y_N; i++){
+            res_NTT[i * P + j] = column[i];
+        }
+    }
+
+    for(size_t i = 0; i < Y_N; i++){
+        Rader_DFT(res_NTT + i * P, res_NTT + i * P, P, perm17, ikernel17,
+            Rader_NTT_table, Rader_iNTT_table, Rader_profile, coeff_ring);
+    }
+
+// ================
+// Permute back to Z_Q[x] / (x^544 - 1).
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        res[i] = res_NTT[(i % Y_N) * P + (i % P)];
+    }
+
+// ================
+// Multiply the scale to reference.
+
+    scale = ARRAY_N;
+    for(size_t i = 0; i < ARRAY_N; i++){
+        coeff_ring.mulZ(ref + i, ref + i, &scale);
+    }
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        assert(ref[i] == res[i]);
+    }
+
+    printf("Test finished!\n");
+
+}
+
@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+
+// The header is generated at build time by gen_Toom (see Makefile).
+#include "TC_schemes.h"
+
+// ================
+// This file demonstrates Toom-k schemes emitted by gen_Toom for several point sets
+// over Z_{2^32} and Z_{2^16}.
+
+// ================
+// Theory.
+// See gen_Toom.c for the computation of the evaluation and interpolation, the exact
+// power-of-two divisions, and the resulting precision.
+
+// ================
+// Optimization guide.
+/*
+
+1. The generated schemes for k = 4 and k = 5 over Z_{2^16} are correct modulo 2^13.
+   Toom-6 and Toom-8 lose more bits; over Z_{2^16} they are not usable for Z_{2^13},
+   and gen_Toom reports the precision of other point sets without hand-deriving the matrices.
+
+2. gen_Toom searches for elimination sequences reusing the intermediate results, as in
+   TC4_interpol and TC5_interpol in TC.c. TC4_W32 needs 3 multiplications like TC4_interpol,
+   and TC5_W32 with precision=26 needs 9 instead of the 15 of TC5_interpol.
+   For k = 6 and k = 8 the search is far from optimal; see the costs in TC_schemes.h.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+
+// ARRAY_N must be a multiple of 4, 5, 6, and 8.
+#define ARRAY_N 240
+
+// ================
+// Z_{2^32}
+
+void memberZ(void *des, const void *src){
+    *(int32_t*)des = *(int32_t*)src;
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    *(int32_t*)des = (*(int32_t*)src1) + (*(int32_t*)src2);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    *(int32_t*)des = (*(int32_t*)src1) - (*(int32_t*)src2);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    *(int32_t*)des = (*(int32_t*)src1) * (*(int32_t*)src2);
+}
+
+void expZ(void *des, const void *src, size_t e){
+
+    int32_t src_v = *(int32_t*)src;
+    int32_t tmp_v;
+
+    tmp_v = 1;
+    for(; e; e >>= 1){
+        if(e & 1){
+            tmp_v = tmp_v * src_v;
+        }
+        src_v = src_v * src_v;
+    }
+
+    memmove(des, &tmp_v, sizeof(int32_t));
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int32_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+// Z_{2^16}
+
+void memberZ16(void *des, const void *src){
+    *(int16_t*)des = *(int16_t*)src;
+}
+
+void addZ16(void *des, const void *src1, const void *src2){
+    *(int16_t*)des = (*(int16_t*)src1) + (*(int16_t*)src2);
+}
+
+void subZ16(void *des, const void *src1, const void *src2){
+    *(int16_t*)des = (*(int16_t*)src1) - (*(int16_t*)src2);
+}
+
+void mulZ16(void *des, const void *src1, const void *src2){
+    *(int16_t*)des = (*(int16_t*)src1) * (*(int16_t*)src2);
+}
+
+void expZ16(void *des, const void *src, size_t e){
+
+    int16_t src_v = *(int16_t*)src;
+    int16_t tmp_v;
+
+    tmp_v = 1;
+    for(; e; e >>= 1){
+        if(e & 1){
+            tmp_v = tmp_v * src_v;
+        }
+        src_v = src_v * src_v;
+    }
+
+    memmove(des, &tmp_v, sizeof(int16_t));
+}
+
+struct ring coeff_ring16 = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ16,
+    .addZ = addZ16,
+    .subZ = subZ16,
+    .mulZ = mulZ16,
+    .expZ = expZ16
+};
+
+// ================
+
+// len must be a k-multiple.
+// This function computes the product of two size-len polynomials in Z_{2^32}[x]
+// using the Toom-k scheme given by eval and interpol with 2 k - 1 points.
+static
+void TC_generic_mul(int32_t *des, const int32_t *src1, const int32_t *src2, size_t len, size_t k,
+                    void (*eval)(int32_t*, const int32_t*), void (*interpol)(int32_t*, const int32_t*)){
+
+    size_t n = 2 * k - 1;
+    int32_t src1_extended[n][len / k], src2_extended[n][len / k];
+    int32_t res[n][2 * len / k];
+    int32_t buff[n], in[k];
+
+    // Apply the evaluation.
+    for(size_t i = 0; i < len / k; i++){
+        for(size_t j = 0; j < k; j++){
+            in[j] = src1[j * (len / k) + i];
+        }
+        eval(buff, in);
+        for(size_t j = 0; j < n; j++){
+            src1_extended[j][i] = buff[j];
+        }
+        for(size_t j = 0; j < k; j++){
+            in[j] = src2[j * (len / k) + i];
+        }
+        eval(buff, in);
+        for(size_t j = 0; j < n; j++){
+            src2_extended[j][i] = buff[j];
+        }
+    }
+
+    // Compute small-dimensional products.
+    for(size_t i = 0; i < n; i++){
+        naive_mul_long((int32_t*)&res[i][0], (int32_t*)&src1_extended[i][0], (int32_t*)&src2_extended[i][0], len / k, coeff_ring);
+    }
+
+    // Apply the interpolation.
+    for(size_t i = 0; i < 2 * len / k - 1; i++){
+        for(size_t j = 0; j < n; j++){
+            buff[j] = res[j][i];
+        }
+        interpol(buff, buff);
+        for(size_t j = 0; j < n; j++){
+            res[j][i] = buff[j];
+        }
+    }
+
+    memset(des, 0, (2 * len - 1) * sizeof(int32_t));
+
+    // Export the result.
+    for(size_t i = 0; i < n; i++){
+        for(size_t j = 0; j < 2 * len / k - 1; j++){
+            des[i * (len / k) + j] += res[i][j];
+        }
+    }
+
+}
+
+// The Z_{2^16} version of TC_generic_mul.
+static
+void TC_generic_mul16(int16_t *des, const int16_t *src1, const int16_t *src2, size_t len, size_t k,
+                      void (*eval)(int16_t*, const int16_t*), void (*interpol)(int16_t*, const int16_t*)){
+
+    size_t n = 2 * k - 1;
+    int16_t src1_extended[n][len / k], src2_extended[n][len / k];
+    int16_t res[n][2 * len / k];
+    int16_t buff[n], in[k];
+
+    // Apply the evaluation.
+    for(size_t i = 0; i < len / k; i++){
+        for(size_t j = 0; j < k; j++){
+            in[j] = src1[j * (len / k) + i];
+        }
+        eval(buff, in);
+        for(size_t j = 0; j < n; j++){
+            src1_extended[j][i] = buff[j];
+        }
+        for(size_t j = 0; j < k; j++){
+            in[j] = src2[j * (len / k) + i];
+        }
+        eval(buff, in);
+        for(size_t j = 0; j < n; j++){
+            src2_extended[j][i] = buff[j];
+        }
+    }
+
+    // Compute small-dimensional products.
+    for(size_t i = 0; i < n; i++){
+        naive_mul_long((int16_t*)&res[i][0], (int16_t*)&src1_extended[i][0], (int16_t*)&src2_extended[i][0], len / k, coeff_ring16);
+    }
+
+    // Apply the interpolation.
+    for(size_t i = 0; i < 2 * len / k - 1; i++){
+        for(size_t j = 0; j < n; j++){
+            buff[j] = res[j][i];
+        }
+        interpol(buff, buff);
+        for(size_t j = 0; j < n; j++){
+            res[j][i] = buff[j];
+        }
+    }
+
+    memset(des, 0, (2 * len - 1) * sizeof(int16_t));
+
+    // Export the result.
+    for(size_t i = 0; i < n; i++){
+        for(size_t j = 0; j < 2 * len / k - 1; j++){
+            des[i * (len / k) + j] += res[i][j];
+        }
+    }
+
+}
+
+struct scheme32 {
+    size_t k;
+    int32_t precision;
+    void (*eval)(int32_t*, const int32_t*);
+    void (*interpol)(int32_t*, const int32_t*);
+};
+
+struct scheme16 {
+    size_t k;
+    int32_t precision;
+    void (*eval)(int16_t*, const int16_t*);
+    void (*interpol)(int16_t*, const int16_t*);
+};
+
+int main(void){
+
+    int32_t poly1[ARRAY_N], poly2[ARRAY_N];
+    int32_t ref[2 * ARRAY_N], res[2 * ARRAY_N];
+    int16_t poly1_16[ARRAY_N], poly2_16[ARRAY_N];
+    int16_t ref16[2 * ARRAY_N], res16[2 * ARRAY_N];
+
+    int32_t mod, t;
+
+    struct scheme32 schemes32[4] = {
+        {TC4_W32_K, TC4_W32_PRECISION, TC4_W32_eval, TC4_W32_interpol},
+        {TC5_W32_K, TC5_W32_PRECISION, TC5_W32_eval, TC5_W32_interpol},
+        {TC6_W32_K, TC6_W32_PRECISION, TC6_W32_eval, TC6_W32_interpol},
+        {TC8_W32_K, TC8_W32_PRECISION, TC8_W32_eval, TC8_W32_interpol}
+    };
+
+    struct scheme16 schemes16[2] = {
+        {TC4_W16_K, TC4_W16_PRECISION, TC4_W16_eval, TC4_W16_interpol},
+        {TC5_W16_K, TC5_W16_PRECISION, TC5_W16_eval, TC5_W16_interpol}
+    };
+
+    for(size_t i = 0; i < ARRAY_N; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+        poly1_16[i] = (int16_t)poly1[i];
+        poly2_16[i] = (int16_t)poly2[i];
+    }
+
+    // Compute the product in Z_{2^32}[x].
+    naive_mul_long(ref, poly1, poly2, ARRAY_N, coeff_ring);
+
+    for(size_t s = 0; s < 4; s++){
+
+        TC_generic_mul(res, poly1, poly2, ARRAY_N, schemes32[s].k, schemes32[s].eval, schemes32[s].interpol);
+
+        // The results are correct modulo 2^precision.
+        mod = (int32_t)1 << schemes32[s].precision;
+        for(size_t i = 0; i < 2 * ARRAY_N - 1; i++){
+            int32_t a = ref[i], b = res[i];
+            cmod_int32(&a, &a, &mod);
+            cmod_int32(&b, &b, &mod);
+            assert(a == b);
+        }
+
+    }
+
+    // Compute the product in Z_{2^16}[x].
+    naive_mul_long(ref16, poly1_16, poly2_16, ARRAY_N, coeff_ring16);
+
+    for(size_t s = 0; s < 2; s++){
+
+        TC_generic_mul16(res16, poly1_16, poly2_16, ARRAY_N, schemes16[s].k, schemes16[s].eval, schemes16[s].interpol);
+
+        // The results are correct modulo 2^precision.
+        mod = (int32_t)1 << schemes16[s].precision;
+        for(size_t i = 0; i < 2 * ARRAY_N - 1; i++){
+            int32_t a = ref16[i], b = res16[i];
+            cmod_int32(&a, &a, &mod);
+            cmod_int32(&b, &b, &mod);
+            assert(a == b);
+        }
+
+    }
+
+    printf("Test finished!\n");
+
+}
+
@@ -0,0 +1,465 @@
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+
+// ================
+// This file demonstrates a configurable recursive pipeline for polynomial multiplication
+// in Z_{2^32}[x] where each level is Toom-4, Toom-3, Karatsuba, or the schoolbook method,
+// for example Toom-4, then two layers of Karatsuba, then 16 x 16 schoolbook for size-256
+// polynomials as in Saber.
+
+// ================
+// Theory.
+// A level of Toom-k (resp. Karatsuba) maps a size-len product to 2 k - 1 (resp. 3) products
+// of size len / k (resp. len / 2). Applying the levels recursively, the sizes shrink until
+// the schoolbook method is applied.
+// Each level applies if len is larger than its threshold and divisible by k (resp. 2);
+// otherwise it is skipped and the next level is considered. After the last level, the
+// schoolbook method is applied.
+// The interpolation of Toom-4 divides by 8 and the one of Toom-3 by 2. These divisions are exact
+// in Z, so the result is correct modulo 2^(32 - 3 t_4 - t_3) where t_4 and t_3 are the
+// numbers of Toom-4 and Toom-3 levels applied (see pipeline_precision).
+
+// ================
+// Optimization guide.
+/*
+
+1. Each level writes the evaluated operands into the arena, and the next level reads them
+   from there in place. The products are written into the arena by the next level, and the
+   interpolation reads them and accumulates the coefficients into des directly.
+   There are no copies between the levels, and the arena is supplied by the caller once.
+
+2. For size-256 polynomials, the schoolbook method needs 256^2 = 65536 multiplications while
+   Toom-4, two layers of Karatsuba, and 16 x 16 schoolbook need 7 * 3 * 3 * 16^2 = 16128.
+   The base case size is chosen such that the schoolbook method fits the register file.
+
+3. Each Toom-4 level loses 3 bits. With two levels of Toom-4 the result is correct
+   modulo 2^26, which is still enough for Saber (2^13) and NTRU (2^11 to 2^13).
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+
+#define ARRAY_N 256
+#define ARRAY_N_LARGE 720
+
+// ================
+// Z_{2^32}
+
+void memberZ(void *des, const void *src){
+    *(int32_t*)des = *(int32_t*)src;
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    *(int32_t*)des = (int32_t)((*(uint32_t*)src1) + (*(uint32_t*)src2));
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    *(int32_t*)des = (int32_t)((*(uint32_t*)src1) - (*(uint32_t*)src2));
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    *(int32_t*)des = (int32_t)((*(uint32_t*)src1) * (*(uint32_t*)src2));
+}
+
+void expZ(void *des, const void *src, size_t e){
+
+    int32_t src_v = *(int32_t*)src;
+    int32_t tmp_v;
+
+    tmp_v = 1;
+    for(; e; e >>= 1){
+        if(e & 1){
+            tmp_v = tmp_v * src_v;
+        }
+        src_v = src_v * src_v;
+    }
+
+    memmove(des, &tmp_v, sizeof(int32_t));
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int32_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+// Straight-line Toom-4 and Toom-3 in uint32_t arithmetic (see TC.c).
+
+// Toom-4 evaluation at {0, 1, -1, 2, -2, 1/2, \infty}.
+// This function evaluates (src[0], src[1], src[2], src[3]) without multiplications.
+// The point 1/2 is scaled by 8.
+// For each pair {z, -z}, the even part e and the odd part o are computed once
+// and the values are e + o and e - o.
+static
+void TC4_eval(int32_t *des, const int32_t *src){
+
+    uint32_t a0 = src[0], a1 = src[1], a2 = src[2], a3 = src[3];
+    uint32_t e, o;
+
+    des[0] = (int32_t)a0;
+    // {1, -1}
+    e = a0 + a2;
+    o = a1 + a3;
+    des[1] = (int32_t)(e + o);
+    des[2] = (int32_t)(e - o);
+    // {2, -2}
+    e = a0 + (a2 << 2);
+    o = (a1 << 1) + (a3 << 3);
+    des[3] = (int32_t)(e + o);
+    des[4] = (int32_t)(e - o);
+    // Horner's rule with shifts.
+    des[5] = (int32_t)((((((a0 << 1) + a1) << 1) + a2) << 1) + a3);
+    des[6] = (int32_t)a3;
+
+}
+
+// Toom-4 interpolation.
+// This function computes the coefficients of the size-7 product from its values at {0, 1, -1, 2, -2, 1/2, \infty}
+// where the value at 1/2 is scaled by 64.
+// The divisions by powers of two are exact in Z and lose 3 bits in Z_{2^32}, so the
+// results are correct modulo 2^29. The divisions by 3 and 45 are multiplications by the inverses.
+static
+void TC4_interpol(int32_t *des, const int32_t *src){
+
+    uint32_t w0 = src[0], w1 = src[1], w2 = src[2], w3 = src[3], w4 = src[4], w5 = src[5], w6 = src[6];
+    uint32_t e1, o1, e2, o2, a, b, p, u;
+    uint32_t c1, c2, c3, c4, c5;
+
+    // Split the pairs {1, -1} and {2, -2} into the even and odd parts.
+    // c0 + c2 + c4 + c6 and c1 + c3 + c5.
+    e1 = (w1 + w2) >> 1;
+    o1 = (w1 - w2) >> 1;
+    // c0 + 4 c2 + 16 c4 + 64 c6 and c1 + 4 c3 + 16 c5.
+    e2 = (w3 + w4) >> 1;
+    o2 = (w3 - w4) >> 2;
+
+    // The even coefficients: a = c2 + c4 and b = 4 c2 + 16 c4.
+    a = e1 - w0 - w6;
+    b = e2 - w0 - (w6 << 6);
+    c4 = ((b - (a << 2)) >> 2) * (-1431655765);
+    c2 = a - c4;
+
+    // The odd coefficients: p = 16 c1 + 4 c3 + c5 and u = c3 + 5 c5.
+    p = (w5 - (w0 << 6) - (c2 << 4) - (c4 << 2) - w6) >> 1;
+    u = (o2 - o1) * (-1431655765);
+    c5 = (p - (o1 << 4) + (u << 3) + (u << 2)) * (-1527099483);
+    c3 = u - c5 - (c5 << 2);
+    c1 = o1 - c3 - c5;
+
+    des[0] = (int32_t)w0;
+    des[1] = (int32_t)c1;
+    des[2] = (int32_t)c2;
+    des[3] = (int32_t)c3;
+    des[4] = (int32_t)c4;
+    des[5] = (int32_t)c5;
+    des[6] = (int32_t)w6;
+
+}
+
+// Toom-3 evaluation of (src[0], src[1], src[2]) at {0, 1, -1, -2, \infty}.
+static
+void TC3_eval(int32_t *des, const int32_t *src){
+
+    uint32_t a0 = src[0], a1 = src[1], a2 = src[2];
+    uint32_t e;
+
+    des[0] = (int32_t)a0;
+    // {1, -1}
+    e = a0 + a2;
+    des[1] = (int32_t)(e + a1);
+    des[2] = (int32_t)(e - a1);
+    // a0 - 2 a1 + 4 a2 = 2 (a0 - a1 + a2 + a2) - a0
+    des[3] = (int32_t)(((e - a1 + a2) << 1) - a0);
+    des[4] = (int32_t)a2;
+
+}
+
+// Toom-3 interpolation (Bodrato's sequence).
+// This function computes the coefficients of the size-5 product from its values at
+// {0, 1, -1, -2, \infty}. The division by 2 is exact in Z and loses 1 bit in Z_{2^32},
+// so the results are correct modulo 2^31.
+static
+void TC3_interpol(int32_t *des, const int32_t *src){
+
+    uint32_t w0 = src[0], w1 = src[1], wm1 = src[2], wm2 = src[3], winf = src[4];
+    uint32_t r1, r2, r3;
+
+    r3 = (wm2 - w1) * (-1431655765);
+    r1 = (w1 - wm1) >> 1;
+    r2 = wm1 - w0;
+    r3 = ((r2 - r3) >> 1) + (winf << 1);
+    r2 = r2 + r1 - winf;
+    r1 = r1 - r3;
+
+    des[0] = (int32_t)w0;
+    des[1] = (int32_t)r1;
+    des[2] = (int32_t)r2;
+    des[3] = (int32_t)r3;
+    des[4] = (int32_t)winf;
+
+}
+
+// ================
+// The pipeline.
+
+enum level_type {
+    LEVEL_TOOM4,
+    LEVEL_TOOM3,
+    LEVEL_KARATSUBA,
+    LEVEL_SCHOOLBOOK
+};
+
+// A level applies to a size-len product if len > threshold and len is divisible by the
+// number of limbs of the level.
+struct level {
+    enum level_type type;
+    size_t threshold;
+};
+
+// Returns the number of limbs of the level, or 0 for the schoolbook method.
+static
+size_t level_limbs(enum level_type type){
+    switch(type){
+        case LEVEL_TOOM4:
+            return 4;
+        case LEVEL_TOOM3:
+            return 3;
+        case LEVEL_KARATSUBA:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+// Returns the number of the first level applying to a size-len product,
+// or n_levels if the schoolbook method is applied.
+static
+size_t level_select(size_t len, const struct level *levels, size_t n_levels){
+
+    for(size_t i = 0; i < n_levels; i++){
+        size_t k = level_limbs(levels[i].type);
+        if(k == 0){
+            return n_levels;
+        }
+        if((len > levels[i].threshold) && (len % k == 0)){
+            return i;
+        }
+    }
+
+    return n_levels;
+
+}
+
+// Scratch size in int32_t of pipeline_mul for size-len inputs.
+// The products of a level are computed one after another, so the arena of the next level
+// is shared by all of them.
+static
+size_t pipeline_arena_size(size_t len, const struct level *levels, size_t n_levels){
+
+    size_t i = level_select(len, levels, n_levels);
+    size_t k, n, m;
+
+    if(i == n_levels){
+        return 0;
+    }
+
+    k = level_limbs(levels[i].type);
+    n = (k == 2) ? 3 : 2 * k - 1;
+    m = len / k;
+
+    // The evaluated operands, the products, and the arena of the next level.
+    return 2 * n * m + n * (2 * m - 1) + pipeline_arena_size(m, levels + i + 1, n_levels - i - 1);
+
+}
+
+// The number of bits of the result of pipeline_mul that are correct.
+static
+size_t pipeline_precision(size_t len, const struct level *levels, size_t n_levels){
+
+    size_t i = level_select(len, levels, n_levels);
+    size_t k;
+
+    if(i == n_levels){
+        return 32;
+    }
+
+    k = level_limbs(levels[i].type);
+
+    return pipeline_precision(len / k, levels + i + 1, n_levels - i - 1) - ((k == 4) ? 3 : (k == 3) ? 1 : 0);
+
+}
+
+// This function computes the product of two size-len polynomials in Z_{2^32}[x]
+// by applying levels[0], ..., levels[n_levels - 1] recursively followed by the schoolbook method.
+// The result is correct modulo 2^pipeline_precision(len, levels, n_levels).
+// arena must hold pipeline_arena_size(len, levels, n_levels) int32_t.
+static
+void pipeline_mul(int32_t *des, const int32_t *src1, const int32_t *src2, size_t len,
+                  const struct level *levels, size_t n_levels, int32_t *arena){
+
+    size_t i = level_select(len, levels, n_levels);
+    size_t k, n, m;
+    int32_t *ev1, *ev2, *prod, *next;
+    int32_t buff[7], in[4];
+
+    if(i == n_levels){
+        naive_mul_long(des, (int32_t*)src1, (int32_t*)src2, len, coeff_ring);
+        return;
+    }
+
+    k = level_limbs(levels[i].type);
+    n = (k == 2) ? 3 : 2 * k - 1;
+    m = len / k;
+
+    // The evaluated operands, n size-m polynomials each.
+    ev1 = arena;
+    ev2 = ev1 + n * m;
+    // The products, n size-(2 m - 1) polynomials.
+    prod = ev2 + n * m;
+    next = prod + n * (2 * m - 1);
+
+    // Evaluate directly into the arena.
+    for(size_t t = 0; t < m; t++){
+        for(size_t u = 0; u < 2; u++){
+            const int32_t *src = u ? src2 : src1;
+            int32_t *ev = u ? ev2 : ev1;
+            for(size_t j = 0; j < k; j++){
+                in[j] = src[j * m + t];
+            }
+            switch(k){
+                case 4:
+                    TC4_eval(buff, in);
+                    break;
+                case 3:
+                    TC3_eval(buff, in);
+                    break;
+                default:
+                    buff[0] = in[0];
+                    buff[1] = (int32_t)((uint32_t)in[0] + (uint32_t)in[1]);
+                    buff[2] = in[1];
+                    break;
+            }
+            for(size_t j = 0; j < n; j++){
+                ev[j * m + t] = buff[j];
+            }
+        }
+    }
+
+    // The next level reads the evaluated operands and writes the products in place.
+    for(size_t j = 0; j < n; j++){
+        pipeline_mul(prod + j * (2 * m - 1), ev1 + j * m, ev2 + j * m, m, levels + i + 1, n_levels - i - 1, next);
+    }
+
+    memset(des, 0, (2 * len - 1) * sizeof(int32_t));
+
+    // Interpolate and accumulate into des.
+    for(size_t t = 0; t < 2 * m - 1; t++){
+        for(size_t j = 0; j < n; j++){
+            buff[j] = prod[j * (2 * m - 1) + t];
+        }
+        switch(k){
+            case 4:
+                TC4_interpol(buff, buff);
+                break;
+            case 3:
+                TC3_interpol(buff, buff);
+                break;
+            default:
+                buff[1] = (int32_t)((uint32_t)buff[1] - (uint32_t)buff[0] - (uint32_t)buff[2]);
+                break;
+        }
+        for(size_t j = 0; j < n; j++){
+            des[j * m + t] = (int32_t)((uint32_t)des[j * m + t] + (uint32_t)buff[j]);
+        }
+    }
+
+}
+
+int main(void){
+
+    int32_t poly1[ARRAY_N_LARGE], poly2[ARRAY_N_LARGE];
+    int32_t ref[2 * ARRAY_N_LARGE], res[2 * ARRAY_N_LARGE];
+    int32_t mod, t;
+
+    // Toom-4, two layers of Karatsuba, and 16 x 16 schoolbook as in Saber.
+    struct level saber_levels[4] = {
+        {LEVEL_TOOM4, 0},
+        {LEVEL_KARATSUBA, 0},
+        {LEVEL_KARATSUBA, 16},
+        {LEVEL_SCHOOLBOOK, 0}
+    };
+
+    // Toom-3, Toom-4, and Karatsuba: 720 -> 240 -> 60 -> 30, so the base products have size 30.
+    struct level large_levels[3] = {
+        {LEVEL_TOOM3, 0},
+        {LEVEL_TOOM4, 0},
+        {LEVEL_KARATSUBA, 0}
+    };
+
+    // Two levels of Toom-4. The Toom-3 level does not apply to size-256 products and
+    // the Karatsuba level does not apply to the size-16 products.
+    struct level toom_levels[4] = {
+        {LEVEL_TOOM3, 0},
+        {LEVEL_TOOM4, 0},
+        {LEVEL_TOOM4, 0},
+        {LEVEL_KARATSUBA, 32}
+    };
+
+    struct {
+        size_t len;
+        const struct level *levels;
+        size_t n_levels;
+    } tests[3] = {
+        {ARRAY_N, saber_levels, 4},
+        {ARRAY_N_LARGE, large_levels, 3},
+        {ARRAY_N, toom_levels, 4}
+    };
+
+    for(size_t i = 0; i < ARRAY_N_LARGE; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+    }
+
+    for(size_t s = 0; s < 3; s++){
+
+        size_t len = tests[s].len;
+        size_t precision = pipeline_precision(len, tests[s].levels, tests[s].n_levels);
+        int32_t *arena = malloc(pipeline_arena_size(len, tests[s].levels, tests[s].n_levels) * sizeof(int32_t));
+
+        // Compute the product in Z_{2^32}[x].
+        naive_mul_long(ref, poly1, poly2, len, coeff_ring);
+
+        // Compute the product in Z_{2^32}[x] with the pipeline.
+        pipeline_mul(res, poly1, poly2, len, tests[s].levels, tests[s].n_levels, arena);
+
+        // The results are correct modulo 2^precision.
+        mod = (int32_t)1 << (precision < 31 ? precision : 30);
+        for(size_t i = 0; i < 2 * len - 1; i++){
+            cmod_int32(ref + i, ref + i, &mod);
+            cmod_int32(res + i, res + i, &mod);
+            assert(ref[i] == res[i]);
+        }
+
+        free(arena);
+
+    }
+
+    printf("Test finished!\n");
+
+}
+
@@ -27,6 +27,8 @@
    by the correct constants. For example, 3 * a can be implemented as
    a + (a << 1) and 9 * a can beimplemented as a + (a << 3).
    With such optimization, we save the memory operations loading the matrices.
+   See TC4_eval, TC4_interpol, TC3_eval, and TC3_interpol for straight-line sequences.
+   Only the divisions by odd constants remain multiplications (by the inverses).
 
 2. Notice that point set is carefully chosen. In principle, when an integer z
    is chosen, we also choose -z. So evaluating a polynomial at {z, -z} will be faster
@@ -203,10 +205,86 @@ void matrix_vector_mul(int32_t *des, int32_t *srcM, int32_t *srcV, size_t len){
 
 }
 
+// ================
+// Straight-line Toom-4 with shifts and additions.
+// The matrices TC4, TC4_trunc, and iTC4 are kept as the reference.
+// As in TC.c, the sequences compute in uint32_t to avoid shifting negative int32_t values.
+
+// Toom-4 evaluation at {0, 1, -1, 2, -2, 1/2, \infty}.
+// This function computes TC4_trunc (src[0], src[1], src[2], src[3], 0, 0, 0)^T
+// without multiplications. The point 1/2 is scaled by 8.
+// For each pair {z, -z}, the even part e and the odd part o are computed once
+// and the values are e + o and e - o.
+static
+void TC4_eval(int32_t *des, const int32_t *src){
+
+    uint32_t a0 = src[0], a1 = src[1], a2 = src[2], a3 = src[3];
+    uint32_t e, o;
+
+    des[0] = (int32_t)a0;
+    // {1, -1}
+    e = a0 + a2;
+    o = a1 + a3;
+    des[1] = (int32_t)(e + o);
+    des[2] = (int32_t)(e - o);
+    // {2, -2}
+    e = a0 + (a2 << 2);
+    o = (a1 << 1) + (a3 << 3);
+    des[3] = (int32_t)(e + o);
+    des[4] = (int32_t)(e - o);
+    // Horner's rule with shifts.
+    des[5] = (int32_t)((((((a0 << 1) + a1) << 1) + a2) << 1) + a3);
+    des[6] = (int32_t)a3;
+
+}
+
+// Toom-4 interpolation.
+// This function computes iTC4 src followed by the divisions by powers of two in TC_striding_mul,
+// i.e., the coefficients of the size-7 product in x from its values at {0, 1, -1, 2, -2, 1/2, \infty}
+// where the value at 1/2 is scaled by 64.
+// The divisions by powers of two are exact in Z and lose 3 bits in Z_{2^32}, so the
+// results are correct modulo 2^29. The divisions by 3 and 45 are multiplications by the inverses.
+static
+void TC4_interpol(int32_t *des, const int32_t *src){
+
+    uint32_t w0 = src[0], w1 = src[1], w2 = src[2], w3 = src[3], w4 = src[4], w5 = src[5], w6 = src[6];
+    uint32_t e1, o1, e2, o2, a, b, p, u;
+    uint32_t c1, c2, c3, c4, c5;
+
+    // c0 + c2 + c4 + c6 and c1 + c3 + c5.
+    e1 = (w1 + w2) >> 1;
+    o1 = (w1 - w2) >> 1;
+    // c0 + 4 c2 + 16 c4 + 64 c6 and c1 + 4 c3 + 16 c5.
+    e2 = (w3 + w4) >> 1;
+    o2 = (w3 - w4) >> 2;
+
+    // The even coefficients: a = c2 + c4 and b = 4 c2 + 16 c4.
+    a = e1 - w0 - w6;
+    b = e2 - w0 - (w6 << 6);
+    c4 = ((b - (a << 2)) >> 2) * (-1431655765);
+    c2 = a - c4;
+
+    // The odd coefficients: p = 16 c1 + 4 c3 + c5 and u = c3 + 5 c5.
+    p = (w5 - (w0 << 6) - (c2 << 4) - (c4 << 2) - w6) >> 1;
+    u = (o2 - o1) * (-1431655765);
+    c5 = (p - (o1 << 4) + (u << 3) + (u << 2)) * (-1527099483);
+    c3 = u - c5 - (c5 << 2);
+    c1 = o1 - c3 - c5;
+
+    des[0] = (int32_t)w0;
+    des[1] = (int32_t)c1;
+    des[2] = (int32_t)c2;
+    des[3] = (int32_t)c3;
+    des[4] = (int32_t)c4;
+    des[5] = (int32_t)c5;
+    des[6] = (int32_t)w6;
+
+}
+
 // len must be a 4-multiple.
 // This function computes the product of two size-len polynomials in Z_{2^32}[x]
 // using Toom-4 with the point set {0, 1, -1, 2, -2, 1/2, \infty}.
-// Notice that matrices are modifed to ensure the well-defineness over Z_{2^32}.
+// The evaluation and interpolation are straight-line sequences of shifts and additions.
 static
 void TC_striding_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t len){
 
@@ -230,12 +308,12 @@ void TC_striding_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t len){
         }
     }
 
-    // Apply Toom-4 evaluation matrix.
+    // Apply Toom-4 evaluation.
     for(size_t i = 0; i < len / 4; i++){
         for(size_t j = 0; j < 7; j++){
             TC4_buff[j] = src1_extended[j][i];
         }
-        matrix_vector_mul(TC4_buff, (int32_t*)&TC4_trunc[0][0], TC4_buff, 7);
+        TC4_eval(TC4_buff, TC4_buff);
         for(size_t j = 0; j < 7; j++){
             src1_extended[j][i] = TC4_buff[j];
         }
@@ -245,7 +323,7 @@ void TC_striding_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t len){
         for(size_t j = 0; j < 7; j++){
             TC4_buff[j] = src2_extended[j][i];
         }
-        matrix_vector_mul(TC4_buff, (int32_t*)&TC4_trunc[0][0], TC4_buff, 7);
+        TC4_eval(TC4_buff, TC4_buff);
         for(size_t j = 0; j < 7; j++){
             src2_extended[j][i] = TC4_buff[j];
         }
@@ -257,20 +335,15 @@ void TC_striding_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t len){
         naive_mulR((int32_t*)&res[i][0], (int32_t*)&src1_extended[i][0], (int32_t*)&src2_extended[i][0], len / 4, &twiddle, coeff_ring);
     }
 
-    // Apply Toom-4 inversion matrix.
+    // Apply Toom-4 interpolation.
     for(size_t i = 0; i < len / 4; i++){
         for(size_t j = 0; j < 7; j++){
             TC4_buff[j] = res[j][i];
         }
-        matrix_vector_mul(TC4_buff, (int32_t*)&iTC4[0][0], TC4_buff, 7);
-        // Divide by powers of two.
-        res[0][i] = TC4_buff[0];
-        res[1][i] = TC4_buff[1] >> 2;
-        res[2][i] = TC4_buff[2] >> 3;
-        res[3][i] = TC4_buff[3] >> 1;
-        res[4][i] = TC4_buff[4] >> 3;
-        res[5][i] = TC4_buff[5] >> 2;
-        res[6][i] = TC4_buff[6];
+        TC4_interpol(TC4_buff, TC4_buff);
+        for(size_t j = 0; j < 7; j++){
+            res[j][i] = TC4_buff[j];
+        }
     }
 
     // Export the result.
@@ -290,6 +363,127 @@ void TC_striding_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t len){
 
 }
 
+// ================
+// Straight-line Toom-3 with the point set {0, 1, -1, -2, \infty}.
+/*
+
+Evaluation matrix
+
+1,  0, 0
+1,  1, 1
+1, -1, 1
+1, -2, 4
+0,  0, 1
+
+*/
+
+// Toom-3 evaluation of (src[0], src[1], src[2]) at {0, 1, -1, -2, \infty}.
+static
+void TC3_eval(int32_t *des, const int32_t *src){
+
+    uint32_t a0 = src[0], a1 = src[1], a2 = src[2];
+    uint32_t e;
+
+    des[0] = (int32_t)a0;
+    // {1, -1}
+    e = a0 + a2;
+    des[1] = (int32_t)(e + a1);
+    des[2] = (int32_t)(e - a1);
+    // a0 - 2 a1 + 4 a2 = 2 (a0 - a1 + a2 + a2) - a0
+    des[3] = (int32_t)(((e - a1 + a2) << 1) - a0);
+    des[4] = (int32_t)a2;
+
+}
+
+// Toom-3 interpolation (Bodrato's sequence).
+// This function computes the coefficients of the size-5 product from its values at
+// {0, 1, -1, -2, \infty}. The division by 2 is exact in Z and loses 1 bit in Z_{2^32},
+// so the results are correct modulo 2^31.
+static
+void TC3_interpol(int32_t *des, const int32_t *src){
+
+    uint32_t w0 = src[0], w1 = src[1], wm1 = src[2], wm2 = src[3], winf = src[4];
+    uint32_t r1, r2, r3;
+
+    r3 = (wm2 - w1) * (-1431655765);
+    r1 = (w1 - wm1) >> 1;
+    r2 = wm1 - w0;
+    r3 = ((r2 - r3) >> 1) + (winf << 1);
+    r2 = r2 + r1 - winf;
+    r1 = r1 - r3;
+
+    des[0] = (int32_t)w0;
+    des[1] = (int32_t)r1;
+    des[2] = (int32_t)r2;
+    des[3] = (int32_t)r3;
+    des[4] = (int32_t)winf;
+
+}
+
+// len must be a 3-multiple.
+// This function computes the product of two size-len polynomials in Z_{2^32}[x] / (x^len + 1)
+// via (Z_{2^32}[y] / (y^(len / 3) + 1))[x] / (x^3 - y) and Toom-3 with the point set
+// {0, 1, -1, -2, \infty}.
+static
+void TC3_striding_mul(int32_t *des, const int32_t *src1, const int32_t *src2, size_t len){
+
+    int32_t src1_extended[5][len / 3], src2_extended[5][len / 3];
+    int32_t res[5][len / 3];
+    int32_t TC3_buff[5], TC3_in[3];
+    int32_t twiddle;
+
+    // Apply Toom-3 evaluation.
+    for(size_t i = 0; i < len / 3; i++){
+        for(size_t j = 0; j < 3; j++){
+            TC3_in[j] = src1[i * 3 + j];
+        }
+        TC3_eval(TC3_buff, TC3_in);
+        for(size_t j = 0; j < 5; j++){
+            src1_extended[j][i] = TC3_buff[j];
+        }
+        for(size_t j = 0; j < 3; j++){
+            TC3_in[j] = src2[i * 3 + j];
+        }
+        TC3_eval(TC3_buff, TC3_in);
+        for(size_t j = 0; j < 5; j++){
+            src2_extended[j][i] = TC3_buff[j];
+        }
+    }
+
+    // Compute small-dimensional products.
+    twiddle = -1;
+    for(size_t i = 0; i < 5; i++){
+        naive_mulR((int32_t*)&res[i][0], (int32_t*)&src1_extended[i][0], (int32_t*)&src2_extended[i][0], len / 3, &twiddle, coeff_ring);
+    }
+
+    // Apply Toom-3 interpolation.
+    for(size_t i = 0; i < len / 3; i++){
+        for(size_t j = 0; j < 5; j++){
+            TC3_buff[j] = res[j][i];
+        }
+        TC3_interpol(TC3_buff, TC3_buff);
+        for(size_t j = 0; j < 5; j++){
+            res[j][i] = TC3_buff[j];
+        }
+    }
+
+    // Export the result.
+    for(size_t i = 0; i < len / 3; i++){
+        des[i * 3 + 2] = res[2][i];
+    }
+
+    for(size_t i = 0; i < len / 3 - 1; i++){
+        for(size_t j = 3; j < 5; j++){
+            des[(i + 1) * 3 + j - 3] = res[j - 3][i + 1] + res[j][i];
+        }
+    }
+
+    for(size_t j = 3; j < 5; j++){
+        des[j - 3] = res[j - 3][0] - res[j][len / 3 - 1];
+    }
+
+}
+
 int main(void){
 
     int32_t poly1[ARRAY_N], poly2[ARRAY_N];
@@ -326,6 +520,31 @@ int main(void){
         assert(ref[i] == res[i]);
     }
 
+    // Compute the product in Z_{2^32}[x] / (x^(3 (ARRAY_N / 4)) + 1) via
+    // striding followed by Toom-3 with the point set {0, 1, -1, -2, \infty}.
+    naive_mulR(ref, poly1, poly2, 3 * (ARRAY_N / 4), &twiddle, coeff_ring);
+    TC3_striding_mul(res, poly1, poly2, 3 * (ARRAY_N / 4));
+    for(size_t i = 0; i < 3 * (ARRAY_N / 4); i++){
+        cmod_int32(ref + i, ref + i, &mod);
+        cmod_int32(res + i, res + i, &mod);
+        assert(ref[i] == res[i]);
+    }
+
+    // Compare the straight-line Toom-4 evaluation with the matrix.
+    for(size_t k = 0; k < 16; k++){
+
+        int32_t w[7], w_ref[7], in[7] = {0};
+
+        for(size_t j = 0; j < 4; j++){
+            in[j] = rand();
+        }
+
+        TC4_eval(w, in);
+        matrix_vector_mul(w_ref, (int32_t*)&TC4_trunc[0][0], in, 7);
+        assert(memcmp(w, w_ref, sizeof(w)) == 0);
+
+    }
+
     printf("Test finished!\n");
 
 
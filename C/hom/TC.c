@@ -21,10 +21,27 @@
    by the correct constants. For example, 3 * a can be implemented as
    a + (a << 1) and 9 * a can beimplemented as a + (a << 3).
    With such optimization, we save the memory operations loading the matrices.
+   See TC4_eval, TC4_interpol, TC3_eval, and TC3_interpol for straight-line sequences.
+   Only the divisions by odd constants remain multiplications (by the inverses).
 
 2. Notice that point set is carefully chosen. In principle, when an integer z
    is chosen, we also choose -z. So evaluating a polynomial at {z, -z} will be faster
    by first evaluating for the odds and evens individually and applying an add-sub pair.
+   TC3_eval, TC4_eval, and TC5_eval evaluate the pairs this way, and the interpolations
+   start by recovering the even and odd parts with one add-sub pair and a shift.
+   Toom-5 pairs 1, 2, and 1/2 so that only the point 3 is evaluated with Horner's rule.
+
+3. If an operand is reused, for example the public matrix or the secret, evaluate it once
+   with TC_prepare and multiply with TC_mul_prepared. This saves one of the two evaluations.
+
+   For inner products sum_i a_i b_i, as in the matrix-vector products of Saber, accumulate
+   the products in the evaluated domain with TC_mul_acc and interpolate once with TC_interpol
+   (TC_inner_prod_prepared). With prepared b_i, a length-l inner product costs l evaluations,
+   7 l small products, and one interpolation instead of l interpolations.
+
+4. For lengths that are not multiples of 4, pad to the next multiple of 4 (TC_mul_any) instead of
+   padding to the next power of two. For unbalanced products, cut the longer operand into chunks
+   of the size of the shorter one (TC_mul_unbalanced).
 
 */
 
@@ -197,74 +214,555 @@ void matrix_vector_mul(int32_t *des, int32_t *srcM, int32_t *srcV, size_t len){
 
 }
 
-// len must be a 4-multiple.
-// This function computes the product of two size-len polynomials in Z_{2^32}[x]
-// using Toom-4 with the point set {0, 1, -1, 2, -2, 1/2, \infty}.
-// Notice that matrices are modifed to ensure the well-defineness over Z_{2^32}.
+// ================
+// Straight-line Toom-4 with shifts and additions.
+// The matrices TC4, TC4_trunc, and iTC4 are kept as the reference.
+// The straight-line sequences of Toom-3, Toom-4, and Toom-5 compute in uint32_t, where left
+// shifts of negative values and wrap-arounds are defined, and convert to int32_t at the end.
+// The right shifts are logical; they are exact divisions modulo the remaining precision.
+
+// Toom-4 evaluation at {0, 1, -1, 2, -2, 1/2, \infty}.
+// This function computes TC4_trunc (src[0], src[1], src[2], src[3], 0, 0, 0)^T
+// without multiplications. The point 1/2 is scaled by 8.
+// For each pair {z, -z}, the even part e and the odd part o are computed once
+// and the values are e + o and e - o.
 static
-void TC_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t len){
+void TC4_eval(int32_t *des, const int32_t *src){
+
+    uint32_t a0 = src[0], a1 = src[1], a2 = src[2], a3 = src[3];
+    uint32_t e, o;
+
+    des[0] = (int32_t)a0;
+    // {1, -1}
+    e = a0 + a2;
+    o = a1 + a3;
+    des[1] = (int32_t)(e + o);
+    des[2] = (int32_t)(e - o);
+    // {2, -2}
+    e = a0 + (a2 << 2);
+    o = (a1 << 1) + (a3 << 3);
+    des[3] = (int32_t)(e + o);
+    des[4] = (int32_t)(e - o);
+    // Horner's rule with shifts.
+    des[5] = (int32_t)((((((a0 << 1) + a1) << 1) + a2) << 1) + a3);
+    des[6] = (int32_t)a3;
 
-    int32_t src1_extended[7][len / 4], src2_extended[7][len / 4];
-    int32_t res[7][2 * len / 4];
-    int32_t TC4_buff[7];
+}
+
+// Toom-4 interpolation.
+// This function computes iTC4 src followed by the divisions by powers of two in TC_mul,
+// i.e., the coefficients of the size-7 product from its values at {0, 1, -1, 2, -2, 1/2, \infty}
+// where the value at 1/2 is scaled by 64.
+// The divisions by powers of two are exact in Z and lose 3 bits in Z_{2^32}, so the
+// results are correct modulo 2^29. The divisions by 3 and 45 are multiplications by the inverses.
+static
+void TC4_interpol(int32_t *des, const int32_t *src){
+
+    uint32_t w0 = src[0], w1 = src[1], w2 = src[2], w3 = src[3], w4 = src[4], w5 = src[5], w6 = src[6];
+    uint32_t e1, o1, e2, o2, a, b, p, u;
+    uint32_t c1, c2, c3, c4, c5;
+
+    // Split the pairs {1, -1} and {2, -2} into the even and odd parts.
+    // c0 + c2 + c4 + c6 and c1 + c3 + c5.
+    e1 = (w1 + w2) >> 1;
+    o1 = (w1 - w2) >> 1;
+    // c0 + 4 c2 + 16 c4 + 64 c6 and c1 + 4 c3 + 16 c5.
+    e2 = (w3 + w4) >> 1;
+    o2 = (w3 - w4) >> 2;
+
+    // The even coefficients: a = c2 + c4 and b = 4 c2 + 16 c4.
+    a = e1 - w0 - w6;
+    b = e2 - w0 - (w6 << 6);
+    c4 = ((b - (a << 2)) >> 2) * (-1431655765);
+    c2 = a - c4;
+
+    // The odd coefficients: p = 16 c1 + 4 c3 + c5 and u = c3 + 5 c5.
+    p = (w5 - (w0 << 6) - (c2 << 4) - (c4 << 2) - w6) >> 1;
+    u = (o2 - o1) * (-1431655765);
+    c5 = (p - (o1 << 4) + (u << 3) + (u << 2)) * (-1527099483);
+    c3 = u - c5 - (c5 << 2);
+    c1 = o1 - c3 - c5;
+
+    des[0] = (int32_t)w0;
+    des[1] = (int32_t)c1;
+    des[2] = (int32_t)c2;
+    des[3] = (int32_t)c3;
+    des[4] = (int32_t)c4;
+    des[5] = (int32_t)c5;
+    des[6] = (int32_t)w6;
 
-    memset(src1_extended, 0, sizeof(src1_extended));
-    memset(src2_extended, 0, sizeof(src2_extended));
+}
+
+// len must be a 4-multiple.
+// This function evaluates the size-len polynomial src with TC4_eval
+// and stores the 7 size-(len / 4) polynomials at des.
+// The output is the prepared operand for TC_mul_prepared. If one operand is multiplied
+// by many polynomials, it is prepared once and the evaluation is skipped afterwards.
+static
+void TC_prepare(int32_t *des, const int32_t *src, size_t len){
 
-    memmove(src1_extended, src1, len * sizeof(int32_t));
-    memmove(src2_extended, src2, len * sizeof(int32_t));
+    int32_t src_extended[7][len / 4];
+    int32_t TC4_buff[7], TC4_in[4];
 
-    // Apply Toom-4 evaluation matrix.
+    // Apply Toom-4 evaluation.
     for(size_t i = 0; i < len / 4; i++){
-        for(size_t j = 0; j < 7; j++){
-            TC4_buff[j] = src1_extended[j][i];
+        for(size_t j = 0; j < 4; j++){
+            TC4_in[j] = src[j * (len / 4) + i];
         }
-        matrix_vector_mul(TC4_buff, (int32_t*)&TC4_trunc[0][0], TC4_buff, 7);
+        TC4_eval(TC4_buff, TC4_in);
         for(size_t j = 0; j < 7; j++){
-            src1_extended[j][i] = TC4_buff[j];
+            src_extended[j][i] = TC4_buff[j];
         }
     }
 
-    for(size_t i = 0; i < len / 4; i++){
+    memmove(des, src_extended, sizeof(src_extended));
+
+}
+
+// len must be a 4-multiple.
+// This function multiplies the prepared polynomials src1_prepared and src2_prepared point-wise
+// and adds the 7 size-(2 (len / 4) - 1) products to acc, i.e., the product stays in the
+// evaluated domain. Sums of products are accumulated in acc and interpolated once with
+// TC_interpol.
+static
+void TC_mul_acc(int32_t *acc, const int32_t *src1_prepared, const int32_t *src2_prepared, size_t len){
+
+    int32_t res[2 * (len / 4) - 1];
+
+    // Compute small-dimensional products.
+    for(size_t i = 0; i < 7; i++){
+        naive_mul_long(res, (int32_t*)src1_prepared + i * (len / 4), (int32_t*)src2_prepared + i * (len / 4), len / 4, coeff_ring);
+        for(size_t j = 0; j < 2 * (len / 4) - 1; j++){
+            acc[i * (2 * (len / 4) - 1) + j] += res[j];
+        }
+    }
+
+}
+
+// len must be a 4-multiple.
+// This function interpolates the 7 size-(2 (len / 4) - 1) polynomials acc accumulated by
+// TC_mul_acc and stores the size-(2 len - 1) result at des. acc is overwritten.
+static
+void TC_interpol(int32_t *des, int32_t *acc, size_t len){
+
+    size_t m = len / 4;
+    int32_t TC4_buff[7];
+
+    // Apply Toom-4 interpolation.
+    for(size_t i = 0; i < 2 * m - 1; i++){
         for(size_t j = 0; j < 7; j++){
-            TC4_buff[j] = src2_extended[j][i];
+            TC4_buff[j] = acc[j * (2 * m - 1) + i];
         }
-        matrix_vector_mul(TC4_buff, (int32_t*)&TC4_trunc[0][0], TC4_buff, 7);
+        TC4_interpol(TC4_buff, TC4_buff);
         for(size_t j = 0; j < 7; j++){
-            src2_extended[j][i] = TC4_buff[j];
+            acc[j * (2 * m - 1) + i] = TC4_buff[j];
         }
     }
 
-    // Compute small-dimensional products.
+    memset(des, 0, (2 * len - 1) * sizeof(int32_t));
+
+    // Export the result.
     for(size_t i = 0; i < 7; i++){
-        naive_mul_long((int32_t*)&res[i][0], (int32_t*)&src1_extended[i][0], (int32_t*)&src2_extended[i][0], len / 4, coeff_ring);
+        for(size_t j = 0; j < 2 * m - 1; j++){
+            des[i * m + j] += acc[i * (2 * m - 1) + j];
+        }
     }
 
-    // Apply Toom-4 inversion matrix.
-    for(size_t i = 0; i < len / 2; i++){
-        for(size_t j = 0; j < 7; j++){
-            TC4_buff[j] = res[j][i];
-        }
-        matrix_vector_mul(TC4_buff, (int32_t*)&iTC4[0][0], TC4_buff, 7);
-        // Divide by powers of two.
-        res[0][i] = TC4_buff[0];
-        res[1][i] = TC4_buff[1] >> 2;
-        res[2][i] = TC4_buff[2] >> 3;
-        res[3][i] = TC4_buff[3] >> 1;
-        res[4][i] = TC4_buff[4] >> 3;
-        res[5][i] = TC4_buff[5] >> 2;
-        res[6][i] = TC4_buff[6];
+}
+
+// len must be a 4-multiple.
+// This function computes the product of the size-len polynomial src1 and the polynomial
+// prepared by TC_prepare in Z_{2^32}[x].
+static
+void TC_mul_prepared(int32_t *des, const int32_t *src1, const int32_t *src2_prepared, size_t len){
+
+    int32_t src1_prepared[7 * (len / 4)];
+    int32_t acc[7 * (2 * (len / 4) - 1)];
+
+    TC_prepare(src1_prepared, src1, len);
+
+    memset(acc, 0, sizeof(acc));
+    TC_mul_acc(acc, src1_prepared, src2_prepared, len);
+    TC_interpol(des, acc, len);
+
+}
+
+// len must be a 4-multiple.
+// This function computes the inner product sum_i src1[i] src2[i] of two length-count vectors
+// of size-len polynomials in Z_{2^32}[x] with lazy interpolation: src1[i] is
+// evaluated, the products with the prepared src2_prepared[i] are accumulated in the evaluated
+// domain, and the sum is interpolated once.
+// src1 holds count * len coefficients and src2_prepared holds count * 7 * (len / 4) values.
+static
+void TC_inner_prod_prepared(int32_t *des, const int32_t *src1, const int32_t *src2_prepared, size_t count, size_t len){
+
+    int32_t src1_prepared[7 * (len / 4)];
+    int32_t acc[7 * (2 * (len / 4) - 1)];
+
+    memset(acc, 0, sizeof(acc));
+
+    for(size_t i = 0; i < count; i++){
+        TC_prepare(src1_prepared, src1 + i * len, len);
+        TC_mul_acc(acc, src1_prepared, src2_prepared + i * 7 * (len / 4), len);
+    }
+
+    TC_interpol(des, acc, len);
+
+}
+
+// len must be a 4-multiple.
+// This function computes the product of two size-len polynomials in Z_{2^32}[x]
+// using Toom-4 with the point set {0, 1, -1, 2, -2, 1/2, \infty}.
+// The evaluation and interpolation are straight-line sequences of shifts and additions.
+static
+void TC_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t len){
+
+    int32_t src2_prepared[7 * (len / 4)];
+
+    TC_prepare(src2_prepared, src2, len);
+    TC_mul_prepared(des, src1, src2_prepared, len);
+
+}
+
+// len is arbitrary.
+// This function computes the product of two size-len polynomials in Z_{2^32}[x]
+// with TC_mul by zero-padding the inputs to 4 m coefficients where m = ceil(len / 4).
+// At most 3 zeros are appended instead of padding to the next power of two. The padding may
+// fall into the lower limbs (e.g. len = 5 gives m = 2 and limbs of 2, 2, 1, and 0 coefficients).
+static
+void TC_mul_any(int32_t *des, const int32_t *src1, const int32_t *src2, size_t len){
+
+    size_t m = (len + 3) / 4;
+    int32_t src1_padded[4 * m], src2_padded[4 * m];
+    int32_t res[8 * m - 1];
+
+    memset(src1_padded, 0, sizeof(src1_padded));
+    memset(src2_padded, 0, sizeof(src2_padded));
+    memmove(src1_padded, src1, len * sizeof(int32_t));
+    memmove(src2_padded, src2, len * sizeof(int32_t));
+
+    TC_mul(res, src1_padded, src2_padded, 4 * m);
+
+    memmove(des, res, (2 * len - 1) * sizeof(int32_t));
+
+}
+
+// This function computes the product of the size-len1 polynomial src1 and the size-len2
+// polynomial src2 in Z_{2^32}[x] with len1, len2 > 0. The result consists of len1 + len2 - 1 coefficients.
+// The longer operand is cut into chunks of the size of the shorter one, and each chunk is multiplied
+// with TC_mul_any. The remaining shorter chunk is multiplied recursively with the roles swapped.
+// Operands shorter than 4 are multiplied with the schoolbook method.
+static
+void TC_mul_unbalanced(int32_t *des, const int32_t *src1, size_t len1, const int32_t *src2, size_t len2){
+
+    if(len1 < len2){
+        TC_mul_unbalanced(des, src2, len2, src1, len1);
+        return;
+    }
+
+    size_t q = len1 / len2;
+    size_t r = len1 % len2;
+    int32_t prod[2 * len2 - 1];
+
+    memset(des, 0, (len1 + len2 - 1) * sizeof(int32_t));
+
+    if(len2 < 4){
+        for(size_t i = 0; i < len1; i++){
+            for(size_t j = 0; j < len2; j++){
+                des[i + j] += src1[i] * src2[j];
+            }
+        }
+        return;
+    }
+
+    for(size_t c = 0; c < q; c++){
+        TC_mul_any(prod, src1 + c * len2, src2, len2);
+        for(size_t i = 0; i < 2 * len2 - 1; i++){
+            des[c * len2 + i] += prod[i];
+        }
+    }
+
+    if(r){
+        TC_mul_unbalanced(prod, src2, len2, src1 + q * len2, r);
+        for(size_t i = 0; i < len2 + r - 1; i++){
+            des[q * len2 + i] += prod[i];
+        }
+    }
+
+}
+
+// ================
+// Straight-line Toom-3 with the point set {0, 1, -1, -2, \infty}.
+/*
+
+Evaluation matrix
+
+1,  0, 0
+1,  1, 1
+1, -1, 1
+1, -2, 4
+0,  0, 1
+
+*/
+
+// Toom-3 evaluation of (src[0], src[1], src[2]) at {0, 1, -1, -2, \infty}.
+static
+void TC3_eval(int32_t *des, const int32_t *src){
+
+    uint32_t a0 = src[0], a1 = src[1], a2 = src[2];
+    uint32_t e;
+
+    des[0] = (int32_t)a0;
+    // {1, -1}
+    e = a0 + a2;
+    des[1] = (int32_t)(e + a1);
+    des[2] = (int32_t)(e - a1);
+    // a0 - 2 a1 + 4 a2 = 2 (a0 - a1 + a2 + a2) - a0
+    des[3] = (int32_t)(((e - a1 + a2) << 1) - a0);
+    des[4] = (int32_t)a2;
+
+}
+
+// Toom-3 interpolation (Bodrato's sequence).
+// This function computes the coefficients of the size-5 product from its values at
+// {0, 1, -1, -2, \infty}. The division by 2 is exact in Z and loses 1 bit in Z_{2^32},
+// so the results are correct modulo 2^31.
+static
+void TC3_interpol(int32_t *des, const int32_t *src){
+
+    uint32_t w0 = src[0], w1 = src[1], wm1 = src[2], wm2 = src[3], winf = src[4];
+    uint32_t r1, r2, r3;
+
+    r3 = (wm2 - w1) * (-1431655765);
+    r1 = (w1 - wm1) >> 1;
+    r2 = wm1 - w0;
+    r3 = ((r2 - r3) >> 1) + (winf << 1);
+    r2 = r2 + r1 - winf;
+    r1 = r1 - r3;
+
+    des[0] = (int32_t)w0;
+    des[1] = (int32_t)r1;
+    des[2] = (int32_t)r2;
+    des[3] = (int32_t)r3;
+    des[4] = (int32_t)winf;
+
+}
+
+// len must be a 3-multiple.
+// This function computes the product of two size-len polynomials in Z_{2^32}[x]
+// using Toom-3 with the point set {0, 1, -1, -2, \infty}.
+static
+void TC3_mul(int32_t *des, const int32_t *src1, const int32_t *src2, size_t len){
+
+    int32_t src1_extended[5][len / 3], src2_extended[5][len / 3];
+    int32_t res[5][2 * len / 3];
+    int32_t TC3_buff[5], TC3_in[3];
+
+    // Apply Toom-3 evaluation.
+    for(size_t i = 0; i < len / 3; i++){
+        for(size_t j = 0; j < 3; j++){
+            TC3_in[j] = src1[j * (len / 3) + i];
+        }
+        TC3_eval(TC3_buff, TC3_in);
+        for(size_t j = 0; j < 5; j++){
+            src1_extended[j][i] = TC3_buff[j];
+        }
+        for(size_t j = 0; j < 3; j++){
+            TC3_in[j] = src2[j * (len / 3) + i];
+        }
+        TC3_eval(TC3_buff, TC3_in);
+        for(size_t j = 0; j < 5; j++){
+            src2_extended[j][i] = TC3_buff[j];
+        }
+    }
+
+    // Compute small-dimensional products.
+    for(size_t i = 0; i < 5; i++){
+        naive_mul_long((int32_t*)&res[i][0], (int32_t*)&src1_extended[i][0], (int32_t*)&src2_extended[i][0], len / 3, coeff_ring);
+    }
+
+    // Apply Toom-3 interpolation.
+    for(size_t i = 0; i < 2 * len / 3 - 1; i++){
+        for(size_t j = 0; j < 5; j++){
+            TC3_buff[j] = res[j][i];
+        }
+        TC3_interpol(TC3_buff, TC3_buff);
+        for(size_t j = 0; j < 5; j++){
+            res[j][i] = TC3_buff[j];
+        }
     }
 
     memset(des, 0, (2 * len - 1) * sizeof(int32_t));
 
     // Export the result.
-    for(size_t i = 0; i < 7; i++){
-        for(size_t j = 0; j < (len / 2) - 1; j++){
-            des[i * len / 4 + j] += res[i][j];
+    for(size_t i = 0; i < 5; i++){
+        for(size_t j = 0; j < 2 * len / 3 - 1; j++){
+            des[i * len / 3 + j] += res[i][j];
+        }
+    }
+
+}
+
+// ================
+// Straight-line Toom-5 with the point set {0, 1, -1, 2, -2, 1/2, -1/2, 3, \infty}.
+/*
+
+The points 1, 2, and 1/2 are paired with their negations. For a pair {z, -z},
+the evaluation computes the even part e and the odd part o once and outputs e + o and e - o.
+The interpolation recovers (e, o) with one add-sub pair, and then solves
+two small systems: c2, c4, c6 from the even parts and c1, c3, c5, c7 from the odd
+parts together with the value at 3.
+
+*/
+
+// Toom-5 evaluation of (src[0], ..., src[4]) at {0, 1, -1, 2, -2, 1/2, -1/2, 3, \infty}.
+// The points 1/2 and -1/2 are scaled by 16.
+static
+void TC5_eval(int32_t *des, const int32_t *src){
+
+    uint32_t a0 = src[0], a1 = src[1], a2 = src[2], a3 = src[3], a4 = src[4];
+    uint32_t e, o;
+
+    des[0] = (int32_t)a0;
+    // {1, -1}
+    e = a0 + a2 + a4;
+    o = a1 + a3;
+    des[1] = (int32_t)(e + o);
+    des[2] = (int32_t)(e - o);
+    // {2, -2}
+    e = a0 + (a2 << 2) + (a4 << 4);
+    o = (a1 << 1) + (a3 << 3);
+    des[3] = (int32_t)(e + o);
+    des[4] = (int32_t)(e - o);
+    // {1/2, -1/2}
+    e = (a0 << 4) + (a2 << 2) + a4;
+    o = (a1 << 3) + (a3 << 1);
+    des[5] = (int32_t)(e + o);
+    des[6] = (int32_t)(e - o);
+    // 3 with Horner's rule.
+    e = a4;
+    e = (e << 1) + e + a3;
+    e = (e << 1) + e + a2;
+    e = (e << 1) + e + a1;
+    des[7] = (int32_t)((e << 1) + e + a0);
+    des[8] = (int32_t)a4;
+
+}
+
+// Toom-5 interpolation.
+// This function computes the coefficients of the size-9 product from its values at
+// {0, 1, -1, 2, -2, 1/2, -1/2, 3, \infty} where the values at 1/2 and -1/2 are scaled by 256.
+// The divisions by powers of two are exact in Z. The longest chain loses 6 bits in Z_{2^32},
+// so the results are correct modulo 2^26. The divisions by 3, 5, 15, and 35 are multiplications
+// by the inverses.
+static
+void TC5_interpol(int32_t *des, const int32_t *src){
+
+    uint32_t w0 = src[0], w1 = src[1], w2 = src[2], w3 = src[3], w4 = src[4];
+    uint32_t w5 = src[5], w6 = src[6], w7 = src[7], w8 = src[8];
+    uint32_t e1, o1, e2, o2, eh, oh;
+    uint32_t a, b, c, x, y, o3, p, u, v;
+    uint32_t c1, c2, c3, c4, c5, c6, c7;
+
+    // Split the pairs into the even and odd parts.
+    // c0 + c2 + c4 + c6 + c8 and c1 + c3 + c5 + c7.
+    e1 = (w1 + w2) >> 1;
+    o1 = (w1 - w2) >> 1;
+    // c0 + 4 c2 + 16 c4 + 64 c6 + 256 c8 and c1 + 4 c3 + 16 c5 + 64 c7.
+    e2 = (w3 + w4) >> 1;
+    o2 = (w3 - w4) >> 2;
+    // 256 c0 + 64 c2 + 16 c4 + 4 c6 + c8 and 64 c1 + 16 c3 + 4 c5 + c7.
+    eh = (w5 + w6) >> 1;
+    oh = (w5 - w6) >> 2;
+
+    // The even coefficients:
+    // a = c2 + c4 + c6, b = c2 + 4 c4 + 16 c6, c = 16 c2 + 4 c4 + c6.
+    a = e1 - w0 - w8;
+    b = (e2 - w0 - (w8 << 8)) >> 2;
+    c = (eh - (w0 << 8) - w8) >> 2;
+    // x = c4 + 5 c6 and y = 5 c2 + c4.
+    x = (b - a) * (-1431655765);
+    y = (c - a) * (-1431655765);
+    c4 = ((a << 2) + a - x - y) * (-1431655765);
+    c6 = (x - c4) * (-858993459);
+    c2 = (y - c4) * (-858993459);
+
+    // The odd coefficients:
+    // o3 = c1 + 9 c3 + 81 c5 + 729 c7, p = c3 + 5 c5 + 21 c7, u = c5 + 14 c7,
+    // and v = -(4 c5 + 21 c7).
+    o3 = (w7 - w0 - 9 * c2 - 81 * c4 - 729 * c6 - 6561 * w8) * (-1431655765);
+    p = (o2 - o1) * (-1431655765);
+    u = (((o3 - o1) >> 3) - p) * (-858993459);
+    v = (((o1 << 6) - oh) * (-1431655765) - (p << 4)) * (-286331153);
+    c7 = ((u << 2) + v) * (-1963413621);
+    c5 = u - 14 * c7;
+    c3 = p - 5 * c5 - 21 * c7;
+    c1 = o1 - c3 - c5 - c7;
+
+    des[0] = (int32_t)w0;
+    des[1] = (int32_t)c1;
+    des[2] = (int32_t)c2;
+    des[3] = (int32_t)c3;
+    des[4] = (int32_t)c4;
+    des[5] = (int32_t)c5;
+    des[6] = (int32_t)c6;
+    des[7] = (int32_t)c7;
+    des[8] = (int32_t)w8;
+
+}
+
+// len must be a 5-multiple.
+// This function computes the product of two size-len polynomials in Z_{2^32}[x]
+// using Toom-5 with the point set {0, 1, -1, 2, -2, 1/2, -1/2, 3, \infty}.
+static
+void TC5_mul(int32_t *des, const int32_t *src1, const int32_t *src2, size_t len){
+
+    int32_t src1_extended[9][len / 5], src2_extended[9][len / 5];
+    int32_t res[9][2 * len / 5];
+    int32_t TC5_buff[9], TC5_in[5];
+
+    // Apply Toom-5 evaluation.
+    for(size_t i = 0; i < len / 5; i++){
+        for(size_t j = 0; j < 5; j++){
+            TC5_in[j] = src1[j * (len / 5) + i];
+        }
+        TC5_eval(TC5_buff, TC5_in);
+        for(size_t j = 0; j < 9; j++){
+            src1_extended[j][i] = TC5_buff[j];
+        }
+        for(size_t j = 0; j < 5; j++){
+            TC5_in[j] = src2[j * (len / 5) + i];
+        }
+        TC5_eval(TC5_buff, TC5_in);
+        for(size_t j = 0; j < 9; j++){
+            src2_extended[j][i] = TC5_buff[j];
         }
     }
 
+    // Compute small-dimensional products.
+    for(size_t i = 0; i < 9; i++){
+        naive_mul_long((int32_t*)&res[i][0], (int32_t*)&src1_extended[i][0], (int32_t*)&src2_extended[i][0], len / 5, coeff_ring);
+    }
+
+    // Apply Toom-5 interpolation.
+    for(size_t i = 0; i < 2 * len / 5 - 1; i++){
+        for(size_t j = 0; j < 9; j++){
+            TC5_buff[j] = res[j][i];
+        }
+        TC5_interpol(TC5_buff, TC5_buff);
+        for(size_t j = 0; j < 9; j++){
+            res[j][i] = TC5_buff[j];
+        }
+    }
+
+    memset(des, 0, (2 * len - 1) * sizeof(int32_t));
+
+    // Export the result.
+    for(size_t i = 0; i < 9; i++){
+        for(size_t j = 0; j < 2 * len / 5 - 1; j++){
+            des[i * len / 5 + j] += res[i][j];
+        }
+    }
 
 }
 
@@ -301,6 +799,149 @@ int main(void){
         assert(ref[i] == res[i]);
     }
 
+    // Prepare poly2 once and multiply it by several polynomials.
+    int32_t poly2_prepared[7 * (ARRAY_N / 4)];
+
+    TC_prepare(poly2_prepared, poly2, ARRAY_N);
+
+    for(size_t k = 0; k < 4; k++){
+
+        for(size_t i = 0; i < ARRAY_N; i++){
+            t = rand();
+            coeff_ring.memberZ(poly1 + i, &t);
+        }
+
+        naive_mul_long(ref, poly1, poly2, ARRAY_N, coeff_ring);
+        TC_mul_prepared(res, poly1, poly2_prepared, ARRAY_N);
+
+        for(size_t i = 0; i < 2 * ARRAY_N - 1; i++){
+            cmod_int32(ref + i, ref + i, &mod);
+            cmod_int32(res + i, res + i, &mod);
+            assert(ref[i] == res[i]);
+        }
+
+    }
+
+    // Inner product of length 3 with lazy interpolation.
+    int32_t vec1[3 * ARRAY_N], vec2[3 * ARRAY_N];
+    int32_t vec2_prepared[3 * 7 * (ARRAY_N / 4)];
+
+    for(size_t i = 0; i < 3 * ARRAY_N; i++){
+        t = rand();
+        coeff_ring.memberZ(vec1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(vec2 + i, &t);
+    }
+
+    memset(ref, 0, sizeof(ref));
+    for(size_t k = 0; k < 3; k++){
+        naive_mul_long(res, vec1 + k * ARRAY_N, vec2 + k * ARRAY_N, ARRAY_N, coeff_ring);
+        for(size_t i = 0; i < 2 * ARRAY_N - 1; i++){
+            ref[i] += res[i];
+        }
+        TC_prepare(vec2_prepared + k * 7 * (ARRAY_N / 4), vec2 + k * ARRAY_N, ARRAY_N);
+    }
+
+    TC_inner_prod_prepared(res, vec1, vec2_prepared, 3, ARRAY_N);
+
+    for(size_t i = 0; i < 2 * ARRAY_N - 1; i++){
+        cmod_int32(ref + i, ref + i, &mod);
+        cmod_int32(res + i, res + i, &mod);
+        assert(ref[i] == res[i]);
+    }
+
+    // Compare the straight-line Toom-4 with the matrices.
+    for(size_t k = 0; k < 16; k++){
+
+        int32_t coeff[7], w[7], w_ref[7], in[7] = {0};
+
+        for(size_t j = 0; j < 7; j++){
+            coeff[j] = rand();
+        }
+        for(size_t j = 0; j < 4; j++){
+            in[j] = coeff[j];
+        }
+
+        TC4_eval(w, in);
+        matrix_vector_mul(w_ref, (int32_t*)&TC4_trunc[0][0], in, 7);
+        assert(memcmp(w, w_ref, sizeof(w)) == 0);
+
+        // The values of a size-7 polynomial at the points.
+        matrix_vector_mul(w, (int32_t*)&TC4[0][0], coeff, 7);
+        matrix_vector_mul(w_ref, (int32_t*)&iTC4[0][0], w, 7);
+        w_ref[1] >>= 2;
+        w_ref[2] >>= 3;
+        w_ref[3] >>= 1;
+        w_ref[4] >>= 3;
+        w_ref[5] >>= 2;
+        TC4_interpol(w, w);
+
+        for(size_t j = 0; j < 7; j++){
+            cmod_int32(w + j, w + j, &mod);
+            cmod_int32(w_ref + j, w_ref + j, &mod);
+            cmod_int32(coeff + j, coeff + j, &mod);
+            assert(w[j] == w_ref[j]);
+            assert(w[j] == coeff[j]);
+        }
+
+    }
+
+    // Toom-3 for the first 3 (ARRAY_N / 4) coefficients.
+    naive_mul_long(ref, poly1, poly2, 3 * (ARRAY_N / 4), coeff_ring);
+    TC3_mul(res, poly1, poly2, 3 * (ARRAY_N / 4));
+    for(size_t i = 0; i < 2 * 3 * (ARRAY_N / 4) - 1; i++){
+        cmod_int32(ref + i, ref + i, &mod);
+        cmod_int32(res + i, res + i, &mod);
+        assert(ref[i] == res[i]);
+    }
+
+    // Toom-5 for the first 5 (ARRAY_N / 8) coefficients.
+    // The results are compared modulo 2^26.
+    int32_t mod5 = 1 << 26;
+
+    naive_mul_long(ref, poly1, poly2, 5 * (ARRAY_N / 8), coeff_ring);
+    TC5_mul(res, poly1, poly2, 5 * (ARRAY_N / 8));
+    for(size_t i = 0; i < 2 * 5 * (ARRAY_N / 8) - 1; i++){
+        cmod_int32(ref + i, ref + i, &mod5);
+        cmod_int32(res + i, res + i, &mod5);
+        assert(ref[i] == res[i]);
+    }
+
+    // Odd and unbalanced lengths.
+    size_t lens[4][2] = {{509, 509}, {677, 677}, {761, 509}, {821, 96}};
+    int32_t long1[821], long2[821], long_ref[2 * 821], long_res[2 * 821];
+
+    for(size_t k = 0; k < 4; k++){
+
+        size_t len1 = lens[k][0], len2 = lens[k][1];
+
+        memset(long2, 0, sizeof(long2));
+        for(size_t i = 0; i < len1; i++){
+            t = rand();
+            coeff_ring.memberZ(long1 + i, &t);
+        }
+        for(size_t i = 0; i < len2; i++){
+            t = rand();
+            coeff_ring.memberZ(long2 + i, &t);
+        }
+
+        // The reference is the product with the shorter operand padded with zeros.
+        naive_mul_long(long_ref, long1, long2, len1, coeff_ring);
+
+        if(len1 == len2){
+            TC_mul_any(long_res, long1, long2, len1);
+        }else{
+            TC_mul_unbalanced(long_res, long1, len1, long2, len2);
+        }
+
+        for(size_t i = 0; i < len1 + len2 - 1; i++){
+            cmod_int32(long_ref + i, long_ref + i, &mod);
+            cmod_int32(long_res + i, long_res + i, &mod);
+            assert(long_ref[i] == long_res[i]);
+        }
+
+    }
+
     printf("Test finished!\n");
 
 
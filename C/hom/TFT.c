@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// ================
+// This file demonstrates the truncated Fourier transform (TFT) and its inverse for computing
+// products of size-761 polynomials in Z_Q[x] with a size-2048 cyclic NTT.
+
+// ================
+// Theory.
+// Let N be a power of two and l <= N. The Cooley--Tukey FFT evaluates a polynomial at
+// omega^brv(0), omega^brv(1), ..., omega^brv(N - 1) where brv reverses log_2 N bits.
+// If the product has less than l coefficients, the first l evaluations already determine it.
+// The TFT computes only these l outputs and skips all the butterflies whose outputs are not
+// needed. Furthermore, the zero inputs at the positions [l_in, N) are never loaded.
+// For the inverse, consider a block of size 2m with the inputs (x_j, x_{j + m}) and the
+// twiddle factor w. The children hold y_j = x_j + w x_{j + m} and z_j = x_j - w x_{j + m}.
+// Suppose we know the outputs at the positions [0, k) and the inputs at [k, 2m).
+// - If k <= m: for j >= k, y_j = x_j + w x_{j + m} is known. We recursively invert the first
+//   child with k outputs and recover x_j = y_j - w x_{j + m}.
+// - If k > m: we invert the first child completely. For j >= k - m, x_{j + m} is known, so
+//   x_j = y_j - w x_{j + m} and z_j = x_j - w x_{j + m}. We recursively invert the second child
+//   with k - m outputs and recover x_j = (y_j + z_j) / 2 and x_{j + m} = (y_j - z_j) / (2 w)
+//   for j < k - m.
+// Both directions cost O(l log N) operations, so the cost grows smoothly with l [vdH04].
+
+// ================
+// A small example.
+// Let N = 4 and l = 3. The forward transformation computes
+// (x_0 + w x_2, x_1 + w x_3, x_0 - w x_2, x_1 - w x_3)
+// but only the first output of the second block is needed, so the butterfly on
+// (x_1 - w x_3) is skipped in the second layer.
+
+// ================
+// Optimization guide.
+/*
+
+1. The multiplications by 1 / 2 in the inverse can be merged into the twiddle factors
+   or deferred to the end of the computation.
+
+2. Below a certain size, switch to the full transformation for the remaining blocks.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+// NTRU Prime multiplies size-761 polynomials. The product contains 1521 coefficients,
+// so the power-of-two NTT must be of size 2048.
+
+#define ARRAY_N 2048
+#define NTT_N 2048
+#define LOGNTT_N 11
+
+#define POLY_N 761
+
+#define Q (12289)
+
+// OMEGA is a principal NTT_N-th root of unity in Z_Q.
+#define OMEGA (1945)
+#define OMEGA_INV (4050)
+#define INV2 (-6144)
+
+// ================
+// Z_Q
+
+int16_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int16(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int16(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int16(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int16(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int16(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+
+int16_t twiddle_table[NTT_N - 1];
+int16_t itwiddle_table[NTT_N - 1];
+
+// Multiply size-len polynomials with TFT and compare against the schoolbook multiplication.
+static
+void test_TFT(size_t len, struct compress_profile profile){
+
+    int16_t poly1[ARRAY_N], poly2[ARRAY_N];
+    int16_t ref[ARRAY_N], res[ARRAY_N];
+    int16_t inv2, t;
+
+    size_t out_len = 2 * len - 1;
+
+    for(size_t i = 0; i < len; i++){
+        t = rand();
+        coeff_ring.memberZ(poly1 + i, &t);
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+    }
+
+    // Compute the product in Z_Q[x].
+    naive_mul_long(ref, poly1, poly2, len, coeff_ring);
+
+    // Evaluate at the first out_len points.
+    TFT(poly1, len, out_len, twiddle_table, profile, coeff_ring);
+    TFT(poly2, len, out_len, twiddle_table, profile, coeff_ring);
+
+    memset(res, 0, sizeof(res));
+    point_mul(res, poly1, poly2, out_len, 1, coeff_ring);
+
+    // Interpolate from the first out_len points.
+    inv2 = INV2;
+    iTFT(res, out_len, twiddle_table, itwiddle_table, &inv2, profile, coeff_ring);
+
+    for(size_t i = 0; i < out_len; i++){
+        assert(ref[i] == res[i]);
+    }
+
+}
+
+int main(void){
+
+    int16_t omega, zeta, scale;
+
+    struct compress_profile profile = {
+        ARRAY_N, NTT_N, LOGNTT_N, LOGNTT_N
+    };
+
+    for(size_t i = 0; i < profile.compressed_layers; i++){
+        profile.merged_layers[i] = 1;
+    }
+
+// ================
+// Generate twiddle factors for the cyclic NTT and its inverse.
+
+    zeta = 1;
+    scale = 1;
+    omega = OMEGA;
+    gen_DWT_table(twiddle_table,
+        &scale, &omega, &zeta, profile, coeff_ring);
+    omega = OMEGA_INV;
+    gen_DWT_table(itwiddle_table,
+        &scale, &omega, &zeta, profile, coeff_ring);
+
+// ================
+// The product of size-761 polynomials, followed by several other sizes.
+
+    test_TFT(POLY_N, profile);
+    test_TFT(1, profile);
+    test_TFT(2, profile);
+    test_TFT(3, profile);
+    test_TFT(257, profile);
+    test_TFT(512, profile);
+    test_TFT(513, profile);
+    test_TFT(677, profile);
+    test_TFT(1024, profile);
+
+    // An empty input gives zero outputs regardless of the stale data in the buffer.
+    int16_t stale[ARRAY_N];
+    for(size_t i = 0; i < ARRAY_N; i++){
+        stale[i] = rand();
+    }
+    TFT(stale, 0, 100, twiddle_table, profile, coeff_ring);
+    for(size_t i = 0; i < 100; i++){
+        assert(stale[i] == 0);
+    }
+
+    printf("Test finished!\n");
+
+}
+
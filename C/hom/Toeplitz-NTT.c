@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <assert.h>
+
+#include "tools.h"
+#include "naive_mult.h"
+#include "gen_table.h"
+#include "ntt_c.h"
+
+// ================
+// This file demonstrates Toeplitz matrix-vector products over Z_Q with transposed NTTs.
+
+// ================
+// Theory.
+// Let E be the NTT and I be its inverse. For polynomials a and b, the map a -> a b is the
+// matrix I diag(E b) E. By the transposition principle, its transpose is
+// E^T diag(E b) I^T, and computes a Toeplitz matrix-vector product at the same cost.
+// In the terminology of Toeplitz-TC.c, Hom-V = E, Hom-M = I^T, and Hom-I = E^T.
+// Since the transpose of a Cooley--Tukey butterfly is a Gentleman--Sande butterfly with the
+// same twiddle factor, E^T is GS_iNTT with the table of E (CT_NTT_T), and I^T is CT_NTT with
+// the table of I (GS_iNTT_T).
+// - For a len x len Toeplitz matrix T, we use the cyclic NTT of size NTT_N >= 2 len - 1,
+//   precompute Hom-M(T) = I^T T, and compute T v = E^T (Hom-M(T) * E v) (NTT_TMVP).
+// - For the matrix M_b of a -> a b in Z_Q[x] / (x^n + 1), the transpose M_b^T is again a
+//   Toeplitz matrix, and M_b^T v = E^T (E b * I^T v) with the negacyclic DWT of size n.
+
+// ================
+// A small example.
+// For len = 2 and T = ((t_1, t_2), (t_0, t_1)), we have
+// T (v_0, v_1) = (t_1 v_0 + t_2 v_1, t_0 v_0 + t_1 v_1), which is the middle of the product
+// (t_0 + t_1 x + t_2 x^2) (v_1 + v_0 x) up to the order of the outputs.
+
+// ================
+// Optimization guide.
+/*
+
+1. The matrix side Hom-M(T) is computed once and reused for many vectors.
+
+2. Compared to computing the full product and extracting the middle, the transposed
+   approach saves the final accumulation pass in TMVP-style multipliers.
+
+3. All the layer-merging strategies of CT_NTT and GS_iNTT apply to the transposed transforms.
+
+*/
+
+// ================
+// Applications to lattice-based cryptosystems.
+
+#define LEN 256
+#define NTT_N 512
+#define LOGNTT_N 9
+
+#define Q (7681)
+
+// A principal 512-th root of unity in Z_Q and its inverse.
+#define OMEGA (-3626)
+#define OMEGA_INV (2811)
+
+// Inverses of 512 and 256 in Z_Q.
+#define NTT_N_INV (-15)
+#define LEN_INV (-30)
+
+// ================
+// Z_Q
+
+int16_t mod = Q;
+
+void memberZ(void *des, const void *src){
+    cmod_int16(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int16(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int16(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int16(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int16(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int16_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+
+int16_t NTT_table[NTT_N - 1], iNTT_table[NTT_N - 1];
+int16_t DWT_table[LEN - 1], iDWT_table[LEN - 1];
+
+int main(void){
+
+    int16_t toeplitz[2 * LEN - 1], toeplitz_NTT[NTT_N];
+    int16_t poly[LEN], vec[LEN];
+    int16_t ref[LEN], res[LEN];
+    int16_t poly_NTT[LEN], vec_NTT[LEN];
+
+    int16_t omega, zeta, scale, t;
+
+    struct compress_profile profile = {
+        NTT_N, NTT_N, LOGNTT_N, LOGNTT_N, {1, 1, 1, 1, 1, 1, 1, 1, 1}
+    };
+
+    struct compress_profile DWT_profile = {
+        LEN, LEN, LOGNTT_N - 1, LOGNTT_N - 1, {1, 1, 1, 1, 1, 1, 1, 1}
+    };
+
+    for(size_t i = 0; i < 2 * LEN - 1; i++){
+        t = rand();
+        coeff_ring.memberZ(toeplitz + i, &t);
+    }
+    for(size_t i = 0; i < LEN; i++){
+        t = rand();
+        coeff_ring.memberZ(poly + i, &t);
+        t = rand();
+        coeff_ring.memberZ(vec + i, &t);
+    }
+
+// ================
+// Generate twiddle factors for the cyclic NTT of size 512.
+
+    zeta = 1;
+    scale = 1;
+    omega = OMEGA;
+    gen_DWT_table(NTT_table, &scale, &omega, &zeta, profile, coeff_ring);
+    omega = OMEGA_INV;
+    gen_DWT_table(iNTT_table, &scale, &omega, &zeta, profile, coeff_ring);
+
+// ================
+// Compute the Toeplitz matrix-vector product with the definition.
+
+    for(size_t i = 0; i < LEN; i++){
+        ref[i] = 0;
+        for(size_t j = 0; j < LEN; j++){
+            coeff_ring.mulZ(&t, toeplitz + (LEN - 1 - i + j), vec + j);
+            coeff_ring.addZ(ref + i, ref + i, &t);
+        }
+    }
+
+// ================
+// Precompute Hom-M of the matrix and apply Hom-V, point-wise multiplication, and Hom-I.
+
+    scale = NTT_N_INV;
+    gen_TMVP_table(toeplitz_NTT, toeplitz, LEN, &scale, iNTT_table, profile, coeff_ring);
+
+    NTT_TMVP(res, toeplitz_NTT, vec, LEN, NTT_table, profile, coeff_ring);
+
+    for(size_t i = 0; i < LEN; i++){
+        assert(ref[i] == res[i]);
+    }
+
+// ================
+// Compute M_b^T v where M_b is the matrix of a -> a b in Z_Q[x] / (x^256 + 1).
+
+    for(size_t j = 0; j < LEN; j++){
+        ref[j] = 0;
+        for(size_t i = 0; i < LEN; i++){
+            coeff_ring.mulZ(&t, poly + ((i + LEN - j) % LEN), vec + i);
+            if(i >= j){
+                coeff_ring.addZ(ref + j, ref + j, &t);
+            }else{
+                coeff_ring.subZ(ref + j, ref + j, &t);
+            }
+        }
+    }
+
+// ================
+// Generate twiddle factors for the negacyclic DWT of size 256.
+
+    scale = 1;
+    zeta = OMEGA;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    gen_DWT_table(DWT_table, &scale, &omega, &zeta, DWT_profile, coeff_ring);
+    zeta = OMEGA_INV;
+    coeff_ring.expZ(&omega, &zeta, 2);
+    gen_DWT_table(iDWT_table, &scale, &omega, &zeta, DWT_profile, coeff_ring);
+
+// ================
+// M_b^T v = E^T (E b * I^T v).
+
+    memcpy(poly_NTT, poly, LEN * sizeof(int16_t));
+    CT_NTT(poly_NTT, DWT_table, DWT_profile, coeff_ring);
+
+    memcpy(vec_NTT, vec, LEN * sizeof(int16_t));
+    GS_iNTT_T(vec_NTT, iDWT_table, DWT_profile, coeff_ring);
+
+    point_mul(res, poly_NTT, vec_NTT, LEN, 1, coeff_ring);
+
+    CT_NTT_T(res, DWT_table, DWT_profile, coeff_ring);
+
+// ================
+// Multiply the scale.
+
+    scale = LEN_INV;
+    for(size_t i = 0; i < LEN; i++){
+        coeff_ring.mulZ(res + i, res + i, &scale);
+    }
+
+    for(size_t i = 0; i < LEN; i++){
+        assert(ref[i] == res[i]);
+    }
+
+    printf("Test finished!\n");
+
+}
+
@@ -21,6 +21,8 @@ Add Toeplitz matrix-vector product derivation from an algebra homomorphism.
 // This file demonstrates polynomial multiplication in Z_Q[x] / (x^4m + 1)
 // via Toeplitz matrix-vector product built upon Toom-4 with the point set
 // {0, 1, -1, 2, -2, 1/2, \infty}.
+// The recursive version mixes levels built upon Toom-4, Toom-3 with the point set
+// {0, 1, -1, -2, \infty}, and Karatsuba.
 
 // ================
 // Optimization guide.
@@ -35,6 +37,16 @@ Add Toeplitz matrix-vector product derivation from an algebra homomorphism.
    is chosen, we also choose -z. So evaluating a polynomial at {z, -z} will be faster
    by first evaluating for the odds and evens individually and applying an add-sub pair.
 
+3. Hom-M depends only on the matrix side. If the same polynomial is multiplied many times,
+   apply Hom-M once with TMVP_TC4_prepare and multiply with TMVP_TC4_negacyclic_mul_prepared.
+
+4. For larger sizes, apply the levels recursively and mix TMVP-4 and TMVP-3 from Toom
+   with TMVP-2 from Karatsuba (TMVP_mul_recursive) down to a base TMVP whose size fits
+   the vector registers. For example, size 768 = 3 * 4 * 4 * 2 * 8 or size 720 = 4 * 4 * 3 * 15.
+   Each TMVP-4 level loses 3 bits and each TMVP-3 level loses 1 bit (TMVP_precision).
+   Compared to polynomial multiplication, the result is already reduced modulo x^len + 1,
+   so there is no reduction pass over the size-(2 len - 1) product.
+
 */
 
 // ================
@@ -247,6 +259,72 @@ int32_t TC4_trunc_T_modified[7][7] = {
 { 0,  0,  0,  0,  0,  0,  0}
 };
 
+// ================
+// TMVP matrices built upon Toom-3 with the point set {0, 1, -1, -2, \infty}
+// and Karatsuba with the point set {0, 1, \infty}.
+// They are derived as the ones of Toom-4: Hom-M is (T^(-1))^* with the odd denominators
+// moved to the scales, and Hom-I is the transpose of the evaluation matrix with the powers
+// of two of (T^(-1))^* moved to the shifts at the end.
+
+// Hom-V from Toom-3 evaluation matrix
+int32_t TC3_trunc[5][5] = {
+{ 1,  0,  0, 0, 0},
+{ 1,  1,  1, 0, 0},
+{ 1, -1,  1, 0, 0},
+{ 1, -2,  4, 0, 0},
+{ 0,  0,  1, 0, 0}
+};
+
+// scaling of Hom-M from Toom-3 inversion matrix
+int32_t iTC3_T_modified_scale[5] = {
+1, -1431655765, 1, -1431655765, 1
+};
+
+// Hom-M from Toom-3 inversion matrix
+int32_t iTC3_T_modified[5][5] = {
+{2,  1, -2, -1, 0},
+{0,  2,  3,  1, 0},
+{0, -2,  1,  1, 0},
+{0,  1,  0, -1, 0},
+{0, -2, -1,  2, 1}
+};
+
+// Hom-I from Toom-3 evaluation matrix
+// We need to multiply the scales 1/2, 1/2, 1/2 at the end.
+int32_t TC3_trunc_T_modified[5][5] = {
+{ 1,  1,  1,  1,  0},
+{ 0,  1, -1, -2,  0},
+{ 0,  1,  1,  4,  2},
+{ 0,  0,  0,  0,  0},
+{ 0,  0,  0,  0,  0}
+};
+
+// Hom-V from Karatsuba evaluation matrix
+int32_t K_trunc[3][3] = {
+{ 1,  0,  0},
+{ 1,  1,  0},
+{ 0,  1,  0}
+};
+
+// scaling of Hom-M from Karatsuba inversion matrix
+int32_t iK_T_modified_scale[3] = {
+1, 1, 1
+};
+
+// Hom-M from Karatsuba inversion matrix
+int32_t iK_T_modified[3][3] = {
+{ 1, -1,  0},
+{ 0,  1,  0},
+{ 0, -1,  1}
+};
+
+// Hom-I from Karatsuba evaluation matrix
+int32_t K_trunc_T_modified[3][3] = {
+{ 1,  1,  0},
+{ 0,  1,  1},
+{ 0,  0,  0}
+};
+
 // matrix-vector multiplication
 static
 void matrix_vector_mul(int32_t *des, int32_t *srcM, int32_t *srcV, size_t len){
@@ -278,25 +356,20 @@ void TMVP(int32_t *des, int32_t *srcM, int32_t *srcV, size_t len){
 
 }
 
-// This function illustrate how to compute Z_Q[x] / (x^len + 1)
-// with Toeplitz transformation built upon Toom-4 with the point set
-// {0, 1, -1, 2, -2, 1/2, \infty} where
-// len should be a multiple of 4.
+// This function prepares src2 for TMVP_TC4_negacyclic_mul_prepared.
+// The Toeplitz matrix of the multiplication map b -> src2 b mod x^len + 1 is constructed
+// and Hom-M is applied. The result consists of 7 compressed Toeplitz matrices stored at
+// des[7][len / 2].
+// If src2 is multiplied by many polynomials, Hom-M is applied only once.
 static
-void TMVP_TC4_negacyclic_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t len){
-
-    int32_t src1_V[4][len / 4];
-    int32_t src1_V_full[7][len / 4];
+void TMVP_TC4_prepare(int32_t *des, const int32_t *src2, size_t len){
 
     int32_t src2_Toeplitz[2 * len];
     int32_t src2_Toeplitz_full[7][len / 2];
 
-    int32_t res_V[4][len / 4];
-    int32_t res_V_full[7][len / 4];
-    int32_t buff1[7], buff2[7], buff3[7];
+    int32_t buff2[7], buff3[7];
 
-    // Copy.
-    memmove(&src1_V[0][0], src1, len * sizeof(int32_t));
+    memset(src2_Toeplitz_full, 0, sizeof(src2_Toeplitz_full));
 
     // Construct the compressed format of the Toeplitz matrix from
     // the multiplication map b -> a b mod x^len + 1.
@@ -309,19 +382,7 @@ void TMVP_TC4_negacyclic_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t
 
     // Copying.
     for(size_t i = 0; i < 7; i++){
-        memmove(&src2_Toeplitz_full[i][0], src2_Toeplitz + i * 4, ((len / 2) - 1) * sizeof(int32_t));
-    }
-
-    // Apply Hom-V.
-    for(size_t i = 0; i < len / 4; i++){
-        memset(buff1, 0, 7 * sizeof(int32_t));
-        for(size_t j = 0; j < 4; j++){
-            buff1[j] = src1_V[j][i];
-        }
-        matrix_vector_mul(buff3, (int32_t*)&TC4_trunc[0][0], buff1, 7);
-        for(size_t j = 0; j < 7; j++){
-            src1_V_full[j][i] = buff3[j];
-        }
+        memmove(&src2_Toeplitz_full[i][0], src2_Toeplitz + i * (len / 4), ((len / 2) - 1) * sizeof(int32_t));
     }
 
     // Apply Hom-M.
@@ -338,9 +399,40 @@ void TMVP_TC4_negacyclic_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t
         }
     }
 
+    memmove(des, src2_Toeplitz_full, sizeof(src2_Toeplitz_full));
+
+}
+
+// This function computes the product of src1 and the polynomial prepared by TMVP_TC4_prepare
+// in Z_Q[x] / (x^len + 1). Only Hom-V, the small-dimensional TMVPs, and Hom-I are applied.
+static
+void TMVP_TC4_negacyclic_mul_prepared(int32_t *des, const int32_t *src1, const int32_t *src2_prepared, size_t len){
+
+    int32_t src1_V[4][len / 4];
+    int32_t src1_V_full[7][len / 4];
+
+    int32_t res_V[4][len / 4];
+    int32_t res_V_full[7][len / 4];
+    int32_t buff1[7], buff2[7], buff3[7];
+
+    // Copy.
+    memmove(&src1_V[0][0], src1, len * sizeof(int32_t));
+
+    // Apply Hom-V.
+    for(size_t i = 0; i < len / 4; i++){
+        memset(buff1, 0, 7 * sizeof(int32_t));
+        for(size_t j = 0; j < 4; j++){
+            buff1[j] = src1_V[j][i];
+        }
+        matrix_vector_mul(buff3, (int32_t*)&TC4_trunc[0][0], buff1, 7);
+        for(size_t j = 0; j < 7; j++){
+            src1_V_full[j][i] = buff3[j];
+        }
+    }
+
     // Apply small-dimensional TMVP.
     for(size_t i = 0; i < 7; i++){
-        TMVP((int32_t*)&res_V_full[i][0], (int32_t*)&src2_Toeplitz_full[i][0], (int32_t*)&src1_V_full[i][0], 4);
+        TMVP((int32_t*)&res_V_full[i][0], (int32_t*)src2_prepared + i * (len / 2), (int32_t*)&src1_V_full[i][0], len / 4);
     }
 
     // Apply Hom-I.
@@ -359,6 +451,205 @@ void TMVP_TC4_negacyclic_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t
 
 }
 
+// This function illustrate how to compute Z_Q[x] / (x^len + 1)
+// with Toeplitz transformation built upon Toom-4 with the point set
+// {0, 1, -1, 2, -2, 1/2, \infty} where
+// len should be a multiple of 4.
+static
+void TMVP_TC4_negacyclic_mul(int32_t *des, int32_t *src1, int32_t *src2, size_t len){
+
+    int32_t src2_prepared[7 * (len / 2)];
+
+    TMVP_TC4_prepare(src2_prepared, src2, len);
+    TMVP_TC4_negacyclic_mul_prepared(des, src1, src2_prepared, len);
+
+}
+
+// ================
+// Recursive TMVP.
+/*
+
+A Toeplitz matrix of size len = k n is a k x k block matrix whose block (r, c) is
+the size-n Toeplitz matrix compressed at t + (k - 1 - r + c) n where t is the compressed
+format of the whole matrix. So a level of TMVP-k maps a size-len TMVP to 2 k - 1 (3 for
+Karatsuba) size-n TMVPs:
+- Hom-M combines the 2 k - 1 blocks of the matrix into the matrices of the small TMVPs.
+- Hom-V combines the k blocks of the vector into the vectors of the small TMVPs.
+- Hom-I combines the results of the small TMVPs into the k blocks of the result.
+Since the small TMVPs are again TMVPs, the levels can be applied recursively and mixed.
+Hom-M only depends on the matrix, so it is applied once by TMVP_prepare_recursive.
+
+*/
+
+enum TMVP_level {
+    TMVP_LEVEL_TC4,
+    TMVP_LEVEL_TC3,
+    TMVP_LEVEL_KARATSUBA
+};
+
+struct TMVP_scheme {
+    // Number of blocks.
+    size_t k;
+    // Number of small TMVPs. The matrices are points x points.
+    size_t points;
+    int32_t *hom_V;
+    int32_t *hom_M;
+    int32_t *hom_M_scale;
+    int32_t *hom_I;
+    size_t hom_I_shift[4];
+};
+
+static
+struct TMVP_scheme TMVP_schemes[3] = {
+    {4, 7, (int32_t*)TC4_trunc, (int32_t*)iTC4_T_modified, iTC4_T_modified_scale, (int32_t*)TC4_trunc_T_modified, {3, 2, 1, 1}},
+    {3, 5, (int32_t*)TC3_trunc, (int32_t*)iTC3_T_modified, iTC3_T_modified_scale, (int32_t*)TC3_trunc_T_modified, {1, 1, 1, 0}},
+    {2, 3, (int32_t*)K_trunc, (int32_t*)iK_T_modified, iK_T_modified_scale, (int32_t*)K_trunc_T_modified, {0, 0, 0, 0}}
+};
+
+// The number of int32_t of the output of TMVP_prepare_recursive for a size-len matrix.
+static
+size_t TMVP_prepared_size(size_t len, const enum TMVP_level *levels, size_t n_levels){
+
+    const struct TMVP_scheme *scheme;
+
+    if(n_levels == 0){
+        return 2 * len - 1;
+    }
+
+    scheme = &TMVP_schemes[levels[0]];
+
+    return scheme->points * TMVP_prepared_size(len / scheme->k, levels + 1, n_levels - 1);
+
+}
+
+// The number of bits of the result of TMVP_mul_recursive that are correct.
+static
+size_t TMVP_precision(const enum TMVP_level *levels, size_t n_levels){
+
+    size_t precision = 32;
+
+    for(size_t i = 0; i < n_levels; i++){
+        precision -= TMVP_schemes[levels[i]].hom_I_shift[0];
+    }
+
+    return precision;
+
+}
+
+// This function applies Hom-M of levels[0], ..., levels[n_levels - 1] recursively to
+// the size-len Toeplitz matrix in the compressed format srcM (2 len - 1 values).
+// len must be a multiple of the product of the numbers of blocks of the levels.
+static
+void TMVP_prepare_recursive(int32_t *des, const int32_t *srcM, size_t len, const enum TMVP_level *levels, size_t n_levels){
+
+    const struct TMVP_scheme *scheme;
+    size_t k, points, n, size;
+
+    if(n_levels == 0){
+        memmove(des, srcM, (2 * len - 1) * sizeof(int32_t));
+        return;
+    }
+
+    scheme = &TMVP_schemes[levels[0]];
+    k = scheme->k;
+    points = scheme->points;
+    assert(len % k == 0);
+    n = len / k;
+    size = TMVP_prepared_size(n, levels + 1, n_levels - 1);
+
+    int32_t buff[2 * n - 1];
+
+    for(size_t p = 0; p < points; p++){
+        // Apply Hom-M to the blocks srcM + j n of the matrix.
+        for(size_t i = 0; i < 2 * n - 1; i++){
+            buff[i] = 0;
+            for(size_t j = 0; j < 2 * k - 1; j++){
+                buff[i] += scheme->hom_M[p * points + j] * srcM[j * n + i];
+            }
+            buff[i] *= scheme->hom_M_scale[p];
+        }
+        TMVP_prepare_recursive(des + p * size, buff, n, levels + 1, n_levels - 1);
+    }
+
+}
+
+// This function computes the product of the size-len Toeplitz matrix prepared by
+// TMVP_prepare_recursive and the vector srcV.
+// The result is correct modulo 2^TMVP_precision(levels, n_levels).
+static
+void TMVP_mul_recursive(int32_t *des, const int32_t *srcM_prepared, const int32_t *srcV, size_t len, const enum TMVP_level *levels, size_t n_levels){
+
+    const struct TMVP_scheme *scheme;
+    size_t k, points, n, size;
+
+    if(n_levels == 0){
+        TMVP(des, (int32_t*)srcM_prepared, (int32_t*)srcV, len);
+        return;
+    }
+
+    scheme = &TMVP_schemes[levels[0]];
+    k = scheme->k;
+    points = scheme->points;
+    assert(len % k == 0);
+    n = len / k;
+    size = TMVP_prepared_size(n, levels + 1, n_levels - 1);
+
+    int32_t srcV_full[points][n];
+    int32_t res_full[points][n];
+
+    // Apply Hom-V.
+    for(size_t p = 0; p < points; p++){
+        for(size_t i = 0; i < n; i++){
+            srcV_full[p][i] = 0;
+            for(size_t j = 0; j < k; j++){
+                srcV_full[p][i] += scheme->hom_V[p * points + j] * srcV[j * n + i];
+            }
+        }
+    }
+
+    // Apply small-dimensional TMVPs.
+    for(size_t p = 0; p < points; p++){
+        TMVP_mul_recursive(&res_full[p][0], srcM_prepared + p * size, &srcV_full[p][0], n, levels + 1, n_levels - 1);
+    }
+
+    // Apply Hom-I. The row j of Hom-I is the block k - 1 - j of the result.
+    for(size_t j = 0; j < k; j++){
+        for(size_t i = 0; i < n; i++){
+            int32_t t = 0;
+            for(size_t p = 0; p < points; p++){
+                t += scheme->hom_I[j * points + p] * res_full[p][i];
+            }
+            des[(k - 1 - j) * n + i] = t >> scheme->hom_I_shift[j];
+        }
+    }
+
+}
+
+// This function computes the product of src1 and src2 in Z_Q[x] / (x^len + 1) with the
+// recursive TMVP given by levels. len must be a multiple of the product of the numbers
+// of blocks of the levels, and the base TMVPs are of size len divided by the product.
+static
+void TMVP_negacyclic_mul_recursive(int32_t *des, const int32_t *src1, const int32_t *src2, size_t len, const enum TMVP_level *levels, size_t n_levels){
+
+    int32_t src2_Toeplitz[2 * len - 1];
+    int32_t *src2_prepared = malloc(TMVP_prepared_size(len, levels, n_levels) * sizeof(int32_t));
+
+    // Construct the compressed format of the Toeplitz matrix from
+    // the multiplication map b -> a b mod x^len + 1.
+    for(size_t i = 0; i < len; i++){
+        src2_Toeplitz[i] = src2[len - 1 - i];
+    }
+    for(size_t i = len; i < 2 * len - 1; i++){
+        src2_Toeplitz[i] = -src2[2 * len - 1 - i];
+    }
+
+    TMVP_prepare_recursive(src2_prepared, src2_Toeplitz, len, levels, n_levels);
+    TMVP_mul_recursive(des, src2_prepared, src1, len, levels, n_levels);
+
+    free(src2_prepared);
+
+}
+
 int main(void){
 
     int32_t poly1[16], poly2[16];
@@ -393,6 +684,83 @@ int main(void){
         assert(ref[i] == res[i]);
     }
 
+    // Prepare poly2 once and multiply it by several polynomials.
+    int32_t poly2_prepared[7 * 8];
+
+    for(size_t i = 0; i < 16; i++){
+        t = rand();
+        coeff_ring.memberZ(poly2 + i, &t);
+    }
+
+    TMVP_TC4_prepare(poly2_prepared, poly2, 16);
+
+    for(size_t k = 0; k < 4; k++){
+
+        for(size_t i = 0; i < 16; i++){
+            t = rand();
+            coeff_ring.memberZ(poly1 + i, &t);
+        }
+
+        naive_mulR(ref, poly1, poly2, 16, &twiddle, coeff_ring);
+        TMVP_TC4_negacyclic_mul_prepared(res, poly1, poly2_prepared, 16);
+
+        for(size_t i = 0; i < 16; i++){
+            cmod_int32(ref + i, ref + i, &mod);
+            cmod_int32(res + i, res + i, &mod);
+            assert(ref[i] == res[i]);
+        }
+
+    }
+
+    // Recursive TMVPs for larger sizes.
+    enum TMVP_level levels_256[3] = {TMVP_LEVEL_TC4, TMVP_LEVEL_KARATSUBA, TMVP_LEVEL_KARATSUBA};
+    enum TMVP_level levels_720[3] = {TMVP_LEVEL_TC4, TMVP_LEVEL_TC4, TMVP_LEVEL_TC3};
+    enum TMVP_level levels_768[4] = {TMVP_LEVEL_TC3, TMVP_LEVEL_TC4, TMVP_LEVEL_TC4, TMVP_LEVEL_KARATSUBA};
+
+    struct {
+        size_t len;
+        const enum TMVP_level *levels;
+        size_t n_levels;
+    } tests[3] = {
+        {256, levels_256, 3},
+        {720, levels_720, 3},
+        {768, levels_768, 4}
+    };
+
+    int32_t big1[768], big2[768], big_ref[768], big_res[768];
+
+    for(size_t s = 0; s < 3; s++){
+
+        size_t len = tests[s].len;
+        int32_t big_mod = (int32_t)1 << TMVP_precision(tests[s].levels, tests[s].n_levels);
+
+        for(size_t i = 0; i < len; i++){
+            t = rand();
+            coeff_ring.memberZ(big1 + i, &t);
+            t = rand();
+            coeff_ring.memberZ(big2 + i, &t);
+        }
+
+        naive_mulR(big_ref, big1, big2, len, &twiddle, coeff_ring);
+        TMVP_negacyclic_mul_recursive(big_res, big1, big2, len, tests[s].levels, tests[s].n_levels);
+
+        for(size_t i = 0; i < len; i++){
+            cmod_int32(big_ref + i, big_ref + i, &big_mod);
+            cmod_int32(big_res + i, big_res + i, &big_mod);
+            assert(big_ref[i] == big_res[i]);
+        }
+
+    }
+
+    // The single-level Toom-4 version for size 64.
+    naive_mulR(big_ref, big1, big2, 64, &twiddle, coeff_ring);
+    TMVP_TC4_negacyclic_mul(big_res, big1, big2, 64);
+    for(size_t i = 0; i < 64; i++){
+        cmod_int32(big_ref + i, big_ref + i, &mod);
+        cmod_int32(big_res + i, big_res + i, &mod);
+        assert(big_ref[i] == big_res[i]);
+    }
+
     printf("Test finished!\n");
 
 
@@ -0,0 +1,420 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// ================
+// This program emits a C header with fused kernels of striding followed by k layers of
+// Karatsuba for polynomial multiplication in R[x] / (x^len -+ 1). It generalizes
+// negacyclic_2_layer_Karatsuba_striding in Karatsuba-striding_multi-layer.c.
+// Usage:
+//     gen_Karatsuba_striding name=NAME k=k0,k1,... [wrap=cyclic,negacyclic] [type=TYPE]
+// - k lists the numbers of Karatsuba layers, each in {1, 2, 3, 4}.
+// - wrap lists the moduli x^len - 1 (cyclic) and x^len + 1 (negacyclic).
+// - type is the coefficient type (default int32_t). The arithmetic is the plain C arithmetic
+//   of the type, for example Z_{2^32} for int32_t and uint32_t.
+// For each k and wrap, the header defines
+//     static inline void NAME_{wrap}_{k}_layer_Karatsuba_striding(TYPE *des, const TYPE *src1, const TYPE *src2, size_t len);
+// where len must be a multiple of K = 2^k.
+
+// ================
+// Theory.
+// Let K = 2^k and m = len / K. Striding maps R[x] / (x^len -+ 1) to
+// (R[y] / (y^m -+ 1))[x] / (x^K - y) with a_t(y) = sum_i a[K i + t] y^i for t = 0, ..., K - 1.
+// k layers of Karatsuba in x evaluate a_0 + a_1 x + ... + a_{K - 1} x^(K - 1) at 3^k points.
+// A point is a string of k ternary digits d_1 ... d_k, one for each layer, where the digits
+// 0, 1, and 2 stand for the low half, the sum of the halves, and the high half.
+// - Evaluation: the point with d_j = 1 is the sum of the points with d_j = 0 and d_j = 2.
+//   The points without 1s are the strided polynomials: a_t where t = sum_j (d_j / 2) 2^(k - j).
+// - Products: 3^k products in R[y] / (y^m -+ 1), computed with the schoolbook method while
+//   keeping one coefficient of the points of src1 in registers.
+// - Interpolation: for each layer j and each point with d_j = 1, subtract the points with
+//   d_j = 0 and d_j = 2. Then the point d is the coefficient of x^s with
+//   s = sum_j d_j 2^(k - j), and the points with the same s are summed up.
+// - Export: the coefficients of x^s with s >= K are multiplied by x^K = y, i.e., shifted
+//   by one position in y, with the wrap -+ 1 for the top coefficient.
+
+// ================
+// Optimization guide.
+/*
+
+1. The evaluation of src1 keeps 3^k values in registers. The best k is the largest one such
+   that 3^k values of src1, the values of src2, and the accumulators fit into the register file.
+
+2. For the export, the coefficients of x^s with s >= K of the previous block are cached
+   so that each result is loaded once.
+
+*/
+
+#define MAX_K 4
+#define MAX_POINTS 81
+
+static size_t k, K, n_points;
+
+// digits[p][j] is the j-th digit (0-indexed) of the point p.
+static int digits[MAX_POINTS][MAX_K];
+
+static
+void usage(const char *prog){
+    fprintf(stderr, "usage: %s name=NAME k=k0,k1,... [wrap=cyclic,negacyclic] [type=TYPE]\n", prog);
+    exit(1);
+}
+
+static
+void point_name(char *des, size_t p){
+    for(size_t j = 0; j < k; j++){
+        des[j] = '0' + digits[p][j];
+    }
+    des[k] = '\0';
+}
+
+static
+size_t point_index(const int *d){
+    size_t p = 0;
+    for(size_t j = 0; j < k; j++){
+        p = p * 3 + d[j];
+    }
+    return p;
+}
+
+static
+size_t count_ones(size_t p){
+    size_t c = 0;
+    for(size_t j = 0; j < k; j++){
+        c += digits[p][j] == 1;
+    }
+    return c;
+}
+
+// The index of the strided polynomial for a point without 1s.
+static
+size_t leaf_index(size_t p){
+    size_t t = 0;
+    for(size_t j = 0; j < k; j++){
+        t = t * 2 + (digits[p][j] / 2);
+    }
+    return t;
+}
+
+// The power of x of a point after the interpolation.
+static
+size_t point_degree(size_t p){
+    size_t s = 0;
+    for(size_t j = 0; j < k; j++){
+        s += digits[p][j] * ((size_t)1 << (k - 1 - j));
+    }
+    return s;
+}
+
+// The points to be summed for a point with at least one 1: the last 1-digit is replaced by 0 and 2.
+static
+void point_children(size_t *c0, size_t *c2, size_t p){
+    int d[MAX_K];
+    size_t j = k;
+    memcpy(d, digits[p], sizeof(d));
+    while(d[--j] != 1);
+    d[j] = 0;
+    *c0 = point_index(d);
+    d[j] = 2;
+    *c2 = point_index(d);
+}
+
+// The representative of the points with the same power of x: the largest index.
+static
+size_t degree_rep(size_t s){
+    size_t rep = 0;
+    for(size_t p = 0; p < n_points; p++){
+        if(point_degree(p) == s){
+            rep = p;
+        }
+    }
+    return rep;
+}
+
+// Print the value of a point of src2 at block j: a leaf is loaded and the others are cached.
+static
+void print_src2(size_t p){
+    char name[MAX_K + 1];
+    if(count_ones(p) == 0){
+        printf("src2[%zu * j + %zu]", K, leaf_index(p));
+    }else{
+        point_name(name, p);
+        printf("_p%s", name);
+    }
+}
+
+static
+void print_products(const char *op, const char *index){
+    char name[MAX_K + 1];
+    size_t c0, c2;
+
+    for(size_t ones = 0; ones <= k; ones++){
+        for(size_t p = 0; p < n_points; p++){
+            if(count_ones(p) != ones){
+                continue;
+            }
+            point_name(name, p);
+            if(ones > 0){
+                point_children(&c0, &c2, p);
+                printf("            _p%s = ", name);
+                print_src2(c0);
+                printf(" + ");
+                print_src2(c2);
+                printf(";\n");
+            }
+            printf("            res_p%s[%s] %s p%s * ", name, index, op, name);
+            print_src2(p);
+            printf(";\n");
+        }
+    }
+}
+
+static
+void print_kernel(const char *name, const char *type, bool negacyclic){
+
+    char pname[MAX_K + 1], c0name[MAX_K + 1], c2name[MAX_K + 1];
+    char wrap_index[32];
+    size_t c0, c2;
+    bool read[MAX_POINTS], written[MAX_POINTS];
+    size_t loads, stores;
+
+    n_points = 1;
+    for(size_t j = 0; j < k; j++){
+        n_points *= 3;
+    }
+    for(size_t p = 0; p < n_points; p++){
+        size_t q = p;
+        for(size_t j = k; j-- > 0;){
+            digits[p][j] = q % 3;
+            q /= 3;
+        }
+    }
+
+    printf("// Multiply two size-len polynomials over %s in R[x] / (x^len %s 1) via\n", type, negacyclic ? "+" : "-");
+    printf("// (R[y] / (y^(len / %zu) %s 1)) / (x^%zu - y) (striding) and %zu layer%s of Karatsuba.\n",
+        K, negacyclic ? "+" : "-", K, k, k > 1 ? "s" : "");
+    printf("// len must be a multiple of %zu.\n", K);
+    printf("static inline\n");
+    printf("void %s_%s_%zu_layer_Karatsuba_striding(%s *des, const %s *src1, const %s *src2, size_t len){\n\n",
+        name, negacyclic ? "negacyclic" : "cyclic", k, type, type, type);
+
+    // Declarations.
+    for(size_t p = 0; p < n_points; p++){
+        point_name(pname, p);
+        printf("    %s res_p%s[len / %zu];\n", type, pname, K);
+    }
+    printf("\n");
+    for(size_t p = 0; p < n_points; p++){
+        point_name(pname, p);
+        printf("    %s p%s;\n", type, pname);
+    }
+    printf("\n");
+    for(size_t p = 0; p < n_points; p++){
+        if(count_ones(p) == 0){
+            continue;
+        }
+        point_name(pname, p);
+        printf("    %s _p%s;\n", type, pname);
+    }
+    printf("\n    %s buff[%zu];\n\n", type, K - 1);
+
+    for(size_t p = 0; p < n_points; p++){
+        point_name(pname, p);
+        printf("    memset(res_p%s, 0, sizeof(res_p%s));\n", pname, pname);
+    }
+    printf("\n");
+
+    // Evaluation of src1 and the products.
+    printf("    for(size_t i = 0; i < len / %zu; i++){\n\n", K);
+    printf("        // Load %zu, cache %zu.\n", K, n_points);
+    for(size_t ones = 0; ones <= k; ones++){
+        for(size_t p = 0; p < n_points; p++){
+            if(count_ones(p) != ones){
+                continue;
+            }
+            point_name(pname, p);
+            if(ones == 0){
+                printf("        p%s = src1[%zu * i + %zu];\n", pname, K, leaf_index(p));
+            }else{
+                point_children(&c0, &c2, p);
+                point_name(c0name, c0);
+                point_name(c2name, c2);
+                printf("        p%s = p%s + p%s;\n", pname, c0name, c2name);
+            }
+        }
+    }
+    printf("\n");
+
+    printf("        for(size_t j = 0; j < len / %zu - i; j++){\n", K);
+    print_products("+=", "i + j");
+    printf("        }\n\n");
+
+    printf("        for(size_t j = len / %zu - i; j < len / %zu; j++){\n", K, K);
+    snprintf(wrap_index, sizeof(wrap_index), "i + j - len / %zu", K);
+    print_products(negacyclic ? "-=" : "+=", wrap_index);
+    printf("        }\n\n");
+
+    printf("    }\n\n");
+
+    // Interpolation.
+    memset(read, 0, sizeof(read));
+    memset(written, 0, sizeof(written));
+    for(size_t p = 0; p < n_points; p++){
+        read[p] = true;
+        if(count_ones(p) > 0){
+            written[p] = true;
+        }
+    }
+    for(size_t s = 0; s < 2 * K - 1; s++){
+        size_t rep = degree_rep(s);
+        for(size_t p = 0; p < n_points; p++){
+            if((point_degree(p) == s) && (p != rep)){
+                written[rep] = true;
+            }
+        }
+    }
+    loads = stores = 0;
+    for(size_t p = 0; p < n_points; p++){
+        loads += read[p];
+        stores += written[p];
+    }
+
+    printf("    // Load %zu, store %zu.\n", loads, stores);
+    printf("    for(size_t i = 0; i < len / %zu; i++){\n", K);
+    for(size_t j = k; j-- > 0;){
+        for(size_t p = 0; p < n_points; p++){
+            if(digits[p][j] != 1){
+                continue;
+            }
+            int d[MAX_K];
+            memcpy(d, digits[p], sizeof(d));
+            d[j] = 0;
+            point_name(c0name, point_index(d));
+            d[j] = 2;
+            point_name(c2name, point_index(d));
+            point_name(pname, p);
+            printf("        res_p%s[i] = res_p%s[i] - res_p%s[i] - res_p%s[i];\n", pname, pname, c0name, c2name);
+        }
+        printf("\n");
+    }
+    for(size_t s = 0; s < 2 * K - 1; s++){
+        size_t rep = degree_rep(s);
+        char rname[MAX_K + 1];
+        point_name(rname, rep);
+        for(size_t p = 0; p < n_points; p++){
+            if((point_degree(p) == s) && (p != rep)){
+                point_name(pname, p);
+                printf("        res_p%s[i] += res_p%s[i];\n", rname, pname);
+            }
+        }
+    }
+    printf("    }\n\n");
+
+    // Export.
+    char rep_name[(2 << MAX_K) - 1][MAX_K + 1];
+    for(size_t s = 0; s < 2 * K - 1; s++){
+        point_name(rep_name[s], degree_rep(s));
+    }
+
+    printf("    // Load %zu, store %zu, cache %zu.\n", 3 * K - 2, K, K - 1);
+    for(size_t s = 0; s < K; s++){
+        if(s + K < 2 * K - 1){
+            printf("    des[%zu] = res_p%s[0] %s res_p%s[len / %zu - 1];\n",
+                s, rep_name[s], negacyclic ? "-" : "+", rep_name[s + K], K);
+        }else{
+            printf("    des[%zu] = res_p%s[0];\n", s, rep_name[s]);
+        }
+    }
+    for(size_t s = 0; s < K - 1; s++){
+        printf("    buff[%zu] = res_p%s[0];\n", s, rep_name[s + K]);
+    }
+    printf("    // Load %zu, store %zu, cache %zu.\n", 2 * K - 1, K, K - 1);
+    printf("    for(size_t i = 1; i < len / %zu; i++){\n", K);
+    for(size_t s = 0; s < K; s++){
+        if(s < K - 1){
+            printf("        des[%zu * i + %zu] = buff[%zu] + res_p%s[i];\n", K, s, s, rep_name[s]);
+        }else{
+            printf("        des[%zu * i + %zu] = res_p%s[i];\n", K, s, rep_name[s]);
+        }
+    }
+    for(size_t s = 0; s < K - 1; s++){
+        printf("        buff[%zu] = res_p%s[i];\n", s, rep_name[s + K]);
+    }
+    printf("    }\n\n");
+
+    printf("}\n\n");
+
+}
+
+int main(int argc, char **argv){
+
+    const char *name = NULL, *type = "int32_t", *k_str = NULL, *wrap_str = "cyclic,negacyclic";
+    size_t ks[MAX_K], n_ks = 0;
+    bool wraps[2] = {false, false};
+
+    for(int i = 1; i < argc; i++){
+        if(strncmp(argv[i], "name=", 5) == 0){
+            name = argv[i] + 5;
+        }else if(strncmp(argv[i], "k=", 2) == 0){
+            k_str = argv[i] + 2;
+        }else if(strncmp(argv[i], "wrap=", 5) == 0){
+            wrap_str = argv[i] + 5;
+        }else if(strncmp(argv[i], "type=", 5) == 0){
+            type = argv[i] + 5;
+        }else{
+            usage(argv[0]);
+        }
+    }
+
+    if((name == NULL) || (k_str == NULL)){
+        usage(argv[0]);
+    }
+
+    for(const char *p = k_str; *p;){
+        char *end;
+        size_t v = strtoull(p, &end, 0);
+        if((end == p) || (v < 1) || (v > MAX_K) || (n_ks == MAX_K)){
+            usage(argv[0]);
+        }
+        ks[n_ks++] = v;
+        p = (*end == ',') ? end + 1 : end;
+    }
+
+    for(const char *p = wrap_str; *p;){
+        size_t l = strcspn(p, ",");
+        if((l == 6) && (strncmp(p, "cyclic", 6) == 0)){
+            wraps[0] = true;
+        }else if((l == 10) && (strncmp(p, "negacyclic", 10) == 0)){
+            wraps[1] = true;
+        }else{
+            usage(argv[0]);
+        }
+        p += l + (p[l] == ',');
+    }
+
+    printf("// Generated by gen_Karatsuba_striding.");
+    for(int i = 1; i < argc; i++){
+        printf(" %s", argv[i]);
+    }
+    printf("\n\n");
+    printf("#ifndef %s_KARATSUBA_STRIDING_H\n#define %s_KARATSUBA_STRIDING_H\n\n", name, name);
+    printf("#include <stdint.h>\n#include <stddef.h>\n#include <string.h>\n\n");
+
+    for(size_t i = 0; i < n_ks; i++){
+        k = ks[i];
+        K = (size_t)1 << k;
+        for(size_t w = 0; w < 2; w++){
+            if(wraps[w]){
+                print_kernel(name, type, w == 1);
+            }
+        }
+    }
+
+    printf("#endif\n");
+
+    return 0;
+
+}
+
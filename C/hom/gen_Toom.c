@@ -0,0 +1,1580 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+// ================
+// This program emits a C header with the evaluation and the interpolation of Toom-k
+// for an arbitrary point set over Z_{2^w}. It generalizes the hand-written TC4_eval,
+// TC4_interpol, TC5_eval, and TC5_interpol in TC.c.
+// Usage:
+//     gen_Toom name=NAME k=k points=z0,z1,... [word=w] [type=TYPE] [precision=p] [beam=B]
+// - k is the number of limbs, 2 <= k <= 8.
+// - points lists 2 k - 1 distinct points. A point is an integer a, a fraction a/b, or inf.
+// - w is the word size, 16 or 32 (default 32). The arithmetic is the plain C arithmetic of
+//   type, which defaults to int16_t and int32_t, respectively.
+// - p is the required precision, at most w. It defaults to the precision of the direct
+//   formulas below; a smaller p admits sequences that lose more bits.
+// - B is the beam width of the search (default 256).
+// The header defines
+//     #define NAME_K k
+//     #define NAME_POINTS (2 k - 1)
+//     #define NAME_PRECISION (w - s)
+//     static inline void NAME_eval(TYPE *des, const TYPE *src);
+//     static inline void NAME_interpol(TYPE *des, const TYPE *src);
+// NAME_eval maps k limbs to their values at the points. NAME_interpol maps the values of a
+// product at the points to its 2 k - 1 coefficients, which are correct modulo 2^NAME_PRECISION.
+// Both can be applied in place.
+
+// ================
+// Theory.
+// We write a point z = a / b as (a : b) and inf as (1 : 0). A size-k polynomial
+// f = f_0 + ... + f_(k - 1) x^(k - 1) evaluated at (a : b) is the homogeneous value
+// f_0 b^(k - 1) + f_1 a b^(k - 2) + ... + f_(k - 1) a^(k - 1), i.e., the value at a / b scaled
+// by b^(k - 1). The product of two such values is the value of the product scaled by b^(2 k - 2).
+// - Evaluation: for a pair {(a : b), (-a : b)}, the even part e and the odd part o are computed
+//   once, and the values are e + o and e - o.
+// - Interpolation: let n = 2 k - 1 and V be the n x n homogeneous Vandermonde matrix.
+//   By Lagrange interpolation, the column j of V^(-1) consists of the coefficients of
+//       prod_{m != j} (b_m X - a_m Y) / prod_{m != j} (b_m a_j - a_m b_j).
+//   The row i of V^(-1) is written as (n_i0, ..., n_i(n - 1)) / (2^s_i o_i) with integers n_ij
+//   and o_i odd. Then c_i = ((sum_j n_ij w_j) >> s_i) o_i^(-1) in Z_{2^w}. The sum is
+//   2^s_i c_i modulo 2^w, so the shift returns c_i modulo 2^(w - s_i) and the precision of
+//   the scheme is w - max_i s_i.
+// - Direct formulas: for each row, we also express c_i in terms of e_j = w_j + w_j' and
+//   o_j = w_j - w_j' for the pairs {j, j'}. The even (resp. odd) coefficients only depend on
+//   the e_j (resp. o_j). For each row we take the form with the smaller s_i, and the cheaper
+//   one on a tie.
+// - Search: as in the hand-written sequences, the registers r_j start from w_j and are
+//   reduced to the c_i by elimination. A register holds a combination of the c_i known
+//   modulo 2^(w - l) for some loss l. A step r_j = alpha r_j + beta x with a register or a
+//   value x cancels a coefficient of r_j, and the content 2^s d of the result is divided out
+//   by a shift by s and a multiplication by d^(-1), so l grows by s. A step may also set r_j
+//   to c_i by the direct formula. The steps keep the registers linearly independent and the
+//   losses within w - p. A beam search over the step sequences ranks the states by their
+//   cost plus twice the number of coefficients left to cancel, and each state of the beam is
+//   also completed by the direct formulas, which bounds the result by them.
+//   The cost counts additions, shifts, and multiplications, where a constant c is
+//   a shift if |c| is a power of two, two shifts and an addition if |c| = 2^u -+ 2^v, and
+//   a multiplication otherwise.
+
+// ================
+// Optimization guide.
+/*
+
+1. The precision is what matters for Z_{2^13} and Z_{2^16} schemes: with word=16, the scheme
+   is usable for Z_{2^q} if NAME_PRECISION >= q. Try several point sets; the generator reports
+   the precision and the cost of each.
+
+2. Points with small numerators and denominators give small constants. Pairs {z, -z} halve
+   the evaluation cost and split the interpolation into the even and odd coefficients.
+
+3. Lowering precision lets the search divide out more powers of two, which is how
+   TC5_interpol in TC.c saves its multiplications. A wider beam rarely helps beyond k = 5;
+   compare the reported costs before settling on one.
+
+*/
+
+#define MAX_K 8
+#define MAX_N (2 * MAX_K - 1)
+
+struct frac {
+    int64_t num;
+    int64_t den;
+};
+
+static size_t k, n;
+static int64_t pa[MAX_N], pb[MAX_N];
+static size_t partner[MAX_N];
+static unsigned word;
+
+static
+void usage(const char *prog){
+    fprintf(stderr, "usage: %s name=NAME k=k points=z0,z1,... [word=16|32] [type=TYPE] [precision=p] [beam=B]\n", prog);
+    exit(1);
+}
+
+static
+void overflow(void){
+    fprintf(stderr, "gen_Toom: 64-bit overflow, choose points with smaller numerators and denominators\n");
+    exit(1);
+}
+
+static
+int64_t add64(int64_t a, int64_t b){
+    int64_t c;
+    if(__builtin_add_overflow(a, b, &c)){
+        overflow();
+    }
+    return c;
+}
+
+static
+int64_t mul64(int64_t a, int64_t b){
+    int64_t c;
+    if(__builtin_mul_overflow(a, b, &c)){
+        overflow();
+    }
+    return c;
+}
+
+static
+int64_t gcd64(int64_t a, int64_t b){
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+    while(b){
+        int64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static
+struct frac frac_reduce(int64_t num, int64_t den){
+    struct frac r;
+    int64_t g = gcd64(num, den);
+    if(den < 0){
+        num = -num;
+        den = -den;
+    }
+    if(g > 1){
+        num /= g;
+        den /= g;
+    }
+    if(num == 0){
+        den = 1;
+    }
+    r.num = num;
+    r.den = den;
+    return r;
+}
+
+static
+struct frac frac_add(struct frac x, struct frac y){
+    int64_t g = gcd64(x.den, y.den);
+    int64_t l = mul64(x.den / g, y.den);
+    return frac_reduce(add64(mul64(x.num, l / x.den), mul64(y.num, l / y.den)), l);
+}
+
+static
+struct frac frac_mul(struct frac x, struct frac y){
+    int64_t g1 = gcd64(x.num, y.den), g2 = gcd64(y.num, x.den);
+    g1 = g1 ? g1 : 1;
+    g2 = g2 ? g2 : 1;
+    return frac_reduce(mul64(x.num / g1, y.num / g2), mul64(x.den / g2, y.den / g1));
+}
+
+// The inverse of the odd a modulo 2^64 with Newton's iteration.
+static
+uint64_t inv_odd64(uint64_t a){
+    uint64_t x = a;
+    for(size_t i = 0; i < 6; i++){
+        x *= 2 - a * x;
+    }
+    return x;
+}
+
+// The signed representative of a modulo 2^word.
+static
+int64_t signed_word(uint64_t a){
+    uint64_t m = (uint64_t)1 << word;
+    a &= m - 1;
+    if(a >> (word - 1)){
+        return (int64_t)a - (int64_t)m;
+    }
+    return (int64_t)a;
+}
+
+// ================
+// Cost model and term printing.
+
+struct cost {
+    size_t add, shift, mul;
+};
+
+static
+size_t ctz64(uint64_t a){
+    size_t s = 0;
+    while(!(a & 1)){
+        a >>= 1;
+        s++;
+    }
+    return s;
+}
+
+static
+bool is_pow2(uint64_t a){
+    return a && !(a & (a - 1));
+}
+
+// Finds u > v with c = 2^u + sgn 2^v, sgn = -+ 1.
+static
+bool two_terms(uint64_t c, size_t *u, size_t *v, int *sgn){
+    size_t t = ctz64(c);
+    uint64_t h = c >> t;
+    if(is_pow2(h - 1)){
+        *u = ctz64(h - 1) + t;
+        *v = t;
+        *sgn = 1;
+        return true;
+    }
+    if(is_pow2(h + 1)){
+        *u = ctz64(h + 1) + t;
+        *v = t;
+        *sgn = -1;
+        return true;
+    }
+    return false;
+}
+
+// printf to out if out is non-NULL.
+static
+void emit(FILE *out, const char *fmt, ...){
+    va_list args;
+    if(out == NULL){
+        return;
+    }
+    va_start(args, fmt);
+    vfprintf(out, fmt, args);
+    va_end(args);
+}
+
+// Adds the cost of c * x to *cost, and prints " + c * x" with shifts to out.
+// first indicates the first term of a sum.
+static
+void term(FILE *out, struct cost *cost, int64_t c, const char *x, bool first){
+
+    uint64_t a = c < 0 ? -(uint64_t)c : (uint64_t)c;
+    size_t u, v;
+    int sgn;
+
+    if(c == 0){
+        return;
+    }
+
+    if(!first){
+        cost->add++;
+        emit(out, c < 0 ? " - " : " + ");
+    }else if(c < 0){
+        emit(out, "-");
+    }
+
+    if(a == 1){
+        emit(out, "%s", x);
+    }else if(is_pow2(a)){
+        cost->shift++;
+        emit(out, "(%s << %zu)", x, ctz64(a));
+    }else if(two_terms(a, &u, &v, &sgn)){
+        cost->add++;
+        cost->shift += 1 + (v > 0);
+        if(v > 0){
+            emit(out, "((%s << %zu) %c (%s << %zu))", x, u, sgn > 0 ? '+' : '-', x, v);
+        }else{
+            emit(out, "((%s << %zu) %c %s)", x, u, sgn > 0 ? '+' : '-', x);
+        }
+    }else{
+        cost->mul++;
+        emit(out, "%s * %lld", x, (long long)a);
+    }
+
+}
+
+static
+size_t cost_total(struct cost c){
+    // A multiplication is counted as three simple operations.
+    return c.add + c.shift + 3 * c.mul;
+}
+
+// Prints "    des = sum_j c[j] x[j];" and adds the cost to *cost.
+// The sum is cast to cast if cast is non-NULL. The generated code computes in uint32_t
+// so that the shifts and the wrap-around of the sums are well-defined for both words.
+static
+void print_sum(FILE *out, struct cost *cost, const char *des, const char *cast, const int64_t *c, char x[][64], size_t len){
+
+    bool first = true;
+
+    emit(out, "    %s = ", des);
+    if(cast != NULL){
+        emit(out, "(%s)(", cast);
+    }
+    for(size_t j = 0; j < len; j++){
+        int64_t cj = signed_word((uint64_t)c[j]);
+        if(cj == 0){
+            continue;
+        }
+        term(out, cost, cj, x[j], first);
+        first = false;
+    }
+    if(first){
+        emit(out, "0");
+    }
+    emit(out, cast != NULL ? ");\n" : ";\n");
+
+}
+
+// ================
+// Points.
+
+static
+void parse_point(const char *s, size_t l, size_t j){
+
+    char buff[64];
+    char *end;
+
+    if((l == 0) || (l >= sizeof(buff))){
+        fprintf(stderr, "gen_Toom: invalid point\n");
+        exit(1);
+    }
+    memcpy(buff, s, l);
+    buff[l] = '\0';
+
+    if(strcmp(buff, "inf") == 0){
+        pa[j] = 1;
+        pb[j] = 0;
+        return;
+    }
+
+    pa[j] = strtoll(buff, &end, 10);
+    pb[j] = 1;
+    if(*end == '/'){
+        pb[j] = strtoll(end + 1, &end, 10);
+    }
+    if((*end != '\0') || (pb[j] <= 0)){
+        fprintf(stderr, "gen_Toom: invalid point %s\n", buff);
+        exit(1);
+    }
+    struct frac r = frac_reduce(pa[j], pb[j]);
+    pa[j] = r.num;
+    pb[j] = r.den;
+
+}
+
+static
+void print_point(FILE *out, size_t j){
+    if(pb[j] == 0){
+        fprintf(out, "inf");
+    }else if(pb[j] == 1){
+        fprintf(out, "%lld", (long long)pa[j]);
+    }else{
+        fprintf(out, "%lld/%lld", (long long)pa[j], (long long)pb[j]);
+    }
+}
+
+// ================
+// Evaluation.
+
+// src[i] is multiplied by a^i b^(k - 1 - i).
+static
+int64_t eval_const(size_t j, size_t i){
+    int64_t c = 1;
+    for(size_t t = 0; t < i; t++){
+        c = mul64(c, pa[j]);
+    }
+    for(size_t t = i; t < k - 1; t++){
+        c = mul64(c, pb[j]);
+    }
+    return c;
+}
+
+static
+void print_eval_body(FILE *out, struct cost *cost, const char *type){
+
+    int64_t c[MAX_K];
+    char x[MAX_K][64];
+    char des[64];
+
+    for(size_t j = 0; j < n; j++){
+
+        if(partner[j] < j){
+            continue;
+        }
+
+        if(partner[j] == n){
+            emit(out, "    // ");
+            if(out != NULL){
+                print_point(out, j);
+            }
+            emit(out, "\n");
+            for(size_t i = 0; i < k; i++){
+                c[i] = eval_const(j, i);
+                snprintf(x[i], sizeof(x[i]), "a[%zu]", i);
+            }
+            snprintf(des, sizeof(des), "des[%zu]", j);
+            print_sum(out, cost, des, type, c, x, k);
+            continue;
+        }
+
+        emit(out, "    // {");
+        if(out != NULL){
+            print_point(out, j);
+            fprintf(out, ", ");
+            print_point(out, partner[j]);
+        }
+        emit(out, "}\n");
+        for(size_t parity = 0; parity < 2; parity++){
+            size_t len = 0;
+            for(size_t i = parity; i < k; i += 2){
+                c[len] = eval_const(j, i);
+                snprintf(x[len], sizeof(x[len]), "a[%zu]", i);
+                len++;
+            }
+            print_sum(out, cost, parity ? "o" : "e", NULL, c, x, len);
+        }
+        emit(out, "    des[%zu] = (%s)(e + o);\n", j, type);
+        emit(out, "    des[%zu] = (%s)(e - o);\n", partner[j], type);
+        cost->add += 2;
+
+    }
+
+}
+
+static
+void print_eval(const char *name, const char *type){
+
+    struct cost cost = {0, 0, 0};
+
+    print_eval_body(NULL, &cost, type);
+
+    printf("// Toom-%zu evaluation at {", k);
+    for(size_t j = 0; j < n; j++){
+        print_point(stdout, j);
+        printf(j + 1 < n ? ", " : "}.\n");
+    }
+    printf("// The point a/b is scaled by b^%zu.\n", k - 1);
+    printf("// Cost: %zu additions, %zu shifts, %zu multiplications.\n", cost.add, cost.shift, cost.mul);
+    printf("static inline\n");
+    printf("void %s_eval(%s *des, const %s *src){\n\n", name, type, type);
+    printf("    uint32_t a[%zu];\n", k);
+    for(size_t j = 0; j < n; j++){
+        if(partner[j] != n){
+            printf("    uint32_t e, o;\n");
+            break;
+        }
+    }
+    printf("\n");
+    printf("    for(size_t i = 0; i < %zu; i++){\n", k);
+    printf("        a[i] = src[i];\n");
+    printf("    }\n\n");
+
+    print_eval_body(stdout, &cost, type);
+
+    printf("\n}\n\n");
+
+}
+
+// ================
+// Interpolation.
+
+// vmat[j][i] = a_j^i b_j^(n - 1 - i) is the entry of V for the value j and the coefficient i,
+// and vinv[i][j] is the entry of V^(-1) for the coefficient i and the value j.
+static int64_t vmat[MAX_N][MAX_N];
+static struct frac vinv[MAX_N][MAX_N];
+
+static
+void compute_vinv(void){
+
+    struct frac poly[MAX_N];
+
+    for(size_t j = 0; j < n; j++){
+
+        size_t d = 0;
+
+        poly[0] = frac_reduce(1, 1);
+
+        for(size_t m = 0; m < n; m++){
+
+            struct frac alpha, beta, lo, hi;
+            int64_t den;
+
+            if(m == j){
+                continue;
+            }
+
+            // (b_m X - a_m Y) / (b_m a_j - a_m b_j)
+            den = add64(mul64(pb[m], pa[j]), -mul64(pa[m], pb[j]));
+            if(den == 0){
+                fprintf(stderr, "gen_Toom: the points are not distinct\n");
+                exit(1);
+            }
+            alpha = frac_reduce(pb[m], den);
+            beta = frac_reduce(-pa[m], den);
+
+            // poly[i] is the coefficient of X^i Y^(d - i).
+            poly[d + 1] = frac_reduce(0, 1);
+            for(size_t i = d + 2; i-- > 0;){
+                lo = frac_mul(beta, poly[i]);
+                hi = (i > 0) ? frac_mul(alpha, poly[i - 1]) : frac_reduce(0, 1);
+                if(i == d + 1){
+                    poly[i] = hi;
+                }else{
+                    poly[i] = frac_add(lo, hi);
+                }
+            }
+            d++;
+
+        }
+
+        for(size_t i = 0; i < n; i++){
+            vinv[i][j] = poly[i];
+        }
+
+    }
+
+    for(size_t j = 0; j < n; j++){
+        for(size_t i = 0; i < n; i++){
+            vmat[j][i] = 1;
+            for(size_t t = 0; t < i; t++){
+                vmat[j][i] = mul64(vmat[j][i], pa[j]);
+            }
+            for(size_t t = i; t < n - 1; t++){
+                vmat[j][i] = mul64(vmat[j][i], pb[j]);
+            }
+        }
+    }
+
+    // Check V^(-1) V = I.
+    for(size_t i = 0; i < n; i++){
+        for(size_t i2 = 0; i2 < n; i2++){
+            struct frac acc = frac_reduce(0, 1);
+            for(size_t j = 0; j < n; j++){
+                acc = frac_add(acc, frac_mul(vinv[i][j], frac_reduce(vmat[j][i2], 1)));
+            }
+            if((acc.num != (i == i2)) || (acc.den != 1)){
+                fprintf(stderr, "gen_Toom: internal error in the interpolation matrix\n");
+                exit(1);
+            }
+        }
+    }
+
+}
+
+// A direct formula c_i = ((sum_j num[j] x_j) >> shift) odd^(-1) where x_j is w_j if paired
+// is false. Otherwise, x_j is e_j = w_j + w_j' for j < j', o_j = w_j' - w_j for j > j' in a
+// pair {j', j}, and w_j for the unpaired j. The e_j and the o_j are computed once.
+struct row {
+    bool paired;
+    int64_t num[MAX_N];
+    size_t shift;
+    int64_t odd;
+    struct cost cost;
+};
+
+static
+void row_names(char names[][64], const struct row *r){
+    for(size_t j = 0; j < n; j++){
+        if(!r->paired || (partner[j] == n)){
+            snprintf(names[j], 64, "w[%zu]", j);
+        }else{
+            snprintf(names[j], 64, "%c[%zu]", j < partner[j] ? 'e' : 'o', j);
+        }
+    }
+}
+
+// Prints "    des >>= shift;" and "    des *= mult;" and adds the cost to *cost.
+// For words shorter than 32 bits, the bits above the word are cleared before the shift.
+static
+void print_normalize(FILE *out, struct cost *cost, const char *des, size_t shift, uint64_t mult){
+    if(shift){
+        cost->shift++;
+        if(word < 32){
+            emit(out, "    %s = (%s & 0x%x) >> %zu;\n", des, des, (1u << word) - 1, shift);
+        }else{
+            emit(out, "    %s >>= %zu;\n", des, shift);
+        }
+    }
+    if(signed_word(mult) != 1){
+        cost->mul++;
+        emit(out, "    %s *= %lld;\n", des, (long long)signed_word(mult));
+    }
+}
+
+// Prints "    des = c_i;" with the direct formula r and adds the cost to *cost.
+static
+void print_row(FILE *out, struct cost *cost, const char *des, const struct row *r){
+
+    char names[MAX_N][64];
+
+    row_names(names, r);
+    print_sum(out, cost, des, NULL, r->num, names, n);
+    print_normalize(out, cost, des, r->shift, inv_odd64((uint64_t)r->odd));
+
+}
+
+static
+void make_row(struct row *r, size_t i, bool paired){
+
+    struct frac x[MAX_N];
+    int64_t l = 1;
+
+    for(size_t j = 0; j < n; j++){
+        x[j] = vinv[i][j];
+    }
+
+    if(paired){
+        for(size_t j = 0; j < n; j++){
+            size_t jj = partner[j];
+            if((jj != n) && (j < jj)){
+                // v_j w_j + v_jj w_jj = (v_j + v_jj) / 2 e_j + (v_j - v_jj) / 2 o_jj
+                struct frac half = frac_reduce(1, 2);
+                struct frac s = frac_mul(frac_add(vinv[i][j], vinv[i][jj]), half);
+                struct frac t = frac_mul(frac_add(vinv[i][j], frac_reduce(-vinv[i][jj].num, vinv[i][jj].den)), half);
+                x[j] = s;
+                x[jj] = t;
+            }
+        }
+    }
+
+    for(size_t j = 0; j < n; j++){
+        l = mul64(l / gcd64(l, x[j].den), x[j].den);
+    }
+
+    r->paired = paired;
+    r->shift = ctz64((uint64_t)l);
+    r->odd = l >> r->shift;
+    for(size_t j = 0; j < n; j++){
+        r->num[j] = mul64(x[j].num, l / x[j].den);
+    }
+
+    r->cost.add = r->cost.shift = r->cost.mul = 0;
+    print_row(NULL, &r->cost, "r", r);
+
+}
+
+// ================
+// Interpolation sequences.
+
+// The registers r_0, ..., r_(n - 1) hold linear combinations reg[j][0] c_0 + ... of the
+// coefficients, and r_j is known modulo 2^(word - loss[j]).
+// A step is
+//     r_des = ((alpha r_des + beta x) >> shift) odd^(-1),
+// where x is the register r_src if src < n and the value w_(src - n) otherwise,
+// or, if direct is true, r_des = c_coef with the direct formula.
+struct step {
+    bool direct;
+    size_t des, src, coef;
+    int64_t alpha, beta;
+    size_t shift;
+    int64_t odd;
+};
+
+struct state {
+    int64_t reg[MAX_N][MAX_N];
+    size_t loss[MAX_N];
+    struct cost cost;
+    // The index of the last step in the history.
+    size_t hist;
+};
+
+// A child of a state in the beam.
+struct cand {
+    size_t parent;
+    struct step step;
+    int64_t row[MAX_N];
+    size_t loss;
+    struct cost cost;
+    size_t score, seq;
+};
+
+// The steps leading to the states of the beams, linked to the previous steps.
+struct hist {
+    size_t parent;
+    struct step step;
+};
+
+#define HIST_NONE SIZE_MAX
+
+static struct row direct_rows[MAX_N];
+static size_t max_loss, beam_width;
+
+static struct hist *hists;
+static size_t n_hists, cap_hists;
+
+static
+size_t push_hist(size_t parent, const struct step *step){
+    if(n_hists == cap_hists){
+        cap_hists = cap_hists ? 2 * cap_hists : 1024;
+        hists = realloc(hists, cap_hists * sizeof(struct hist));
+        if(hists == NULL){
+            fprintf(stderr, "gen_Toom: out of memory\n");
+            exit(1);
+        }
+    }
+    hists[n_hists].parent = parent;
+    hists[n_hists].step = *step;
+    return n_hists++;
+}
+
+static
+size_t nnz(const int64_t *row){
+    size_t c = 0;
+    for(size_t i = 0; i < n; i++){
+        c += (row[i] != 0);
+    }
+    return c;
+}
+
+// A register is solved if it holds -+ c_i.
+static
+bool solved(const int64_t *row){
+    size_t c = 0;
+    for(size_t i = 0; i < n; i++){
+        if(row[i] != 0){
+            if((row[i] != 1) && (row[i] != -1)){
+                return false;
+            }
+            c++;
+        }
+    }
+    return c == 1;
+}
+
+// Divides row by its content 2^shift odd.
+static
+void normalize(int64_t *row, size_t *shift, int64_t *odd){
+    int64_t g = 0;
+    for(size_t i = 0; i < n; i++){
+        g = gcd64(g, row[i]);
+    }
+    if(g <= 1){
+        *shift = 0;
+        *odd = 1;
+        return;
+    }
+    for(size_t i = 0; i < n; i++){
+        row[i] /= g;
+    }
+    *shift = ctz64((uint64_t)g);
+    *odd = g >> *shift;
+}
+
+// Prints the step with the comment "    // r_des = ..." of the result row,
+// and adds the cost to *cost.
+static
+void print_step(FILE *out, struct cost *cost, const struct step *step, const int64_t *row){
+
+    char des[64];
+    char x[2][64];
+    int64_t c[2];
+    bool first = true;
+    size_t u;
+
+    snprintf(des, sizeof(des), "r[%zu]", step->des);
+
+    if(out != NULL){
+        fprintf(out, "    // ");
+        for(size_t i = 0; i < n; i++){
+            int64_t a = row[i] < 0 ? -row[i] : row[i];
+            if(row[i] == 0){
+                continue;
+            }
+            fprintf(out, "%s", first ? (row[i] < 0 ? "-" : "") : (row[i] < 0 ? " - " : " + "));
+            if(a != 1){
+                fprintf(out, "%lld ", (long long)a);
+            }
+            fprintf(out, "c%zu", i);
+            first = false;
+        }
+        fprintf(out, "\n");
+    }
+
+    if(step->direct){
+        print_row(out, cost, des, &direct_rows[step->coef]);
+        return;
+    }
+
+    // The positive term goes first.
+    u = (step->alpha < 0) && (step->beta > 0);
+    c[u] = step->alpha;
+    c[1 - u] = step->beta;
+    snprintf(x[u], sizeof(x[u]), "%s", des);
+    if(step->src < n){
+        snprintf(x[1 - u], sizeof(x[1 - u]), "r[%zu]", step->src);
+    }else{
+        snprintf(x[1 - u], sizeof(x[1 - u]), "w[%zu]", step->src - n);
+    }
+    print_sum(out, cost, des, NULL, c, x, 2);
+    print_normalize(out, cost, des, step->shift, inv_odd64((uint64_t)step->odd));
+
+}
+
+#define RANK_P 0x7fffffff
+
+static
+uint64_t mod_p(int64_t a){
+    int64_t r = a % RANK_P;
+    return (uint64_t)(r < 0 ? r + RANK_P : r);
+}
+
+// Computes the inverse of the matrix of the registers of s over Z_(2^31 - 1).
+// Returns false if the matrix is singular.
+static
+bool inverse_mod_p(uint64_t inv[MAX_N][MAX_N], const struct state *s){
+
+    uint64_t a[MAX_N][2 * MAX_N];
+
+    for(size_t j = 0; j < n; j++){
+        for(size_t i = 0; i < n; i++){
+            a[j][i] = mod_p(s->reg[j][i]);
+            a[j][n + i] = (i == j);
+        }
+    }
+
+    for(size_t i = 0; i < n; i++){
+        size_t piv = i;
+        uint64_t r = 1, b, e;
+        while((piv < n) && (a[piv][i] == 0)){
+            piv++;
+        }
+        if(piv == n){
+            return false;
+        }
+        for(size_t t = 0; t < 2 * n; t++){
+            uint64_t tmp = a[i][t];
+            a[i][t] = a[piv][t];
+            a[piv][t] = tmp;
+        }
+        // a[i][i]^(p - 2)
+        for(b = a[i][i], e = RANK_P - 2; e; e >>= 1){
+            if(e & 1){
+                r = r * b % RANK_P;
+            }
+            b = b * b % RANK_P;
+        }
+        for(size_t t = 0; t < 2 * n; t++){
+            a[i][t] = a[i][t] * r % RANK_P;
+        }
+        for(size_t j = 0; j < n; j++){
+            uint64_t f = a[j][i];
+            if((j == i) || (f == 0)){
+                continue;
+            }
+            for(size_t t = 0; t < 2 * n; t++){
+                a[j][t] = (a[j][t] + (RANK_P - f) * a[i][t]) % RANK_P;
+            }
+        }
+    }
+
+    for(size_t j = 0; j < n; j++){
+        for(size_t i = 0; i < n; i++){
+            inv[j][i] = a[j][n + i];
+        }
+    }
+
+    return true;
+
+}
+
+// Replacing the register j by row keeps the registers independent if and only if
+// the coordinate j of row in the basis of the registers is nonzero.
+static
+bool keeps_rank(uint64_t inv[MAX_N][MAX_N], size_t j, const int64_t *row){
+    uint64_t y = 0;
+    for(size_t i = 0; i < n; i++){
+        y = (y + mod_p(row[i]) * inv[i][j]) % RANK_P;
+    }
+    return y != 0;
+}
+
+static
+int cand_cmp(const void *x, const void *y){
+    const struct cand *a = x, *b = y;
+    if(a->score != b->score){
+        return a->score < b->score ? -1 : 1;
+    }
+    return a->seq < b->seq ? -1 : (a->seq > b->seq);
+}
+
+// The pool of candidates is a max-heap by (score, seq) holding the best ones.
+static struct cand *pool;
+static size_t n_pool, cap_pool, n_seq;
+
+static
+void pool_sift_down(size_t i){
+    for(;;){
+        size_t l = 2 * i + 1, m = i;
+        if((l < n_pool) && (cand_cmp(pool + l, pool + m) > 0)){
+            m = l;
+        }
+        if((l + 1 < n_pool) && (cand_cmp(pool + l + 1, pool + m) > 0)){
+            m = l + 1;
+        }
+        if(m == i){
+            return;
+        }
+        struct cand t = pool[i];
+        pool[i] = pool[m];
+        pool[m] = t;
+        i = m;
+    }
+}
+
+static
+bool pool_accepts(size_t score){
+    return (n_pool < cap_pool) || (score < pool[0].score);
+}
+
+static
+void pool_push(const struct cand *c){
+    if(n_pool < cap_pool){
+        size_t i = n_pool++;
+        pool[i] = *c;
+        while((i > 0) && (cand_cmp(pool + (i - 1) / 2, pool + i) < 0)){
+            struct cand t = pool[i];
+            pool[i] = pool[(i - 1) / 2];
+            pool[(i - 1) / 2] = t;
+            i = (i - 1) / 2;
+        }
+        return;
+    }
+    pool[0] = *c;
+    pool_sift_down(0);
+}
+
+// The number of additions for negating the solved registers holding -c_i.
+static
+size_t negations(const struct state *s){
+    size_t c = 0;
+    for(size_t j = 0; j < n; j++){
+        for(size_t i = 0; i < n; i++){
+            c += (s->reg[j][i] == -1);
+        }
+    }
+    return c;
+}
+
+static struct state best;
+static size_t best_total;
+
+// Offers the child of parent with the register des replaced by row.
+static
+void offer(const struct state *parent, size_t parent_index, size_t h, const struct step *step,
+           const int64_t *row, size_t loss, struct cost cost){
+
+    struct cand c;
+    size_t des = step->des;
+    size_t old_nnz = nnz(parent->reg[des]), new_nnz = nnz(row);
+    bool all_solved = true;
+
+    if((loss > max_loss) || (new_nnz == 0) || (cost_total(cost) >= best_total)){
+        return;
+    }
+
+    if(solved(row)){
+        // Another register may already hold the coefficient.
+        size_t i = 0;
+        while(row[i] == 0){
+            i++;
+        }
+        for(size_t j = 0; j < n; j++){
+            if((j == des) || !solved(parent->reg[j])){
+                all_solved = all_solved && (j == des);
+                continue;
+            }
+            if(parent->reg[j][i] != 0){
+                return;
+            }
+        }
+    }else{
+        all_solved = false;
+    }
+
+    h = h - (old_nnz - 1) + (new_nnz - 1);
+
+    if(all_solved){
+        struct state s = *parent;
+        memcpy(s.reg[des], row, sizeof(s.reg[des]));
+        s.loss[des] = loss;
+        s.cost = cost;
+        if(cost_total(cost) + negations(&s) < best_total){
+            best = s;
+            best.hist = push_hist(parent->hist, step);
+            best_total = cost_total(cost) + negations(&s);
+        }
+        return;
+    }
+
+    c.score = cost_total(cost) + 2 * h;
+    if(!pool_accepts(c.score)){
+        return;
+    }
+    c.parent = parent_index;
+    c.step = *step;
+    memcpy(c.row, row, sizeof(c.row));
+    c.loss = loss;
+    c.cost = cost;
+    c.seq = n_seq++;
+    pool_push(&c);
+
+}
+
+// Reduces the entries of row to (-2^(m - 1), 2^(m - 1)]. A register known modulo 2^m
+// only depends on its entries modulo 2^m.
+static
+void reduce(int64_t *row, size_t m){
+    uint64_t mask = ((uint64_t)1 << m) - 1;
+    for(size_t i = 0; i < n; i++){
+        uint64_t a = (uint64_t)row[i] & mask;
+        row[i] = (a > (mask >> 1) + 1) ? (int64_t)a - (int64_t)(mask + 1) : (int64_t)a;
+    }
+}
+
+// Computes the row and the loss of r_des = alpha r_des + beta x for the step, reduces it,
+// and divides out its content 2^shift odd. Returns false on overflow.
+static
+bool combine(const struct state *s, struct step *step, int64_t *row, size_t *loss){
+
+    const int64_t *rj = s->reg[step->des];
+    const int64_t *x = step->src < n ? s->reg[step->src] : vmat[step->src - n];
+    size_t lx = step->src < n ? s->loss[step->src] : 0;
+    size_t la, lb;
+
+    for(size_t t = 0; t < n; t++){
+        int64_t u, v;
+        if(__builtin_mul_overflow(step->alpha, rj[t], &u) ||
+           __builtin_mul_overflow(step->beta, x[t], &v) ||
+           __builtin_add_overflow(u, v, row + t)){
+            return false;
+        }
+    }
+
+    // alpha r_des is known modulo 2^(word - loss[des] + v_2(alpha)).
+    la = ctz64((uint64_t)step->alpha);
+    lb = ctz64((uint64_t)(step->beta < 0 ? -step->beta : step->beta));
+    la = s->loss[step->des] > la ? s->loss[step->des] - la : 0;
+    lb = lx > lb ? lx - lb : 0;
+    *loss = la > lb ? la : lb;
+
+    reduce(row, word - *loss);
+    normalize(row, &step->shift, &step->odd);
+    *loss += step->shift;
+
+    return true;
+
+}
+
+static
+void expand(const struct state *s, size_t index){
+
+    uint64_t inv[MAX_N][MAX_N];
+    size_t h = 0;
+
+    if(!inverse_mod_p(inv, s)){
+        return;
+    }
+
+    for(size_t j = 0; j < n; j++){
+        h += nnz(s->reg[j]) - 1;
+    }
+
+    for(size_t j = 0; j < n; j++){
+
+        const int64_t *rj = s->reg[j];
+        size_t nz = nnz(rj);
+
+        if(solved(rj)){
+            continue;
+        }
+
+        // r_j = ((alpha r_j + beta x) >> shift) odd^(-1) cancelling the entry i.
+        for(size_t src = 0; src < 2 * n; src++){
+
+            const int64_t *x = src < n ? s->reg[src] : vmat[src - n];
+
+            if(src == j){
+                continue;
+            }
+
+            for(size_t i = 0; i < n; i++){
+
+                struct step step;
+                int64_t row[MAX_N], g;
+                size_t loss;
+                struct cost cost = s->cost;
+
+                if((rj[i] == 0) || (x[i] == 0)){
+                    continue;
+                }
+
+                g = gcd64(rj[i], x[i]);
+                step.direct = false;
+                step.des = j;
+                step.src = src;
+                step.coef = 0;
+                step.alpha = x[i] / g;
+                step.beta = -(rj[i] / g);
+                if(step.alpha < 0){
+                    step.alpha = -step.alpha;
+                    step.beta = -step.beta;
+                }
+
+                if(!combine(s, &step, row, &loss) || (nnz(row) >= nz) || !keeps_rank(inv, j, row)){
+                    continue;
+                }
+
+                print_step(NULL, &cost, &step, row);
+                offer(s, index, h, &step, row, loss, cost);
+
+            }
+
+        }
+
+        // r_j = c_i with the direct formula.
+        for(size_t i = 0; i < n; i++){
+
+            struct step step;
+            int64_t row[MAX_N] = {0};
+            struct cost cost = s->cost;
+
+            if(inv[i][j] == 0){
+                continue;
+            }
+
+            step.direct = true;
+            step.des = j;
+            step.src = 0;
+            step.coef = i;
+            step.alpha = step.beta = 0;
+            step.shift = 0;
+            step.odd = 1;
+            row[i] = 1;
+
+            print_step(NULL, &cost, &step, row);
+            offer(s, index, h, &step, row, direct_rows[i].shift, cost);
+
+        }
+
+    }
+
+}
+
+// Applies the step to the registers of s, and sets the shift and the odd part of the step.
+static
+void apply_step(struct state *s, struct step *step){
+
+    int64_t row[MAX_N] = {0};
+    size_t loss;
+
+    if(step->direct){
+        row[step->coef] = 1;
+        loss = direct_rows[step->coef].shift;
+    }else if(!combine(s, step, row, &loss)){
+        overflow();
+    }
+    memcpy(s->reg[step->des], row, sizeof(row));
+    s->loss[step->des] = loss;
+
+}
+
+// Completes s with the direct formulas for the unsolved registers, which bounds the cost
+// of the search.
+static
+void search_direct(const struct state *from){
+
+    struct state s = *from;
+    struct step steps[MAX_N];
+    size_t n_steps = 0;
+    bool covered[MAX_N] = {false};
+
+    for(size_t j = 0; j < n; j++){
+        for(size_t i = 0; i < n; i++){
+            covered[i] = covered[i] || (solved(s.reg[j]) && (s.reg[j][i] != 0));
+        }
+    }
+
+    for(size_t j = 0; j < n; j++){
+
+        struct step *step = steps + n_steps;
+        size_t i = 0;
+
+        if(solved(s.reg[j])){
+            continue;
+        }
+        while(covered[i]){
+            i++;
+        }
+        covered[i] = true;
+
+        step->direct = true;
+        step->des = j;
+        step->src = 0;
+        step->coef = i;
+        step->alpha = step->beta = 0;
+        step->shift = 0;
+        step->odd = 1;
+        apply_step(&s, step);
+        print_step(NULL, &s.cost, step, s.reg[j]);
+        n_steps++;
+
+    }
+
+    if(cost_total(s.cost) + negations(&s) < best_total){
+        for(size_t t = 0; t < n_steps; t++){
+            s.hist = push_hist(s.hist, steps + t);
+        }
+        best = s;
+        best_total = cost_total(s.cost) + negations(&s);
+    }
+
+}
+
+// Applies the sums and the differences of the pairs {j, j'} as the first steps to s:
+// r_j = w_j + w_j' and r_j' = w_j - w_j' with their contents divided out.
+static
+bool split_pairs(struct state *s){
+
+    bool split = false;
+
+    for(size_t j = 0; j < n; j++){
+
+        size_t jj = partner[j];
+        struct state t = *s;
+        struct step steps[2] = {
+            {.direct = false, .des = j, .src = n + jj, .alpha = 1, .beta = 1},
+            {.direct = false, .des = jj, .src = n + j, .alpha = -1, .beta = 1}
+        };
+        bool ok = true;
+
+        if((jj == n) || (jj < j)){
+            continue;
+        }
+
+        for(size_t u = 0; u < 2; u++){
+            apply_step(&t, steps + u);
+            ok = ok && (t.loss[steps[u].des] <= max_loss);
+            print_step(NULL, &t.cost, steps + u, t.reg[steps[u].des]);
+            t.hist = push_hist(t.hist, steps + u);
+        }
+        if(ok){
+            *s = t;
+            split = true;
+        }
+
+    }
+
+    return split;
+
+}
+
+static
+uint64_t state_hash(const struct state *s){
+    // FNV-1a
+    uint64_t h = 0xcbf29ce484222325;
+    for(size_t j = 0; j < n; j++){
+        for(size_t i = 0; i < n; i++){
+            h = (h ^ (uint64_t)s->reg[j][i]) * 0x100000001b3;
+        }
+        h = (h ^ s->loss[j]) * 0x100000001b3;
+    }
+    return h;
+}
+
+// Beam search from root: each level keeps the beam_width best states by the cost plus
+// twice the number of coefficients still to be cancelled.
+static
+void search(const struct state *root){
+
+    struct state *beam, *next, *tmp;
+    uint64_t *hashes;
+    size_t n_beam = 1;
+
+    beam = malloc(beam_width * sizeof(struct state));
+    next = malloc(beam_width * sizeof(struct state));
+    hashes = malloc(beam_width * sizeof(uint64_t));
+    cap_pool = 4 * beam_width;
+    pool = malloc(cap_pool * sizeof(struct cand));
+    if((beam == NULL) || (next == NULL) || (hashes == NULL) || (pool == NULL)){
+        fprintf(stderr, "gen_Toom: out of memory\n");
+        exit(1);
+    }
+
+    best_total = SIZE_MAX;
+    search_direct(root);
+    beam[0] = *root;
+    beam[1] = *root;
+    if((beam_width > 1) && split_pairs(beam + 1)){
+        n_beam = 2;
+    }
+
+    while(n_beam > 0){
+
+        size_t n_next = 0;
+
+        n_pool = 0;
+        n_seq = 0;
+        for(size_t b = 0; b < n_beam; b++){
+            expand(beam + b, b);
+        }
+        qsort(pool, n_pool, sizeof(struct cand), cand_cmp);
+
+        for(size_t c = 0; (c < n_pool) && (n_next < beam_width); c++){
+
+            const struct cand *cand = pool + c;
+            struct state *s = next + n_next;
+            bool dup = false;
+
+            if(cost_total(cand->cost) >= best_total){
+                continue;
+            }
+
+            *s = beam[cand->parent];
+            memcpy(s->reg[cand->step.des], cand->row, sizeof(cand->row));
+            s->loss[cand->step.des] = cand->loss;
+            s->cost = cand->cost;
+
+            hashes[n_next] = state_hash(s);
+            for(size_t t = 0; (t < n_next) && !dup; t++){
+                dup = (hashes[t] == hashes[n_next]) &&
+                      (memcmp(next[t].reg, s->reg, sizeof(s->reg)) == 0) &&
+                      (memcmp(next[t].loss, s->loss, sizeof(s->loss)) == 0);
+            }
+            if(dup){
+                continue;
+            }
+
+            s->hist = push_hist(beam[cand->parent].hist, &cand->step);
+            search_direct(s);
+            n_next++;
+
+        }
+
+        tmp = beam;
+        beam = next;
+        next = tmp;
+        n_beam = n_next;
+
+    }
+
+    free(beam);
+    free(next);
+    free(hashes);
+    free(pool);
+
+}
+
+static
+void print_interpol(const char *name, const char *type, size_t precision){
+
+    struct state root;
+    struct step *steps;
+    size_t n_steps = 0, max_shift = 0;
+    bool paired = false, use_e = false, use_o = false;
+    bool used[MAX_N] = {false};
+    struct cost cost;
+
+    for(size_t i = 0; i < n; i++){
+        struct row direct, paired;
+        make_row(&direct, i, false);
+        make_row(&paired, i, true);
+        if((paired.shift < direct.shift) ||
+           ((paired.shift == direct.shift) && (cost_total(paired.cost) < cost_total(direct.cost)))){
+            direct_rows[i] = paired;
+        }else{
+            direct_rows[i] = direct;
+        }
+        if(direct_rows[i].shift > max_shift){
+            max_shift = direct_rows[i].shift;
+        }
+    }
+
+    if(max_shift >= word){
+        fprintf(stderr, "gen_Toom: the interpolation loses all %u bits\n", word);
+        exit(1);
+    }
+    if(precision == 0){
+        precision = word - max_shift;
+    }
+    if(precision > word - max_shift){
+        fprintf(stderr, "gen_Toom: the points give at most %zu bits\n", word - max_shift);
+        exit(1);
+    }
+    max_loss = word - precision;
+
+    // The registers start from the values. If a direct formula uses the pairs, the e_j and
+    // the o_j are computed once; the search counts them from the start.
+    memset(&root, 0, sizeof(root));
+    root.hist = HIST_NONE;
+    for(size_t i = 0; i < n; i++){
+        paired = paired || direct_rows[i].paired;
+    }
+    for(size_t j = 0; j < n; j++){
+        memcpy(root.reg[j], vmat[j], sizeof(root.reg[j]));
+        reduce(root.reg[j], word);
+        if(paired && (partner[j] != n) && (j < partner[j])){
+            root.cost.add += 2;
+        }
+    }
+
+    search(&root);
+
+    steps = malloc((n_hists + 1) * sizeof(struct step));
+    if(steps == NULL){
+        fprintf(stderr, "gen_Toom: out of memory\n");
+        exit(1);
+    }
+    for(size_t h = best.hist; h != HIST_NONE; h = hists[h].parent){
+        steps[n_steps++] = hists[h].step;
+    }
+
+    // Only the e_j and the o_j used by the direct formulas are computed.
+    cost = best.cost;
+    cost.add += negations(&best);
+    cost.add -= root.cost.add;
+    for(size_t t = 0; t < n_steps; t++){
+        const struct row *r = direct_rows + steps[t].coef;
+        if(!steps[t].direct || !r->paired){
+            continue;
+        }
+        for(size_t j = 0; j < n; j++){
+            if((partner[j] != n) && (signed_word((uint64_t)r->num[j]) != 0) && !used[j]){
+                used[j] = true;
+                use_e = use_e || (j < partner[j]);
+                use_o = use_o || (j > partner[j]);
+                cost.add++;
+            }
+        }
+    }
+
+    printf("// Toom-%zu interpolation.\n", k);
+    printf("// The values w[j] at a/b are scaled by b^%zu. The register r[j] starts from w[j]. A step cancels\n", n - 1);
+    printf("// a coefficient of a register with another register or a value, and divides out the content\n");
+    printf("// of the result.\n");
+    printf("// The comments give the resulting combination of the coefficients c_i.\n");
+    printf("// The results are correct modulo 2^%zu.\n", precision);
+    printf("// Cost: %zu additions, %zu shifts, %zu multiplications.\n", cost.add, cost.shift, cost.mul);
+    printf("static inline\n");
+    printf("void %s_interpol(%s *des, const %s *src){\n\n", name, type, type);
+    printf("    uint32_t w[%zu], r[%zu];\n", n, n);
+    if(use_e){
+        printf("    uint32_t e[%zu];\n", n);
+    }
+    if(use_o){
+        printf("    uint32_t o[%zu];\n", n);
+    }
+    printf("\n");
+    printf("    for(size_t i = 0; i < %zu; i++){\n", n);
+    printf("        w[i] = src[i];\n");
+    printf("        r[i] = w[i];\n");
+    printf("    }\n\n");
+
+    for(size_t j = 0; j < n; j++){
+        if(used[j] && (j < partner[j])){
+            printf("    e[%zu] = w[%zu] + w[%zu];\n", j, j, partner[j]);
+        }
+        if(used[j] && (j > partner[j])){
+            printf("    o[%zu] = w[%zu] - w[%zu];\n", j, partner[j], j);
+        }
+    }
+    if(use_e || use_o){
+        printf("\n");
+    }
+
+    for(size_t t = n_steps; t-- > 0;){
+        struct cost dummy = {0, 0, 0};
+        apply_step(&root, steps + t);
+        print_step(stdout, &dummy, steps + t, root.reg[steps[t].des]);
+    }
+    printf("\n");
+
+    for(size_t i = 0; i < n; i++){
+        for(size_t j = 0; j < n; j++){
+            if(best.reg[j][i] != 0){
+                printf("    des[%zu] = (%s)(%sr[%zu]);\n", i, type, best.reg[j][i] < 0 ? "-" : "", j);
+            }
+        }
+    }
+
+    printf("\n}\n\n");
+    printf("#define %s_PRECISION %zu\n\n", name, precision);
+
+    free(steps);
+    free(hists);
+    hists = NULL;
+    n_hists = cap_hists = 0;
+
+}
+
+int main(int argc, char **argv){
+
+    const char *name = NULL, *type = NULL, *points_str = NULL;
+    size_t n_points = 0, precision = 0;
+
+    k = 0;
+    word = 32;
+    beam_width = 256;
+
+    for(int i = 1; i < argc; i++){
+        if(strncmp(argv[i], "name=", 5) == 0){
+            name = argv[i] + 5;
+        }else if(strncmp(argv[i], "k=", 2) == 0){
+            k = strtoull(argv[i] + 2, NULL, 0);
+        }else if(strncmp(argv[i], "points=", 7) == 0){
+            points_str = argv[i] + 7;
+        }else if(strncmp(argv[i], "word=", 5) == 0){
+            word = strtoul(argv[i] + 5, NULL, 0);
+        }else if(strncmp(argv[i], "type=", 5) == 0){
+            type = argv[i] + 5;
+        }else if(strncmp(argv[i], "precision=", 10) == 0){
+            precision = strtoull(argv[i] + 10, NULL, 0);
+        }else if(strncmp(argv[i], "beam=", 5) == 0){
+            beam_width = strtoull(argv[i] + 5, NULL, 0);
+        }else{
+            usage(argv[0]);
+        }
+    }
+
+    if((name == NULL) || (points_str == NULL) || (k < 2) || (k > MAX_K) || ((word != 16) && (word != 32)) ||
+       (precision > word) || (beam_width == 0)){
+        usage(argv[0]);
+    }
+    if(type == NULL){
+        type = (word == 16) ? "int16_t" : "int32_t";
+    }
+    n = 2 * k - 1;
+
+    for(const char *p = points_str; *p;){
+        size_t l = strcspn(p, ",");
+        if(n_points == n){
+            fprintf(stderr, "gen_Toom: Toom-%zu needs %zu points\n", k, n);
+            exit(1);
+        }
+        parse_point(p, l, n_points++);
+        p += l + (p[l] == ',');
+    }
+    if(n_points != n){
+        fprintf(stderr, "gen_Toom: Toom-%zu needs %zu points\n", k, n);
+        exit(1);
+    }
+
+    for(size_t j = 0; j < n; j++){
+        partner[j] = n;
+        for(size_t m = 0; m < n; m++){
+            if((m != j) && (pb[j] != 0) && (pa[j] != 0) && (pa[m] == -pa[j]) && (pb[m] == pb[j])){
+                partner[j] = m;
+            }
+        }
+    }
+
+    compute_vinv();
+
+    printf("// Generated by gen_Toom.");
+    for(int i = 1; i < argc; i++){
+        printf(" %s", argv[i]);
+    }
+    printf("\n\n");
+    printf("#ifndef %s_TOOM_H\n#define %s_TOOM_H\n\n", name, name);
+    printf("#include <stdint.h>\n#include <stddef.h>\n\n");
+    printf("#define %s_K %zu\n", name, k);
+    printf("#define %s_POINTS %zu\n\n", name, n);
+
+    print_eval(name, type);
+    print_interpol(name, type, precision);
+
+    printf("#endif\n\n");
+
+    return 0;
+
+}
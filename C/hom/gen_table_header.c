@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "tools.h"
+#include "gen_table.h"
+
+// ================
+// This program emits a C header with constant tables of twiddle factors for the DWT
+// for Z_q[x] / (x^n + 1) so that production binaries need no table generation at startup
+// and the tables reside in .rodata.
+// Usage:
+//     gen_table_header name=NAME q=Q n=N zeta=ZETA [omega=OMEGA] [profile=m0,m1,...]
+//                      [form=plain|montgomery|shoup] [layout=streamlined|padded|vec:V]
+// - zeta is a principal (2 n)-th root of unity and omega defaults to zeta^2. For the cyclic
+//   case, pass zeta=1 and a principal n-th root of unity as omega. q must be a prime.
+// - profile lists the numbers of merged layers (default: no merging).
+// - form selects the representation:
+//     - plain: signed representatives in [-q / 2, q / 2].
+//     - montgomery: signed representatives of w R mod q with R = 2^16 or 2^32, the size
+//       of the type.
+//     - shoup: representatives in [0, q) and Shoup's precomputation floor(w 2^32 / q) or
+//       floor(w 2^64 / q) in the arrays NAME_NTT_table_Shoup and NAME_iNTT_table_Shoup.
+// - layout selects gen_streamlined_DWT_table (streamlined or padded) or gen_vec_DWT_table
+//   with gen_default_twiddle_layout(V, V) (vec:V) where V is a power of two with 1 <= V <= n / 2.
+// The type is int16_t for q < 2^15, int32_t for q < 2^31, and int64_t otherwise
+// (unsigned for shoup, where int16_t is promoted to 32 bits).
+// The header defines NAME_TABLE_LEN and the tables NAME_NTT_table and NAME_iNTT_table for the
+// forward and inverse (with zeta^(-1) and omega^(-1)) transformations.
+
+// ================
+// Z_q with signed arithmetic.
+
+int64_t mod;
+
+void memberZ(void *des, const void *src){
+    cmod_int64(des, src, &mod);
+}
+
+void addZ(void *des, const void *src1, const void *src2){
+    addmod_int128(des, src1, src2, &mod);
+}
+
+void subZ(void *des, const void *src1, const void *src2){
+    submod_int128(des, src1, src2, &mod);
+}
+
+void mulZ(void *des, const void *src1, const void *src2){
+    mulmod_int64(des, src1, src2, &mod);
+}
+
+void expZ(void *des, const void *src, size_t e){
+    expmod_int64(des, src, e, &mod);
+}
+
+struct ring coeff_ring = {
+    .sizeZ = sizeof(int64_t),
+    .memberZ = memberZ,
+    .addZ = addZ,
+    .subZ = subZ,
+    .mulZ = mulZ,
+    .expZ = expZ
+};
+
+// ================
+
+static
+void usage(const char *prog){
+    fprintf(stderr, "usage: %s name=NAME q=Q n=N zeta=ZETA [omega=OMEGA] [profile=m0,m1,...] "
+        "[form=plain|montgomery|shoup] [layout=streamlined|padded|vec:V]\n", prog);
+    exit(1);
+}
+
+// Generate the table for the transformation with zeta and omega and return its length.
+static
+size_t gen_header_table(
+    int64_t *des,
+    int64_t zeta, int64_t omega, int64_t scale,
+    struct compress_profile profile,
+    const char *layout, size_t vec_n
+    ){
+
+    struct twiddle_layout vec_layout;
+    size_t offsets[16];
+
+    if(strncmp(layout, "vec:", 4) == 0){
+        gen_default_twiddle_layout(&vec_layout, vec_n, vec_n, profile);
+        gen_vec_DWT_table(des, &scale, &omega, &zeta, profile, vec_layout, coeff_ring);
+        return get_twiddle_layout_offsets(offsets, profile, vec_layout);
+    }
+
+    bool pad = strcmp(layout, "padded") == 0;
+    size_t len = profile.ntt_n - 1;
+    size_t start_level = 0;
+
+    gen_streamlined_DWT_table(des, &scale, &omega, &zeta, profile, pad, coeff_ring);
+
+    if(pad){
+        for(size_t i = 0; i < profile.compressed_layers; i++){
+            len += 1u << start_level;
+            start_level += profile.merged_layers[i];
+        }
+    }
+
+    return len;
+
+}
+
+static
+void print_table(
+    const char *type, const char *name, const char *suffix,
+    const int64_t *src, size_t len,
+    bool is_unsigned
+    ){
+
+    printf("static const %s %s%s[%zu] = {\n", type, name, suffix, len);
+    for(size_t i = 0; i < len; i++){
+        if(is_unsigned){
+            printf("%llu%s", (unsigned long long)(uint64_t)src[i], (i + 1 < len) ? ((i % 16 == 15) ? ",\n" : ", ") : "\n");
+        }else{
+            printf("%lld%s", (long long)src[i], (i + 1 < len) ? ((i % 16 == 15) ? ",\n" : ", ") : "\n");
+        }
+    }
+    printf("};\n\n");
+
+}
+
+int main(int argc, char **argv){
+
+    const char *name = NULL, *form = "plain", *layout = "streamlined", *profile_str = NULL;
+    int64_t q = 0, zeta = 0, omega = 0, scale, t;
+    size_t n = 0, log_n, bits, len, vec_n = 0;
+    bool has_omega = false;
+
+    for(int i = 1; i < argc; i++){
+        if(strncmp(argv[i], "name=", 5) == 0){
+            name = argv[i] + 5;
+        }else if(strncmp(argv[i], "q=", 2) == 0){
+            q = strtoll(argv[i] + 2, NULL, 0);
+        }else if(strncmp(argv[i], "n=", 2) == 0){
+            n = strtoull(argv[i] + 2, NULL, 0);
+        }else if(strncmp(argv[i], "zeta=", 5) == 0){
+            zeta = strtoll(argv[i] + 5, NULL, 0);
+        }else if(strncmp(argv[i], "omega=", 6) == 0){
+            omega = strtoll(argv[i] + 6, NULL, 0);
+            has_omega = true;
+        }else if(strncmp(argv[i], "profile=", 8) == 0){
+            profile_str = argv[i] + 8;
+        }else if(strncmp(argv[i], "form=", 5) == 0){
+            form = argv[i] + 5;
+        }else if(strncmp(argv[i], "layout=", 7) == 0){
+            layout = argv[i] + 7;
+        }else{
+            usage(argv[0]);
+        }
+    }
+
+    if((name == NULL) || (q < 3) || (n < 2) || (n & (n - 1)) || (zeta == 0)){
+        usage(argv[0]);
+    }
+    if(strcmp(form, "plain") && strcmp(form, "montgomery") && strcmp(form, "shoup")){
+        usage(argv[0]);
+    }
+    if(strcmp(layout, "streamlined") && strcmp(layout, "padded") && strncmp(layout, "vec:", 4)){
+        usage(argv[0]);
+    }
+
+    // V must be a power of two with 1 <= V <= n / 2.
+    if(strncmp(layout, "vec:", 4) == 0){
+        char *end;
+        vec_n = strtoull(layout + 4, &end, 0);
+        if((end == layout + 4) || (*end != '\0') || (vec_n == 0) || (vec_n & (vec_n - 1)) || (vec_n > n / 2)){
+            usage(argv[0]);
+        }
+    }
+
+    for(log_n = 0; (1u << log_n) < n; log_n++);
+
+    struct compress_profile profile = {n, n, log_n, 0};
+
+    if(profile_str != NULL){
+        char *end;
+        const char *p = profile_str;
+        size_t sum = 0;
+        while(*p){
+            size_t v = strtoull(p, &end, 0);
+            if((end == p) || (profile.compressed_layers == 16)){
+                usage(argv[0]);
+            }
+            profile.merged_layers[profile.compressed_layers++] = v;
+            sum += v;
+            p = (*end == ',') ? end + 1 : end;
+        }
+        if(sum != log_n){
+            usage(argv[0]);
+        }
+    }else{
+        profile.compressed_layers = log_n;
+        for(size_t i = 0; i < log_n; i++){
+            profile.merged_layers[i] = 1;
+        }
+    }
+
+    bits = (q < (1LL << 15)) ? 16 : ((q < (1LL << 31)) ? 32 : 64);
+    if((strcmp(form, "shoup") == 0) && (bits == 16)){
+        bits = 32;
+    }
+    if((strcmp(form, "shoup") == 0) && (q >= (1LL << (bits - 2)))){
+        fprintf(stderr, "shoup requires q < 2^%zu\n", bits - 2);
+        return 1;
+    }
+
+    mod = q;
+    coeff_ring.memberZ(&zeta, &zeta);
+    if(has_omega){
+        coeff_ring.memberZ(&omega, &omega);
+    }else{
+        coeff_ring.mulZ(&omega, &zeta, &zeta);
+    }
+
+    // The scale is R = 2^bits for the Montgomery form.
+    scale = 1;
+    if(strcmp(form, "montgomery") == 0){
+        t = 2;
+        coeff_ring.expZ(&scale, &t, bits);
+    }
+
+    // The tables are at most NTT_N / 2 elements per level.
+    int64_t *table = malloc(log_n * n * sizeof(int64_t));
+    int64_t *itable = malloc(log_n * n * sizeof(int64_t));
+    int64_t *table_Shoup = malloc(log_n * n * sizeof(int64_t));
+    int64_t zeta_inv, omega_inv;
+
+    coeff_ring.expZ(&zeta_inv, &zeta, q - 2);
+    coeff_ring.expZ(&omega_inv, &omega, q - 2);
+
+    len = gen_header_table(table, zeta, omega, scale, profile, layout, vec_n);
+    gen_header_table(itable, zeta_inv, omega_inv, scale, profile, layout, vec_n);
+
+    char type[16];
+    snprintf(type, sizeof(type), "%sint%zu_t", strcmp(form, "shoup") == 0 ? "u" : "", bits);
+
+    printf("// Generated by gen_table_header.");
+    for(int i = 1; i < argc; i++){
+        printf(" %s", argv[i]);
+    }
+    printf("\n\n");
+    printf("#ifndef %s_TABLE_H\n#define %s_TABLE_H\n\n#include <stdint.h>\n\n", name, name);
+    printf("#define %s_TABLE_LEN %zu\n\n", name, len);
+
+    for(size_t k = 0; k < 2; k++){
+        int64_t *src = (k == 0) ? table : itable;
+        const char *suffix = (k == 0) ? "_NTT_table" : "_iNTT_table";
+        if(strcmp(form, "shoup") == 0){
+            for(size_t i = 0; i < len; i++){
+                if(src[i] < 0){
+                    src[i] += q;
+                }
+                __extension__ unsigned __int128 w = (unsigned __int128)(uint64_t)src[i] << bits;
+                table_Shoup[i] = (int64_t)(uint64_t)(w / (uint64_t)q);
+            }
+            print_table(type, name, suffix, src, len, true);
+            char suffix_Shoup[32];
+            snprintf(suffix_Shoup, sizeof(suffix_Shoup), "%s_Shoup", suffix);
+            print_table(type, name, suffix_Shoup, table_Shoup, len, true);
+        }else{
+            print_table(type, name, suffix, src, len, false);
+        }
+    }
+
+    printf("#endif\n");
+
+    free(table);
+    free(itable);
+    free(table_Shoup);
+
+    return 0;
+
+}
+